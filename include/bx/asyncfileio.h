@@ -0,0 +1,283 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_ASYNCFILEIO_H__
+#define __BX_ASYNCFILEIO_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "mpmcqueue.h"
+#include "readerwriter.h"
+#include "sem.h"
+#include "thread.h"
+#include "uint32_t.h"
+
+#ifndef BX_CONFIG_ASYNC_FILE_IO_MAX_THREADS
+#	define BX_CONFIG_ASYNC_FILE_IO_MAX_THREADS 32
+#endif // BX_CONFIG_ASYNC_FILE_IO_MAX_THREADS
+
+#ifndef BX_CONFIG_ASYNC_FILE_IO_QUEUE_SIZE
+#	define BX_CONFIG_ASYNC_FILE_IO_QUEUE_SIZE 1024
+#endif // BX_CONFIG_ASYNC_FILE_IO_QUEUE_SIZE
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+
+namespace bx
+{
+	/// Read request. Request is owned by caller, and must stay alive
+	/// until it's returned by AsyncFileIo::poll or AsyncFileIo::wait.
+	struct AsyncFileIoRequest
+	{
+		AsyncFileIoRequest()
+			: m_filePath(NULL)
+			, m_fd(-1)
+			, m_offset(0)
+			, m_data(NULL)
+			, m_size(0)
+			, m_userData(NULL)
+			, m_result(0)
+		{
+		}
+
+		const char* m_filePath; //!< File opened for this request, or NULL to read from m_fd.
+		int m_fd;               //!< Open file descriptor, used when m_filePath is NULL.
+		int64_t m_offset;       //!< File offset.
+		void* m_data;           //!< Destination.
+		int32_t m_size;         //!< Number of bytes to read.
+		void* m_userData;
+		int32_t m_result;       //!< Number of bytes read, or -1 if file couldn't be opened.
+	};
+
+	/// Runs blocking reads on pool of I/O threads, so that single thread
+	/// can keep many reads in flight and overlap I/O with processing.
+	/// Requests are passed to I/O threads, and completions back, through
+	/// lock-free queues.
+	///
+	/// Number of requests in flight is limited by queue size. Request is
+	/// in flight from submit until it's returned by poll or wait.
+	class AsyncFileIo
+	{
+		BX_CLASS(AsyncFileIo
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		AsyncFileIo(uint32_t _queueSize = BX_CONFIG_ASYNC_FILE_IO_QUEUE_SIZE)
+			: m_requests(_queueSize)
+			, m_completed(_queueSize)
+			, m_numThreads(0)
+			, m_exit(0)
+		{
+		}
+
+		~AsyncFileIo()
+		{
+			if (0 != m_numThreads)
+			{
+				shutdown();
+			}
+		}
+
+		/// Starts _numThreads I/O threads. Threads spend most of time
+		/// blocked on I/O, so there can be more of them than cores;
+		/// number of threads is number of reads device sees at once.
+		void init(uint32_t _numThreads = 8)
+		{
+			BX_CHECK(0 == m_numThreads, "Already initialized!");
+			BX_CHECK(0 < _numThreads && _numThreads <= BX_CONFIG_ASYNC_FILE_IO_MAX_THREADS
+				, "Invalid number of threads %d (max: %d)."
+				, _numThreads
+				, BX_CONFIG_ASYNC_FILE_IO_MAX_THREADS
+				);
+
+			m_numThreads = _numThreads;
+			m_exit.store(0, MemoryOrder::Relaxed);
+
+			for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+			{
+				m_thread[ii].init(ioThreadFunc, this, 0, "bx io");
+			}
+		}
+
+		/// Finishes submitted requests and stops I/O threads. Completed
+		/// requests can still be polled after shutdown.
+		void shutdown()
+		{
+			BX_CHECK(0 != m_numThreads, "Not initialized!");
+
+			m_exit.store(1, MemoryOrder::Release);
+			m_sem.post(m_numThreads);
+
+			for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+			{
+				m_thread[ii].shutdown();
+			}
+
+			m_numThreads = 0;
+		}
+
+		/// Submits batch of requests. Returns number of requests
+		/// accepted, which is less than _num when too many requests are
+		/// in flight.
+		uint32_t submit(AsyncFileIoRequest* const* _requests, uint32_t _num)
+		{
+			BX_CHECK(0 != m_numThreads, "Not initialized!");
+
+			const uint32_t capacity = m_requests.getCapacity();
+			uint32_t inFlight = m_inFlight.load(MemoryOrder::Relaxed);
+			uint32_t num;
+			do
+			{
+				num = uint32_min(_num, capacity - inFlight);
+			} while (0 != num
+				&& !m_inFlight.compareExchange(inFlight, inFlight + num, MemoryOrder::Relaxed) );
+
+			for (uint32_t ii = 0; ii < num; ++ii)
+			{
+				// Reserved slots guarantee room in queue, but push still
+				// fails while I/O thread that popped cell hasn't released
+				// it yet.
+				while (!m_requests.push(_requests[ii]) )
+				{
+					cpuPause();
+				}
+			}
+
+			if (0 != num)
+			{
+				m_sem.post(num);
+			}
+
+			return num;
+		}
+
+		bool submit(AsyncFileIoRequest* _request)
+		{
+			return 1 == submit(&_request, 1);
+		}
+
+		/// Returns completed request, or NULL if there is none.
+		AsyncFileIoRequest* poll()
+		{
+			AsyncFileIoRequest* request = m_completed.pop();
+			if (NULL != request)
+			{
+				m_inFlight.fetchSub(1, MemoryOrder::Relaxed);
+			}
+
+			return request;
+		}
+
+		/// Waits for completed request. Returns NULL on timeout.
+		AsyncFileIoRequest* wait(int32_t _msecs = -1)
+		{
+			for (;;)
+			{
+				AsyncFileIoRequest* request = poll();
+				if (NULL != request)
+				{
+					return request;
+				}
+
+				// Semaphore is posted on every completion, including ones
+				// taken by poll, extra counts only cause extra loop.
+				if (!m_completedSem.wait(_msecs) )
+				{
+					return poll();
+				}
+			}
+		}
+
+		/// Number of requests submitted, but not yet returned by poll or
+		/// wait.
+		uint32_t getNumInFlight() const
+		{
+			return m_inFlight.load(MemoryOrder::Relaxed);
+		}
+
+		uint32_t getNumThreads() const
+		{
+			return m_numThreads;
+		}
+
+	private:
+		static int32_t ioThreadFunc(void* _userData)
+		{
+			AsyncFileIo* io = (AsyncFileIo*)_userData;
+			return io->run();
+		}
+
+		int32_t run()
+		{
+			for (;;)
+			{
+				m_sem.wait();
+
+				// Every request has its own post, so request queue is
+				// empty only after shutdown posted exit. Otherwise pop
+				// can see empty queue while other submitter's push is
+				// still in progress, and post must not be lost.
+				AsyncFileIoRequest* request = m_requests.pop();
+				while (NULL == request && 0 == m_exit.load(MemoryOrder::Acquire) )
+				{
+					cpuPause();
+					request = m_requests.pop();
+				}
+
+				if (NULL == request)
+				{
+					break;
+				}
+
+				execute(*request);
+
+				// In flight limit guarantees room in queue, but push still
+				// fails while poll that popped cell hasn't released it yet.
+				while (!m_completed.push(request) )
+				{
+					cpuPause();
+				}
+
+				m_completedSem.post();
+			}
+
+			return 0;
+		}
+
+		static void execute(AsyncFileIoRequest& _request)
+		{
+			if (NULL == _request.m_filePath)
+			{
+				_request.m_result = fdRead(_request.m_fd, _request.m_data, _request.m_size, _request.m_offset);
+				return;
+			}
+
+			const int fd = ::open(_request.m_filePath, O_RDONLY);
+			if (-1 == fd)
+			{
+				_request.m_result = -1;
+				return;
+			}
+
+			_request.m_result = fdRead(fd, _request.m_data, _request.m_size, _request.m_offset);
+			::close(fd);
+		}
+
+		MpMcBoundedQueueLf<AsyncFileIoRequest> m_requests;
+		MpMcBoundedQueueLf<AsyncFileIoRequest> m_completed;
+		Semaphore m_sem;
+		Semaphore m_completedSem;
+		Atomic<uint32_t> m_inFlight;
+		Thread m_thread[BX_CONFIG_ASYNC_FILE_IO_MAX_THREADS];
+		uint32_t m_numThreads;
+		Atomic<uint32_t> m_exit;
+	};
+
+} // namespace bx
+
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+
+#endif // __BX_ASYNCFILEIO_H__
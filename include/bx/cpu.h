@@ -27,8 +27,37 @@ extern "C" void _ReadWriteBarrier();
 #	pragma intrinsic(_ReadWriteBarrier)
 #	pragma intrinsic(_InterlockedIncrement)
 #	pragma intrinsic(_InterlockedDecrement)
+#	pragma intrinsic(_InterlockedExchange)
+#	pragma intrinsic(_InterlockedExchangeAdd)
+#	pragma intrinsic(_InterlockedCompareExchange)
+#	pragma intrinsic(_InterlockedOr)
+#	pragma intrinsic(_InterlockedAnd)
+#	if BX_ARCH_64BIT
+#		pragma intrinsic(_InterlockedExchange64)
+#		pragma intrinsic(_InterlockedExchangeAdd64)
+#		pragma intrinsic(_InterlockedCompareExchange64)
+#		pragma intrinsic(_InterlockedOr64)
+#		pragma intrinsic(_InterlockedAnd64)
+#	endif // BX_ARCH_64BIT
 #endif // BX_COMPILER_MSVC
 
+#if BX_CPU_X86 && (BX_COMPILER_GCC || BX_COMPILER_CLANG)
+#	include <cpuid.h>
+#endif // BX_CPU_X86 && (BX_COMPILER_GCC || BX_COMPILER_CLANG)
+
+/// Warns when two variables written by different threads are on the same
+/// cache line. Active only when BX_WARN is defined.
+#define BX_WARN_FALSE_SHARING(_a, _b) \
+			BX_WARN(!bx::isSameCacheLine(&(_a), &(_b) ) \
+				, "False sharing, " #_a " (%p) and " #_b " (%p) are on the same cache line." \
+				, (const void*)&(_a) \
+				, (const void*)&(_b) \
+				)
+
+#ifndef BX_CONFIG_ATOMIC_BUILTINS
+#	define BX_CONFIG_ATOMIC_BUILTINS (BX_COMPILER_CLANG || (BX_COMPILER_GCC && (__GNUC__*100 + __GNUC_MINOR__) >= 407) )
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+
 namespace bx
 {
 	inline void readBarrier()
@@ -70,6 +99,205 @@ namespace bx
 #endif // BX_COMPILER
 	}
 
+	/// Hint to CPU that caller is in spin-wait loop.
+	inline void cpuPause()
+	{
+#if BX_PLATFORM_XBOX360
+		YieldProcessor();
+#elif BX_COMPILER_MSVC
+		_mm_pause();
+#elif BX_CPU_X86 && (BX_COMPILER_GCC || BX_COMPILER_CLANG)
+		asm volatile("pause":::"memory");
+#else
+		readWriteBarrier();
+#endif // BX_COMPILER
+	}
+
+	struct PrefetchLocality
+	{
+		/// Temporal locality hint, how long data should stay in cache.
+		enum Enum
+		{
+			None,     //!< Used once, don't pollute caches.
+			Low,      //!< Keep in last level cache.
+			Moderate, //!< Keep in L2 and below.
+			High,     //!< Keep in all cache levels.
+		};
+	};
+
+	/// Hint to CPU that memory at _ptr will be read soon.
+	inline void prefetchRead(const void* _ptr, PrefetchLocality::Enum _locality = PrefetchLocality::High)
+	{
+#if BX_COMPILER_GCC || BX_COMPILER_CLANG
+		// Builtin requires constant arguments.
+		switch (_locality)
+		{
+		case PrefetchLocality::None:     __builtin_prefetch(_ptr, 0, 0); break;
+		case PrefetchLocality::Low:      __builtin_prefetch(_ptr, 0, 1); break;
+		case PrefetchLocality::Moderate: __builtin_prefetch(_ptr, 0, 2); break;
+		default:                         __builtin_prefetch(_ptr, 0, 3); break;
+		}
+#elif BX_COMPILER_MSVC && BX_CPU_X86
+		switch (_locality)
+		{
+		case PrefetchLocality::None:     _mm_prefetch( (const char*)_ptr, _MM_HINT_NTA); break;
+		case PrefetchLocality::Low:      _mm_prefetch( (const char*)_ptr, _MM_HINT_T2);  break;
+		case PrefetchLocality::Moderate: _mm_prefetch( (const char*)_ptr, _MM_HINT_T1);  break;
+		default:                         _mm_prefetch( (const char*)_ptr, _MM_HINT_T0);  break;
+		}
+#else
+		BX_UNUSED(_ptr, _locality);
+#endif // BX_COMPILER_
+	}
+
+	/// Hint to CPU that memory at _ptr will be written soon, cache line is
+	/// requested in exclusive state where supported.
+	inline void prefetchWrite(void* _ptr, PrefetchLocality::Enum _locality = PrefetchLocality::High)
+	{
+#if BX_COMPILER_GCC || BX_COMPILER_CLANG
+		switch (_locality)
+		{
+		case PrefetchLocality::None:     __builtin_prefetch(_ptr, 1, 0); break;
+		case PrefetchLocality::Low:      __builtin_prefetch(_ptr, 1, 1); break;
+		case PrefetchLocality::Moderate: __builtin_prefetch(_ptr, 1, 2); break;
+		default:                         __builtin_prefetch(_ptr, 1, 3); break;
+		}
+#else
+		prefetchRead(_ptr, _locality);
+#endif // BX_COMPILER_
+	}
+
+	/// Returns true if both addresses are on the same cache line.
+	inline bool isSameCacheLine(const void* _a, const void* _b)
+	{
+		return (uintptr_t(_a) / BX_CACHE_LINE_SIZE) == (uintptr_t(_b) / BX_CACHE_LINE_SIZE);
+	}
+
+	/// Value aligned and padded to cache line, so that it doesn't share
+	/// cache line with neighbouring data written by other threads.
+	///
+	/// Alignment of heap allocated objects is not guaranteed to be larger
+	/// than 16 bytes, but padding still keeps padded values on separate
+	/// cache lines.
+	template<typename Ty>
+	BX_ALIGN_STRUCT(BX_CACHE_LINE_SIZE, struct) CacheLinePadded
+	{
+		Ty m_value;
+	};
+
+	struct CpuFeatures
+	{
+		enum Enum
+		{
+			Sse2     = 0x0001,
+			Sse3     = 0x0002,
+			Ssse3    = 0x0004,
+			Sse41    = 0x0008,
+			Sse42    = 0x0010,
+			Popcnt   = 0x0020,
+			Avx      = 0x0040,
+			Avx2     = 0x0080,
+			Fma      = 0x0100,
+			Bmi1     = 0x0200,
+			Bmi2     = 0x0400,
+			Avx512F  = 0x0800,
+			Avx512Bw = 0x1000,
+			Avx512Vl = 0x2000,
+			InvariantTsc = 0x4000, //!< TSC rate is constant across P/C-states.
+		};
+	};
+
+	/// Returns CpuFeatures flags supported by both CPU and OS. AVX and
+	/// AVX-512 are reported only if OS saves their register state.
+	inline uint32_t cpuFeaturesDetect()
+	{
+		uint32_t features = 0;
+
+#if BX_CPU_X86 && (BX_COMPILER_GCC || BX_COMPILER_CLANG || BX_COMPILER_MSVC)
+		uint32_t reg[4];
+#	if BX_COMPILER_MSVC
+#		define BX_CPUID(_leaf, _subLeaf) __cpuidex( (int*)reg, _leaf, _subLeaf)
+#	else
+#		define BX_CPUID(_leaf, _subLeaf) __cpuid_count(_leaf, _subLeaf, reg[0], reg[1], reg[2], reg[3])
+#	endif // BX_COMPILER_MSVC
+
+		BX_CPUID(0, 0);
+		const uint32_t maxLeaf = reg[0];
+
+		BX_CPUID(1, 0);
+		const uint32_t ecx1 = reg[2];
+		const uint32_t edx1 = reg[3];
+
+		uint32_t ebx7 = 0;
+		if (7 <= maxLeaf)
+		{
+			BX_CPUID(7, 0);
+			ebx7 = reg[1];
+		}
+
+		BX_CPUID(0x80000000, 0);
+		const uint32_t maxExtLeaf = reg[0];
+
+		uint32_t edx80000007 = 0;
+		if (0x80000007 <= maxExtLeaf)
+		{
+			BX_CPUID(0x80000007, 0);
+			edx80000007 = reg[3];
+		}
+
+#	undef BX_CPUID
+
+		features |= 0 != (edx1 & (1<<26) ) ? CpuFeatures::Sse2   : 0;
+		features |= 0 != (ecx1 & (1<< 0) ) ? CpuFeatures::Sse3   : 0;
+		features |= 0 != (ecx1 & (1<< 9) ) ? CpuFeatures::Ssse3  : 0;
+		features |= 0 != (ecx1 & (1<<19) ) ? CpuFeatures::Sse41  : 0;
+		features |= 0 != (ecx1 & (1<<20) ) ? CpuFeatures::Sse42  : 0;
+		features |= 0 != (ecx1 & (1<<23) ) ? CpuFeatures::Popcnt : 0;
+		features |= 0 != (ebx7 & (1<< 3) ) ? CpuFeatures::Bmi1   : 0;
+		features |= 0 != (ebx7 & (1<< 8) ) ? CpuFeatures::Bmi2   : 0;
+		features |= 0 != (edx80000007 & (1<<8) ) ? CpuFeatures::InvariantTsc : 0;
+
+		// OSXSAVE, XCR0 tells which register state OS saves on context
+		// switch.
+		if (0 != (ecx1 & (1<<27) ) )
+		{
+#	if BX_COMPILER_MSVC
+			const uint64_t xcr0 = _xgetbv(0);
+#	else
+			uint32_t eax, edx;
+			asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0) ); // xgetbv
+			const uint64_t xcr0 = (uint64_t(edx)<<32) | eax;
+#	endif // BX_COMPILER_MSVC
+
+			const bool ymm = 0x06 == (xcr0 & 0x06);
+			const bool zmm = 0xe6 == (xcr0 & 0xe6);
+
+			if (ymm)
+			{
+				features |= 0 != (ecx1 & (1<<28) ) ? CpuFeatures::Avx  : 0;
+				features |= 0 != (ecx1 & (1<<12) ) ? CpuFeatures::Fma  : 0;
+				features |= 0 != (ebx7 & (1<< 5) ) ? CpuFeatures::Avx2 : 0;
+			}
+
+			if (zmm)
+			{
+				features |= 0 != (ebx7 & (1<<16) ) ? CpuFeatures::Avx512F  : 0;
+				features |= 0 != (ebx7 & (1<<30) ) ? CpuFeatures::Avx512Bw : 0;
+				features |= 0 != (ebx7 & (1u<<31) ) ? CpuFeatures::Avx512Vl : 0;
+			}
+		}
+#endif // BX_CPU_X86
+
+		return features;
+	}
+
+	/// Returns CpuFeatures flags, detected once.
+	inline uint32_t cpuFeatures()
+	{
+		static const uint32_t s_features = cpuFeaturesDetect();
+		return s_features;
+	}
+
 	inline int32_t atomicIncr(volatile void* _var)
 	{
 #if BX_COMPILER_MSVC
@@ -88,6 +316,37 @@ namespace bx
 #endif // BX_COMPILER
 	}
 
+	/// Returns value of _var before addition.
+	inline int32_t atomicFetchAndAdd(volatile void* _var, int32_t _add)
+	{
+#if BX_COMPILER_MSVC
+		return _InterlockedExchangeAdd( (volatile LONG*)(_var), _add);
+#elif BX_COMPILER_GCC || BX_COMPILER_CLANG
+		return __sync_fetch_and_add( (volatile int32_t*)_var, _add);
+#endif // BX_COMPILER
+	}
+
+	/// Returns value of _var before exchange.
+	inline int32_t atomicExchange(volatile void* _var, int32_t _value)
+	{
+#if BX_COMPILER_MSVC
+		return _InterlockedExchange( (volatile LONG*)(_var), _value);
+#elif BX_COMPILER_GCC || BX_COMPILER_CLANG
+		return __sync_lock_test_and_set( (volatile int32_t*)_var, _value);
+#endif // BX_COMPILER
+	}
+
+	/// Stores _new into _var if _var is equal to _old. Returns value of _var
+	/// before operation, exchange succeeded if it's equal to _old.
+	inline int32_t atomicCompareAndSwap(volatile void* _var, int32_t _old, int32_t _new)
+	{
+#if BX_COMPILER_MSVC
+		return _InterlockedCompareExchange( (volatile LONG*)(_var), _new, _old);
+#elif BX_COMPILER_GCC || BX_COMPILER_CLANG
+		return __sync_val_compare_and_swap( (volatile int32_t*)_var, _old, _new);
+#endif // BX_COMPILER
+	}
+
 	inline void* atomicExchangePtr(void** _target, void* _ptr)
 	{
 #if BX_COMPILER_MSVC
@@ -97,6 +356,358 @@ namespace bx
 #endif // BX_COMPILER
 	}
 
+	/// Memory ordering constraints, same meaning as C++11 std::memory_order.
+	struct MemoryOrder
+	{
+		enum Enum
+		{
+			Relaxed,
+			Acquire,
+			Release,
+			AcqRel,
+			SeqCst,
+		};
+	};
+
+#if BX_CONFIG_ATOMIC_BUILTINS
+	/// Order is expected to be compile time constant after inlining,
+	/// otherwise compiler falls back to sequentially consistent ordering.
+	inline int atomicOrder(MemoryOrder::Enum _order)
+	{
+		switch (_order)
+		{
+		case MemoryOrder::Relaxed: return __ATOMIC_RELAXED;
+		case MemoryOrder::Acquire: return __ATOMIC_ACQUIRE;
+		case MemoryOrder::Release: return __ATOMIC_RELEASE;
+		case MemoryOrder::AcqRel:  return __ATOMIC_ACQ_REL;
+		default:                   return __ATOMIC_SEQ_CST;
+		}
+	}
+
+	/// Failure order of compare-and-swap can't be release, or stronger
+	/// than success order.
+	inline int atomicFailureOrder(MemoryOrder::Enum _order)
+	{
+		switch (_order)
+		{
+		case MemoryOrder::Relaxed:
+		case MemoryOrder::Release: return __ATOMIC_RELAXED;
+		case MemoryOrder::Acquire:
+		case MemoryOrder::AcqRel:  return __ATOMIC_ACQUIRE;
+		default:                   return __ATOMIC_SEQ_CST;
+		}
+	}
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+
+	/// Fence with given ordering constraint.
+	inline void atomicFence(MemoryOrder::Enum _order)
+	{
+#if BX_CONFIG_ATOMIC_BUILTINS
+		__atomic_thread_fence(atomicOrder(_order) );
+#else
+		if (MemoryOrder::SeqCst == _order)
+		{
+			memoryBarrier();
+		}
+		else if (MemoryOrder::Relaxed != _order)
+		{
+#	if BX_CPU_X86
+			// x86 doesn't reorder loads with loads and stores with stores.
+			readWriteBarrier();
+#	else
+			memoryBarrier();
+#	endif // BX_CPU_X86
+		}
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+	}
+
+	/// Loads plain variable with given ordering. Ty must be naturally
+	/// aligned and not larger than pointer. Use Atomic when variable is
+	/// also modified with read-modify-write operations.
+	template<typename Ty>
+	inline Ty atomicLoad(const volatile Ty* _ptr, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+	{
+		BX_CHECK(MemoryOrder::Release != _order && MemoryOrder::AcqRel != _order, "Invalid memory order for load.");
+#if BX_CONFIG_ATOMIC_BUILTINS
+		return __atomic_load_n(_ptr, atomicOrder(_order) );
+#else
+		if (MemoryOrder::SeqCst == _order)
+		{
+			memoryBarrier();
+		}
+
+		Ty value = *_ptr;
+		atomicFence(MemoryOrder::Relaxed == _order ? MemoryOrder::Relaxed : MemoryOrder::Acquire);
+		return value;
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+	}
+
+	/// Stores plain variable with given ordering. Ty must be naturally
+	/// aligned and not larger than pointer.
+	template<typename Ty>
+	inline void atomicStore(volatile Ty* _ptr, Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+	{
+		BX_CHECK(MemoryOrder::Acquire != _order && MemoryOrder::AcqRel != _order, "Invalid memory order for store.");
+#if BX_CONFIG_ATOMIC_BUILTINS
+		__atomic_store_n(_ptr, _value, atomicOrder(_order) );
+#else
+		atomicFence(MemoryOrder::Relaxed == _order ? MemoryOrder::Relaxed : MemoryOrder::Release);
+		*_ptr = _value;
+		if (MemoryOrder::SeqCst == _order)
+		{
+			memoryBarrier();
+		}
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+	}
+
+#if BX_COMPILER_MSVC
+	template<uint32_t SizeT>
+	struct AtomicMsvc;
+
+	template<>
+	struct AtomicMsvc<4>
+	{
+		typedef LONG Type;
+		static Type exchange(volatile Type* _ptr, Type _value)                 { return _InterlockedExchange(_ptr, _value); }
+		static Type fetchAdd(volatile Type* _ptr, Type _value)                 { return _InterlockedExchangeAdd(_ptr, _value); }
+		static Type fetchOr(volatile Type* _ptr, Type _value)                  { return _InterlockedOr(_ptr, _value); }
+		static Type fetchAnd(volatile Type* _ptr, Type _value)                 { return _InterlockedAnd(_ptr, _value); }
+		static Type compareAndSwap(volatile Type* _ptr, Type _old, Type _new)  { return _InterlockedCompareExchange(_ptr, _new, _old); }
+		static Type load(const volatile Type* _ptr)                            { return *_ptr; }
+	};
+
+	template<>
+	struct AtomicMsvc<8>
+	{
+		typedef LONGLONG Type;
+#	if BX_ARCH_64BIT
+		static Type exchange(volatile Type* _ptr, Type _value)                 { return _InterlockedExchange64(_ptr, _value); }
+		static Type fetchAdd(volatile Type* _ptr, Type _value)                 { return _InterlockedExchangeAdd64(_ptr, _value); }
+		static Type fetchOr(volatile Type* _ptr, Type _value)                  { return _InterlockedOr64(_ptr, _value); }
+		static Type fetchAnd(volatile Type* _ptr, Type _value)                 { return _InterlockedAnd64(_ptr, _value); }
+		static Type compareAndSwap(volatile Type* _ptr, Type _old, Type _new)  { return _InterlockedCompareExchange64(_ptr, _new, _old); }
+		static Type load(const volatile Type* _ptr)                            { return *_ptr; }
+#	else
+		static Type compareAndSwap(volatile Type* _ptr, Type _old, Type _new)  { return InterlockedCompareExchange64(_ptr, _new, _old); }
+		static Type load(const volatile Type* _ptr)                            { return compareAndSwap(const_cast<volatile Type*>(_ptr), 0, 0); }
+
+		static Type exchange(volatile Type* _ptr, Type _value)
+		{
+			Type old = load(_ptr);
+			for (Type prev; old != (prev = compareAndSwap(_ptr, old, _value) ); old = prev) {}
+			return old;
+		}
+
+		static Type fetchAdd(volatile Type* _ptr, Type _value)
+		{
+			Type old = load(_ptr);
+			for (Type prev; old != (prev = compareAndSwap(_ptr, old, old + _value) ); old = prev) {}
+			return old;
+		}
+
+		static Type fetchOr(volatile Type* _ptr, Type _value)
+		{
+			Type old = load(_ptr);
+			for (Type prev; old != (prev = compareAndSwap(_ptr, old, old | _value) ); old = prev) {}
+			return old;
+		}
+
+		static Type fetchAnd(volatile Type* _ptr, Type _value)
+		{
+			Type old = load(_ptr);
+			for (Type prev; old != (prev = compareAndSwap(_ptr, old, old & _value) ); old = prev) {}
+			return old;
+		}
+#	endif // BX_ARCH_64BIT
+	};
+#endif // BX_COMPILER_MSVC
+
+	/// Atomic variable of 32-bit, 64-bit or pointer type, with explicit
+	/// memory ordering on each operation. fetchAdd, fetchSub, fetchOr and
+	/// fetchAnd are only valid for integer types.
+	///
+	/// On GCC/Clang operations map to __atomic builtins, so relaxed,
+	/// acquire and release loads and stores are plain moves on x86. On
+	/// MSVC and older GCC read-modify-write operations are always
+	/// sequentially consistent.
+	template<typename Ty>
+	class Atomic
+	{
+		BX_CLASS(Atomic
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+		BX_STATIC_ASSERT(4 == sizeof(Ty) || 8 == sizeof(Ty), "Only 32-bit and 64-bit types are supported.");
+
+	public:
+		Atomic()
+			: m_value(0)
+		{
+		}
+
+		explicit Atomic(Ty _value)
+			: m_value(_value)
+		{
+		}
+
+		Ty load(MemoryOrder::Enum _order = MemoryOrder::SeqCst) const
+		{
+			BX_CHECK(MemoryOrder::Release != _order && MemoryOrder::AcqRel != _order, "Invalid memory order for load.");
+#if BX_CONFIG_ATOMIC_BUILTINS
+			return __atomic_load_n(&m_value, atomicOrder(_order) );
+#elif BX_COMPILER_MSVC
+			// Sequentially consistent stores are full barriers, so load
+			// only needs acquire ordering.
+			Ty value = fromMsvc(Msvc::load( (const volatile typename Msvc::Type*)&m_value) );
+			atomicFence(MemoryOrder::Relaxed == _order ? MemoryOrder::Relaxed : MemoryOrder::Acquire);
+			return value;
+#else
+			return atomicLoad(&m_value, _order);
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		void store(Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+			BX_CHECK(MemoryOrder::Acquire != _order && MemoryOrder::AcqRel != _order, "Invalid memory order for store.");
+#if BX_CONFIG_ATOMIC_BUILTINS
+			__atomic_store_n(&m_value, _value, atomicOrder(_order) );
+#elif BX_COMPILER_MSVC
+			if (MemoryOrder::SeqCst == _order)
+			{
+				exchange(_value);
+			}
+			else
+			{
+				atomicFence(_order);
+				m_value = _value;
+			}
+#else
+			atomicStore(&m_value, _value, _order);
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		/// Returns previous value.
+		Ty exchange(Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+#if BX_CONFIG_ATOMIC_BUILTINS
+			return __atomic_exchange_n(&m_value, _value, atomicOrder(_order) );
+#elif BX_COMPILER_MSVC
+			BX_UNUSED(_order);
+			return fromMsvc(Msvc::exchange(ptrMsvc(), toMsvc(_value) ) );
+#else
+			BX_UNUSED(_order);
+			// __sync_lock_test_and_set is only acquire barrier.
+			memoryBarrier();
+			return __sync_lock_test_and_set(&m_value, _value);
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		/// Stores _desired if value is equal to _expected. Otherwise
+		/// _expected receives current value. Returns true on success.
+		bool compareExchange(Ty& _expected, Ty _desired, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+#if BX_CONFIG_ATOMIC_BUILTINS
+			return __atomic_compare_exchange_n(&m_value, &_expected, _desired, false, atomicOrder(_order), atomicFailureOrder(_order) );
+#else
+			BX_UNUSED(_order);
+			const Ty expected = _expected;
+#	if BX_COMPILER_MSVC
+			_expected = fromMsvc(Msvc::compareAndSwap(ptrMsvc(), toMsvc(expected), toMsvc(_desired) ) );
+#	else
+			_expected = __sync_val_compare_and_swap(&m_value, expected, _desired);
+#	endif // BX_COMPILER_MSVC
+			return expected == _expected;
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		/// Returns value before addition.
+		Ty fetchAdd(Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+#if BX_CONFIG_ATOMIC_BUILTINS
+			return __atomic_fetch_add(&m_value, _value, atomicOrder(_order) );
+#elif BX_COMPILER_MSVC
+			BX_UNUSED(_order);
+			return fromMsvc(Msvc::fetchAdd(ptrMsvc(), toMsvc(_value) ) );
+#else
+			BX_UNUSED(_order);
+			return __sync_fetch_and_add(&m_value, _value);
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		/// Returns value before subtraction.
+		Ty fetchSub(Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+			return fetchAdd(Ty(0) - _value, _order);
+		}
+
+		/// Returns value before operation.
+		Ty fetchOr(Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+#if BX_CONFIG_ATOMIC_BUILTINS
+			return __atomic_fetch_or(&m_value, _value, atomicOrder(_order) );
+#elif BX_COMPILER_MSVC
+			BX_UNUSED(_order);
+			return fromMsvc(Msvc::fetchOr(ptrMsvc(), toMsvc(_value) ) );
+#else
+			BX_UNUSED(_order);
+			return __sync_fetch_and_or(&m_value, _value);
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		/// Returns value before operation.
+		Ty fetchAnd(Ty _value, MemoryOrder::Enum _order = MemoryOrder::SeqCst)
+		{
+#if BX_CONFIG_ATOMIC_BUILTINS
+			return __atomic_fetch_and(&m_value, _value, atomicOrder(_order) );
+#elif BX_COMPILER_MSVC
+			BX_UNUSED(_order);
+			return fromMsvc(Msvc::fetchAnd(ptrMsvc(), toMsvc(_value) ) );
+#else
+			BX_UNUSED(_order);
+			return __sync_fetch_and_and(&m_value, _value);
+#endif // BX_CONFIG_ATOMIC_BUILTINS
+		}
+
+		/// Address of underlying value, for futex and similar APIs.
+		volatile Ty* getPtr()
+		{
+			return &m_value;
+		}
+
+	private:
+#if BX_COMPILER_MSVC && !BX_CONFIG_ATOMIC_BUILTINS
+		typedef AtomicMsvc<sizeof(Ty)> Msvc;
+
+		union Cast
+		{
+			Ty m_value;
+			typename Msvc::Type m_msvc;
+		};
+
+		static typename Msvc::Type toMsvc(Ty _value)
+		{
+			Cast cast;
+			cast.m_value = _value;
+			return cast.m_msvc;
+		}
+
+		static Ty fromMsvc(typename Msvc::Type _value)
+		{
+			Cast cast;
+			cast.m_msvc = _value;
+			return cast.m_value;
+		}
+
+		volatile typename Msvc::Type* ptrMsvc()
+		{
+			return (volatile typename Msvc::Type*)&m_value;
+		}
+#endif // BX_COMPILER_MSVC && !BX_CONFIG_ATOMIC_BUILTINS
+
+		volatile Ty m_value;
+	};
+
 } // namespace bx
 
 #endif // __BX_CPU_H__
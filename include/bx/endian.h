@@ -6,7 +6,18 @@
 #ifndef __BX_ENDIAN_H__
 #define __BX_ENDIAN_H__
 
+#include <string.h> // memcpy
+
 #include "bx.h"
+#include "cpu.h"
+
+#ifndef BX_CONFIG_ENDIAN_DISPATCH
+#	define BX_CONFIG_ENDIAN_DISPATCH BX_CONFIG_TARGET_DISPATCH
+#endif // BX_CONFIG_ENDIAN_DISPATCH
+
+#if BX_CONFIG_ENDIAN_DISPATCH
+#	include <immintrin.h>
+#endif // BX_CONFIG_ENDIAN_DISPATCH
 
 namespace bx
 {
@@ -82,6 +93,260 @@ namespace bx
 #endif // BX_CPU_ENDIAN_LITTLE
 	}
 
+	/// Swaps byte order of _num values from _src into _dst. _dst may be
+	/// the same as _src, otherwise arrays must not overlap. Arrays don't
+	/// need to be aligned, elements are loaded and stored with memcpy.
+	typedef void (*EndianSwapArray16Fn)(uint16_t* _dst, const uint16_t* _src, uint32_t _num);
+	typedef void (*EndianSwapArray32Fn)(uint32_t* _dst, const uint32_t* _src, uint32_t _num);
+	typedef void (*EndianSwapArray64Fn)(uint64_t* _dst, const uint64_t* _src, uint32_t _num);
+
+	inline void endianSwapArray16_ref(uint16_t* _dst, const uint16_t* _src, uint32_t _num)
+	{
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint16_t value;
+			memcpy(&value, &_src[ii], sizeof(value) );
+			value = endianSwap(value);
+			memcpy(&_dst[ii], &value, sizeof(value) );
+		}
+	}
+
+	inline void endianSwapArray32_ref(uint32_t* _dst, const uint32_t* _src, uint32_t _num)
+	{
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint32_t value;
+			memcpy(&value, &_src[ii], sizeof(value) );
+			value = endianSwap(value);
+			memcpy(&_dst[ii], &value, sizeof(value) );
+		}
+	}
+
+	inline void endianSwapArray64_ref(uint64_t* _dst, const uint64_t* _src, uint32_t _num)
+	{
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint64_t value;
+			memcpy(&value, &_src[ii], sizeof(value) );
+			value = endianSwap(value);
+			memcpy(&_dst[ii], &value, sizeof(value) );
+		}
+	}
+
+#if BX_CONFIG_ENDIAN_DISPATCH
+	/// Shuffles 16 bytes per iteration with _shuffle byte mask. Returns
+	/// number of bytes processed, tail is left to caller.
+	BX_TARGET("ssse3") inline uint32_t endianSwapBytes_ssse3(void* _dst, const void* _src, uint32_t _size, const uint8_t* _shuffle)
+	{
+		const __m128i shuffle = _mm_loadu_si128( (const __m128i*)_shuffle);
+		uint8_t* dst = (uint8_t*)_dst;
+		const uint8_t* src = (const uint8_t*)_src;
+
+		uint32_t ii = 0;
+		for (; ii+16 <= _size; ii += 16)
+		{
+			const __m128i value = _mm_loadu_si128( (const __m128i*)&src[ii]);
+			_mm_storeu_si128( (__m128i*)&dst[ii], _mm_shuffle_epi8(value, shuffle) );
+		}
+
+		return ii;
+	}
+
+	/// 32 bytes per iteration, AVX2 byte shuffle works within 128-bit
+	/// lanes so same mask is used for both.
+	BX_TARGET("avx2") inline uint32_t endianSwapBytes_avx2(void* _dst, const void* _src, uint32_t _size, const uint8_t* _shuffle)
+	{
+		const __m128i shuffle128 = _mm_loadu_si128( (const __m128i*)_shuffle);
+		const __m256i shuffle = _mm256_broadcastsi128_si256(shuffle128);
+		uint8_t* dst = (uint8_t*)_dst;
+		const uint8_t* src = (const uint8_t*)_src;
+
+		uint32_t ii = 0;
+		for (; ii+32 <= _size; ii += 32)
+		{
+			const __m256i value = _mm256_loadu_si256( (const __m256i*)&src[ii]);
+			_mm256_storeu_si256( (__m256i*)&dst[ii], _mm256_shuffle_epi8(value, shuffle) );
+		}
+
+		if (ii+16 <= _size)
+		{
+			const __m128i value = _mm_loadu_si128( (const __m128i*)&src[ii]);
+			_mm_storeu_si128( (__m128i*)&dst[ii], _mm_shuffle_epi8(value, shuffle128) );
+			ii += 16;
+		}
+
+		return ii;
+	}
+
+	inline const uint8_t* endianSwapShuffle(uint32_t _size)
+	{
+		static const uint8_t s_shuffle[3][16] =
+		{
+			{ 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+			{ 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+			{ 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },
+		};
+
+		return s_shuffle[2 == _size ? 0 : 4 == _size ? 1 : 2];
+	}
+
+	BX_TARGET("ssse3") inline void endianSwapArray16_ssse3(uint16_t* _dst, const uint16_t* _src, uint32_t _num)
+	{
+		const uint32_t num = endianSwapBytes_ssse3(_dst, _src, _num*2, endianSwapShuffle(2) )/2;
+		endianSwapArray16_ref(&_dst[num], &_src[num], _num-num);
+	}
+
+	BX_TARGET("ssse3") inline void endianSwapArray32_ssse3(uint32_t* _dst, const uint32_t* _src, uint32_t _num)
+	{
+		const uint32_t num = endianSwapBytes_ssse3(_dst, _src, _num*4, endianSwapShuffle(4) )/4;
+		endianSwapArray32_ref(&_dst[num], &_src[num], _num-num);
+	}
+
+	BX_TARGET("ssse3") inline void endianSwapArray64_ssse3(uint64_t* _dst, const uint64_t* _src, uint32_t _num)
+	{
+		const uint32_t num = endianSwapBytes_ssse3(_dst, _src, _num*8, endianSwapShuffle(8) )/8;
+		endianSwapArray64_ref(&_dst[num], &_src[num], _num-num);
+	}
+
+	BX_TARGET("avx2") inline void endianSwapArray16_avx2(uint16_t* _dst, const uint16_t* _src, uint32_t _num)
+	{
+		const uint32_t num = endianSwapBytes_avx2(_dst, _src, _num*2, endianSwapShuffle(2) )/2;
+		endianSwapArray16_ref(&_dst[num], &_src[num], _num-num);
+	}
+
+	BX_TARGET("avx2") inline void endianSwapArray32_avx2(uint32_t* _dst, const uint32_t* _src, uint32_t _num)
+	{
+		const uint32_t num = endianSwapBytes_avx2(_dst, _src, _num*4, endianSwapShuffle(4) )/4;
+		endianSwapArray32_ref(&_dst[num], &_src[num], _num-num);
+	}
+
+	BX_TARGET("avx2") inline void endianSwapArray64_avx2(uint64_t* _dst, const uint64_t* _src, uint32_t _num)
+	{
+		const uint32_t num = endianSwapBytes_avx2(_dst, _src, _num*8, endianSwapShuffle(8) )/8;
+		endianSwapArray64_ref(&_dst[num], &_src[num], _num-num);
+	}
+#endif // BX_CONFIG_ENDIAN_DISPATCH
+
+	/// Returns best implementation for given CpuFeatures flags.
+	inline EndianSwapArray16Fn endianSwapArray16_select(uint32_t _features)
+	{
+#if BX_CONFIG_ENDIAN_DISPATCH
+		if (0 != (_features & CpuFeatures::Avx2) )
+		{
+			return endianSwapArray16_avx2;
+		}
+
+		if (0 != (_features & CpuFeatures::Ssse3) )
+		{
+			return endianSwapArray16_ssse3;
+		}
+#else
+		BX_UNUSED(_features);
+#endif // BX_CONFIG_ENDIAN_DISPATCH
+
+		return endianSwapArray16_ref;
+	}
+
+	inline EndianSwapArray32Fn endianSwapArray32_select(uint32_t _features)
+	{
+#if BX_CONFIG_ENDIAN_DISPATCH
+		if (0 != (_features & CpuFeatures::Avx2) )
+		{
+			return endianSwapArray32_avx2;
+		}
+
+		if (0 != (_features & CpuFeatures::Ssse3) )
+		{
+			return endianSwapArray32_ssse3;
+		}
+#else
+		BX_UNUSED(_features);
+#endif // BX_CONFIG_ENDIAN_DISPATCH
+
+		return endianSwapArray32_ref;
+	}
+
+	inline EndianSwapArray64Fn endianSwapArray64_select(uint32_t _features)
+	{
+#if BX_CONFIG_ENDIAN_DISPATCH
+		if (0 != (_features & CpuFeatures::Avx2) )
+		{
+			return endianSwapArray64_avx2;
+		}
+
+		if (0 != (_features & CpuFeatures::Ssse3) )
+		{
+			return endianSwapArray64_ssse3;
+		}
+#else
+		BX_UNUSED(_features);
+#endif // BX_CONFIG_ENDIAN_DISPATCH
+
+		return endianSwapArray64_ref;
+	}
+
+	/// Swaps with best implementation for CPU, selected on first call.
+	inline void endianSwapArray16(uint16_t* _dst, const uint16_t* _src, uint32_t _num)
+	{
+		static const EndianSwapArray16Fn s_fn = endianSwapArray16_select(cpuFeatures() );
+		s_fn(_dst, _src, _num);
+	}
+
+	inline void endianSwapArray32(uint32_t* _dst, const uint32_t* _src, uint32_t _num)
+	{
+		static const EndianSwapArray32Fn s_fn = endianSwapArray32_select(cpuFeatures() );
+		s_fn(_dst, _src, _num);
+	}
+
+	inline void endianSwapArray64(uint64_t* _dst, const uint64_t* _src, uint32_t _num)
+	{
+		static const EndianSwapArray64Fn s_fn = endianSwapArray64_select(cpuFeatures() );
+		s_fn(_dst, _src, _num);
+	}
+
+	/// Swaps in place.
+	inline void endianSwapArray16(uint16_t* _data, uint32_t _num)
+	{
+		endianSwapArray16(_data, _data, _num);
+	}
+
+	inline void endianSwapArray32(uint32_t* _data, uint32_t _num)
+	{
+		endianSwapArray32(_data, _data, _num);
+	}
+
+	inline void endianSwapArray64(uint64_t* _data, uint32_t _num)
+	{
+		endianSwapArray64(_data, _data, _num);
+	}
+
+	/// Swaps array of 1, 2, 4 or 8 byte type, _dst may be the same as
+	/// _src.
+	template <typename Ty>
+	inline void endianSwapArray(Ty* _dst, const Ty* _src, uint32_t _num)
+	{
+		if (2 == sizeof(Ty) )
+		{
+			endianSwapArray16( (uint16_t*)_dst, (const uint16_t*)_src, _num);
+		}
+		else if (4 == sizeof(Ty) )
+		{
+			endianSwapArray32( (uint32_t*)_dst, (const uint32_t*)_src, _num);
+		}
+		else if (8 == sizeof(Ty) )
+		{
+			endianSwapArray64( (uint64_t*)_dst, (const uint64_t*)_src, _num);
+		}
+		else if (_dst != _src)
+		{
+			BX_CHECK(1 == sizeof(Ty), "Type size must be 1, 2, 4 or 8 bytes.");
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				_dst[ii] = _src[ii];
+			}
+		}
+	}
+
 } // namespace bx
 
 #endif // __BX_ENDIAN_H__
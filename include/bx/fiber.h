@@ -0,0 +1,467 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_FIBER_H__
+#define __BX_FIBER_H__
+
+#include "bx.h"
+
+#ifndef BX_CONFIG_SUPPORTS_FIBER
+#	define BX_CONFIG_SUPPORTS_FIBER (BX_PLATFORM_LINUX || BX_PLATFORM_OSX)
+#endif // BX_CONFIG_SUPPORTS_FIBER
+
+#if BX_CONFIG_SUPPORTS_FIBER
+
+#ifndef BX_CONFIG_FIBER_ASM
+#	define BX_CONFIG_FIBER_ASM (BX_CPU_X86 && BX_ARCH_64BIT && (BX_COMPILER_GCC || BX_COMPILER_CLANG) )
+#endif // BX_CONFIG_FIBER_ASM
+
+#ifndef BX_CONFIG_FIBER_STACK_SIZE
+#	define BX_CONFIG_FIBER_STACK_SIZE (64<<10)
+#endif // BX_CONFIG_FIBER_STACK_SIZE
+
+#include <sys/mman.h> // mmap, mprotect
+#include <unistd.h> // sysconf
+
+#if !BX_CONFIG_FIBER_ASM
+#	if BX_PLATFORM_OSX && !defined(_XOPEN_SOURCE)
+#		define _XOPEN_SOURCE
+#	endif // BX_PLATFORM_OSX && !defined(_XOPEN_SOURCE)
+#	include <ucontext.h>
+#endif // !BX_CONFIG_FIBER_ASM
+
+#include "cpu.h"
+#include "jobsystem.h"
+#include "mutex.h"
+#include "thread.h"
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#	define MAP_ANONYMOUS MAP_ANON
+#endif // !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+
+namespace bx
+{
+	/// Stack memory with inaccessible guard page below it, so that stack
+	/// overflow faults instead of silently corrupting neighbouring memory.
+	struct FiberStack
+	{
+		void* m_base;
+		uint32_t m_size;
+	};
+
+	inline uint32_t fiberPageSize()
+	{
+		return uint32_t(sysconf(_SC_PAGESIZE) );
+	}
+
+	inline bool fiberStackAlloc(FiberStack& _stack, uint32_t _size)
+	{
+		const uint32_t pageSize = fiberPageSize();
+		const uint32_t size = (_size + pageSize - 1) & ~(pageSize - 1);
+
+		void* ptr = mmap(NULL, size + pageSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		if (MAP_FAILED == ptr)
+		{
+			_stack.m_base = NULL;
+			_stack.m_size = 0;
+			return false;
+		}
+
+		int result = mprotect(ptr, pageSize, PROT_NONE);
+		BX_CHECK(0 == result, "mprotect failed %d.", result); BX_UNUSED(result);
+
+		_stack.m_base = (uint8_t*)ptr + pageSize;
+		_stack.m_size = size;
+		return true;
+	}
+
+	inline void fiberStackFree(FiberStack& _stack)
+	{
+		if (NULL != _stack.m_base)
+		{
+			const uint32_t pageSize = fiberPageSize();
+			munmap( (uint8_t*)_stack.m_base - pageSize, _stack.m_size + pageSize);
+			_stack.m_base = NULL;
+			_stack.m_size = 0;
+		}
+	}
+
+	typedef void (*FiberFn)(void* _userData);
+
+	/// Stackful coroutine. Fiber runs on its own stack until it yields or
+	/// its function returns, then control goes back to thread that resumed
+	/// it. Suspended fiber can be resumed from any thread.
+	class Fiber
+	{
+		BX_CLASS(Fiber
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		Fiber()
+			: m_fn(NULL)
+			, m_userData(NULL)
+			, m_done(true)
+		{
+		}
+
+		/// Prepares fiber to run _fn(_userData) on stack _stack. Fiber
+		/// doesn't own stack memory.
+		void init(FiberFn _fn, void* _userData, const FiberStack& _stack)
+		{
+			BX_CHECK(m_done, "Fiber is still running.");
+
+			m_fn = _fn;
+			m_userData = _userData;
+			m_done = false;
+
+#if BX_CONFIG_FIBER_ASM
+			// Start as if entry was called, stack pointer is 16-byte aligned
+			// before return address is pushed.
+			uintptr_t top = (uintptr_t( (uint8_t*)_stack.m_base + _stack.m_size) & ~uintptr_t(15) ) - sizeof(void*);
+			*(void**)top = NULL;
+			m_context.m_sp = (void*)top;
+			m_context.m_pc = reinterpret_cast<void*>(&Fiber::entry);
+#else
+			getcontext(&m_context);
+			m_context.uc_stack.ss_sp = _stack.m_base;
+			m_context.uc_stack.ss_size = _stack.m_size;
+			m_context.uc_link = NULL;
+
+			const uint64_t ptr = uint64_t(uintptr_t(this) );
+			makecontext(&m_context, (void(*)() )&Fiber::entryUc, 2, uint32_t(ptr>>32), uint32_t(ptr) );
+#endif // BX_CONFIG_FIBER_ASM
+		}
+
+		/// Runs fiber on calling thread until it yields or finishes.
+		void resume()
+		{
+			BX_CHECK(!m_done, "Fiber is done.");
+			switchTo(m_caller, m_context);
+		}
+
+		/// Suspends fiber and returns to thread that resumed it. Must be
+		/// called from within fiber.
+		void yield()
+		{
+			switchTo(m_context, m_caller);
+		}
+
+		bool isDone() const
+		{
+			return m_done;
+		}
+
+	private:
+#if BX_CONFIG_FIBER_ASM
+		struct Context
+		{
+			void* m_sp;
+			void* m_pc;
+		};
+
+		/// Saves callee-saved state of current context on its stack, and
+		/// jumps to _to. Everything else is declared clobbered, so compiler
+		/// spills live registers around switch. Red zone is skipped before
+		/// pushing.
+		static void switchTo(Context& _from, Context& _to)
+		{
+			Context* from = &_from;
+			Context* to = &_to;
+
+			__asm__ __volatile__ (
+				"subq    $128, %%rsp\n\t"
+				"pushq   %%rbp\n\t"
+				"subq    $8, %%rsp\n\t"
+				"stmxcsr (%%rsp)\n\t"
+				"fnstcw  4(%%rsp)\n\t"
+				"leaq    1f(%%rip), %%rax\n\t"
+				"movq    %%rsp, 0(%%rdi)\n\t"
+				"movq    %%rax, 8(%%rdi)\n\t"
+				"movq    0(%%rsi), %%rsp\n\t"
+				"jmpq    *8(%%rsi)\n"
+				"1:\n\t"
+				"ldmxcsr (%%rsp)\n\t"
+				"fldcw   4(%%rsp)\n\t"
+				"addq    $8, %%rsp\n\t"
+				"popq    %%rbp\n\t"
+				"addq    $128, %%rsp\n\t"
+				: "+D"(from), "+S"(to)
+				:
+				: "rax", "rbx", "rcx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+				, "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7"
+				, "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15"
+				, "memory", "cc"
+				);
+		}
+
+		/// First switch into fiber jumps here, with arguments of switchTo
+		/// still in registers.
+		static void entry(Context* /*_from*/, Context* _to)
+		{
+			// m_context is first member of Fiber.
+			Fiber* fiber = (Fiber*)_to;
+			fiber->run();
+		}
+#else
+		typedef ucontext_t Context;
+
+		static void switchTo(Context& _from, Context& _to)
+		{
+			swapcontext(&_from, &_to);
+		}
+
+		static void entryUc(uint32_t _hi, uint32_t _lo)
+		{
+			Fiber* fiber = (Fiber*)uintptr_t( (uint64_t(_hi)<<32) | _lo);
+			fiber->run();
+		}
+#endif // BX_CONFIG_FIBER_ASM
+
+		void run()
+		{
+			m_fn(m_userData);
+			m_done = true;
+			switchTo(m_context, m_caller);
+			BX_CHECK(false, "Finished fiber must not be resumed.");
+		}
+
+		Context m_context;
+		Context m_caller;
+		FiberFn m_fn;
+		void* m_userData;
+		bool m_done;
+	};
+
+	/// Runs jobs on fibers from fixed pool. Job running on fiber can wait
+	/// on counter without blocking worker thread, fiber is suspended and
+	/// later resumed on whichever worker picks it up. Waiting fiber only
+	/// costs its stack.
+	class FiberScheduler
+	{
+		BX_CLASS(FiberScheduler
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		FiberScheduler()
+			: m_jobSystem(NULL)
+			, m_task(NULL)
+			, m_free(NULL)
+			, m_numFibers(0)
+		{
+		}
+
+		~FiberScheduler()
+		{
+			if (NULL != m_task)
+			{
+				shutdown();
+			}
+		}
+
+		/// Allocates _numFibers fibers with guarded stacks of _stackSize
+		/// bytes. Returns false if stack allocation failed.
+		bool init(JobSystem* _jobSystem, uint32_t _numFibers, uint32_t _stackSize = BX_CONFIG_FIBER_STACK_SIZE)
+		{
+			BX_CHECK(NULL == m_task, "Already initialized!");
+
+			m_jobSystem = _jobSystem;
+			m_numFibers = _numFibers;
+			m_task = new Task[_numFibers];
+			m_free = NULL;
+
+			bool ok = true;
+			for (uint32_t ii = 0; ii < _numFibers; ++ii)
+			{
+				Task& task = m_task[ii];
+				task.m_scheduler = this;
+				task.m_resume.m_job.m_fn = resumeFn;
+				task.m_resume.m_job.m_userData = &task;
+				task.m_resume.m_job.m_counter = NULL;
+				task.m_resume.m_next = NULL;
+				ok &= fiberStackAlloc(task.m_stack, _stackSize);
+				task.m_next = m_free;
+				m_free = &task;
+			}
+
+			return ok;
+		}
+
+		/// All fiber jobs must be done before shutdown.
+		void shutdown()
+		{
+			BX_CHECK(NULL != m_task, "Not initialized!");
+
+			for (uint32_t ii = 0; ii < m_numFibers; ++ii)
+			{
+				BX_CHECK(m_task[ii].m_fiber.isDone(), "Fiber %d is still running.", ii);
+				fiberStackFree(m_task[ii].m_stack);
+			}
+
+			delete [] m_task;
+			m_task = NULL;
+			m_free = NULL;
+			m_numFibers = 0;
+			m_jobSystem = NULL;
+		}
+
+		/// Submits job that runs on fiber. If there is no free fiber job is
+		/// submitted as ordinary job, and wait inside it blocks worker.
+		void submit(JobFn _fn, void* _userData, JobCounter* _counter = NULL)
+		{
+			Task* task = allocTask();
+			if (NULL == task)
+			{
+				m_jobSystem->submit(_fn, _userData, _counter);
+				return;
+			}
+
+			task->m_fn = _fn;
+			task->m_userData = _userData;
+			task->m_counter = _counter;
+			task->m_wait = NULL;
+			task->m_fiber.init(fiberFn, task, task->m_stack);
+
+			if (NULL != _counter)
+			{
+				m_jobSystem->retain(_counter);
+			}
+
+			m_jobSystem->submit(&task->m_resume.m_job, 1);
+		}
+
+		/// Waits until all jobs associated with counter are done. On fiber
+		/// it suspends fiber, otherwise it executes other jobs like
+		/// JobSystem::wait. Any number of fibers and threads can wait on
+		/// the same counter.
+		void wait(JobCounter* _counter)
+		{
+			Task* task = (Task*)m_current.get();
+			if (NULL == task)
+			{
+				m_jobSystem->wait(_counter);
+				return;
+			}
+
+			// Fiber is resumed as soon as count reaches zero, but counter
+			// is done only after release submitted all continuations.
+			while (!_counter->isDone() )
+			{
+				// Continuation is registered only after fiber is switched
+				// out, otherwise fiber could be resumed on other worker while
+				// it's still running here.
+				task->m_wait = _counter;
+				task->m_fiber.yield();
+			}
+		}
+
+		/// Suspends fiber and puts it back into job queue, so other jobs
+		/// can run. Does nothing if not called from fiber.
+		void yield()
+		{
+			Task* task = (Task*)m_current.get();
+			if (NULL != task)
+			{
+				task->m_fiber.yield();
+			}
+		}
+
+		/// Returns true if calling code runs on fiber of this scheduler.
+		bool isFiber() const
+		{
+			return NULL != m_current.get();
+		}
+
+	private:
+		struct Task
+		{
+			Fiber m_fiber;
+			FiberStack m_stack;
+			JobContinuation m_resume;
+			FiberScheduler* m_scheduler;
+			JobFn m_fn;
+			void* m_userData;
+			JobCounter* m_counter;
+			JobCounter* m_wait;
+			Task* m_next;
+		};
+
+		Task* allocTask()
+		{
+			SpinLockScope lock(m_lock);
+			Task* task = m_free;
+			if (NULL != task)
+			{
+				m_free = task->m_next;
+			}
+
+			return task;
+		}
+
+		void freeTask(Task* _task)
+		{
+			SpinLockScope lock(m_lock);
+			_task->m_next = m_free;
+			m_free = _task;
+		}
+
+		static void fiberFn(void* _userData)
+		{
+			Task* task = (Task*)_userData;
+			task->m_fn(task->m_userData);
+		}
+
+		static void resumeFn(void* _userData)
+		{
+			Task* task = (Task*)_userData;
+			FiberScheduler* scheduler = task->m_scheduler;
+
+			void* current = scheduler->m_current.get();
+			scheduler->m_current.set(task);
+			task->m_fiber.resume();
+			scheduler->m_current.set(current);
+
+			if (task->m_fiber.isDone() )
+			{
+				JobCounter* counter = task->m_counter;
+				scheduler->freeTask(task);
+
+				if (NULL != counter)
+				{
+					scheduler->m_jobSystem->release(counter);
+				}
+			}
+			else if (NULL != task->m_wait)
+			{
+				JobCounter* counter = task->m_wait;
+				task->m_wait = NULL;
+
+				if (!scheduler->m_jobSystem->setContinuation(counter, &task->m_resume) )
+				{
+					scheduler->m_jobSystem->submit(&task->m_resume.m_job, 1);
+				}
+			}
+			else
+			{
+				scheduler->m_jobSystem->submit(&task->m_resume.m_job, 1);
+			}
+		}
+
+		JobSystem* m_jobSystem;
+		Task* m_task;
+		Task* m_free;
+		uint32_t m_numFibers;
+		SpinLock m_lock;
+		TlsData m_current;
+	};
+
+} // namespace bx
+
+#endif // BX_CONFIG_SUPPORTS_FIBER
+
+#endif // __BX_FIBER_H__
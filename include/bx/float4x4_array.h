@@ -0,0 +1,172 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_FLOAT4X4_ARRAY_H__
+#define __BX_FLOAT4X4_ARRAY_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "float4x4_t.h"
+
+#ifndef BX_CONFIG_FLOAT4_DISPATCH
+#	define BX_CONFIG_FLOAT4_DISPATCH BX_CONFIG_TARGET_DISPATCH
+#endif // BX_CONFIG_FLOAT4_DISPATCH
+
+#if BX_CONFIG_FLOAT4_DISPATCH
+#	include <immintrin.h>
+#endif // BX_CONFIG_FLOAT4_DISPATCH
+
+namespace bx
+{
+	/// Transforms _num 4-component vectors from _vec by _mtx into _result.
+	/// _result may be the same as _vec.
+	typedef void (*Float4MulArrayFn)(float* _result, const float* _vec, uint32_t _num, const float4x4_t& _mtx);
+
+	/// Baseline implementation, _result and _vec must be 16-byte aligned.
+	inline void float4_mul_array_ref(float* _result, const float* _vec, uint32_t _num, const float4x4_t& _mtx)
+	{
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const float4_t vec = float4_ld(&_vec[ii*4]);
+			float4_st(&_result[ii*4], float4_mul(vec, _mtx) );
+		}
+	}
+
+#if BX_CONFIG_FLOAT4_DISPATCH
+	/// Two vectors per iteration, each 128-bit lane multiplies one vector
+	/// with broadcast matrix columns.
+	BX_TARGET("avx") inline void float4_mul_array_avx(float* _result, const float* _vec, uint32_t _num, const float4x4_t& _mtx)
+	{
+		const __m256 col0 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[0]);
+		const __m256 col1 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[1]);
+		const __m256 col2 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[2]);
+		const __m256 col3 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[3]);
+
+		uint32_t ii = 0;
+		for (; ii + 2 <= _num; ii += 2)
+		{
+			const __m256 vec  = _mm256_loadu_ps(&_vec[ii*4]);
+			const __m256 xxxx = _mm256_permute_ps(vec, 0x00);
+			const __m256 yyyy = _mm256_permute_ps(vec, 0x55);
+			const __m256 zzzz = _mm256_permute_ps(vec, 0xaa);
+			const __m256 wwww = _mm256_permute_ps(vec, 0xff);
+			const __m256 xy   = _mm256_add_ps(_mm256_mul_ps(col0, xxxx), _mm256_mul_ps(col1, yyyy) );
+			const __m256 zw   = _mm256_add_ps(_mm256_mul_ps(col2, zzzz), _mm256_mul_ps(col3, wwww) );
+			_mm256_storeu_ps(&_result[ii*4], _mm256_add_ps(xy, zw) );
+		}
+
+		if (ii < _num)
+		{
+			const __m128 vec  = _mm_loadu_ps(&_vec[ii*4]);
+			const __m128 xxxx = _mm_permute_ps(vec, 0x00);
+			const __m128 yyyy = _mm_permute_ps(vec, 0x55);
+			const __m128 zzzz = _mm_permute_ps(vec, 0xaa);
+			const __m128 wwww = _mm_permute_ps(vec, 0xff);
+			const __m128 xy   = _mm_add_ps(_mm_mul_ps(_mm256_castps256_ps128(col0), xxxx), _mm_mul_ps(_mm256_castps256_ps128(col1), yyyy) );
+			const __m128 zw   = _mm_add_ps(_mm_mul_ps(_mm256_castps256_ps128(col2), zzzz), _mm_mul_ps(_mm256_castps256_ps128(col3), wwww) );
+			_mm_storeu_ps(&_result[ii*4], _mm_add_ps(xy, zw) );
+		}
+	}
+
+	/// Same as AVX version with fused multiply-add.
+	BX_TARGET("avx,fma") inline void float4_mul_array_fma(float* _result, const float* _vec, uint32_t _num, const float4x4_t& _mtx)
+	{
+		const __m256 col0 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[0]);
+		const __m256 col1 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[1]);
+		const __m256 col2 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[2]);
+		const __m256 col3 = _mm256_broadcast_ps( (const __m128*)&_mtx.col[3]);
+
+		uint32_t ii = 0;
+		for (; ii + 2 <= _num; ii += 2)
+		{
+			const __m256 vec  = _mm256_loadu_ps(&_vec[ii*4]);
+			const __m256 xxxx = _mm256_permute_ps(vec, 0x00);
+			const __m256 yyyy = _mm256_permute_ps(vec, 0x55);
+			const __m256 zzzz = _mm256_permute_ps(vec, 0xaa);
+			const __m256 wwww = _mm256_permute_ps(vec, 0xff);
+			const __m256 xy   = _mm256_fmadd_ps(col1, yyyy, _mm256_mul_ps(col0, xxxx) );
+			const __m256 zw   = _mm256_fmadd_ps(col3, wwww, _mm256_mul_ps(col2, zzzz) );
+			_mm256_storeu_ps(&_result[ii*4], _mm256_add_ps(xy, zw) );
+		}
+
+		if (ii < _num)
+		{
+			const __m128 vec  = _mm_loadu_ps(&_vec[ii*4]);
+			const __m128 xxxx = _mm_permute_ps(vec, 0x00);
+			const __m128 yyyy = _mm_permute_ps(vec, 0x55);
+			const __m128 zzzz = _mm_permute_ps(vec, 0xaa);
+			const __m128 wwww = _mm_permute_ps(vec, 0xff);
+			const __m128 xy   = _mm_fmadd_ps(_mm256_castps256_ps128(col1), yyyy, _mm_mul_ps(_mm256_castps256_ps128(col0), xxxx) );
+			const __m128 zw   = _mm_fmadd_ps(_mm256_castps256_ps128(col3), wwww, _mm_mul_ps(_mm256_castps256_ps128(col2), zzzz) );
+			_mm_storeu_ps(&_result[ii*4], _mm_add_ps(xy, zw) );
+		}
+	}
+
+	/// Four vectors per iteration, remainder is handled by FMA version.
+	/// Zero-masked intrinsics are used since unmasked ones are implemented
+	/// with undefined source in some compilers, which triggers warnings.
+	BX_TARGET("avx512f,avx,fma") inline void float4_mul_array_avx512(float* _result, const float* _vec, uint32_t _num, const float4x4_t& _mtx)
+	{
+		const __m512 col0 = _mm512_maskz_broadcast_f32x4(0xffff, _mm_loadu_ps( (const float*)&_mtx.col[0]) );
+		const __m512 col1 = _mm512_maskz_broadcast_f32x4(0xffff, _mm_loadu_ps( (const float*)&_mtx.col[1]) );
+		const __m512 col2 = _mm512_maskz_broadcast_f32x4(0xffff, _mm_loadu_ps( (const float*)&_mtx.col[2]) );
+		const __m512 col3 = _mm512_maskz_broadcast_f32x4(0xffff, _mm_loadu_ps( (const float*)&_mtx.col[3]) );
+
+		uint32_t ii = 0;
+		for (; ii + 4 <= _num; ii += 4)
+		{
+			const __m512 vec  = _mm512_loadu_ps(&_vec[ii*4]);
+			const __m512 xxxx = _mm512_maskz_permute_ps(0xffff, vec, 0x00);
+			const __m512 yyyy = _mm512_maskz_permute_ps(0xffff, vec, 0x55);
+			const __m512 zzzz = _mm512_maskz_permute_ps(0xffff, vec, 0xaa);
+			const __m512 wwww = _mm512_maskz_permute_ps(0xffff, vec, 0xff);
+			const __m512 xy   = _mm512_fmadd_ps(col1, yyyy, _mm512_mul_ps(col0, xxxx) );
+			const __m512 zw   = _mm512_fmadd_ps(col3, wwww, _mm512_mul_ps(col2, zzzz) );
+			_mm512_storeu_ps(&_result[ii*4], _mm512_add_ps(xy, zw) );
+		}
+
+		if (ii < _num)
+		{
+			float4_mul_array_fma(&_result[ii*4], &_vec[ii*4], _num - ii, _mtx);
+		}
+	}
+#endif // BX_CONFIG_FLOAT4_DISPATCH
+
+	/// Returns best implementation for given CpuFeatures flags.
+	inline Float4MulArrayFn float4_mul_array_select(uint32_t _features)
+	{
+#if BX_CONFIG_FLOAT4_DISPATCH
+		if (0 != (_features & CpuFeatures::Avx512F) )
+		{
+			return float4_mul_array_avx512;
+		}
+
+		if ( (CpuFeatures::Avx|CpuFeatures::Fma) == (_features & (CpuFeatures::Avx|CpuFeatures::Fma) ) )
+		{
+			return float4_mul_array_fma;
+		}
+
+		if (0 != (_features & CpuFeatures::Avx) )
+		{
+			return float4_mul_array_avx;
+		}
+#else
+		BX_UNUSED(_features);
+#endif // BX_CONFIG_FLOAT4_DISPATCH
+
+		return float4_mul_array_ref;
+	}
+
+	/// Transforms _num vectors by _mtx with best implementation for CPU,
+	/// selected on first call. _result and _vec must be 16-byte aligned.
+	inline void float4_mul_array(float* _result, const float* _vec, uint32_t _num, const float4x4_t& _mtx)
+	{
+		static const Float4MulArrayFn s_fn = float4_mul_array_select(cpuFeatures() );
+		s_fn(_result, _vec, _num, _mtx);
+	}
+
+} // namespace bx
+
+#endif // __BX_FLOAT4X4_ARRAY_H__
@@ -4,7 +4,7 @@
  */
 
 #ifndef __BX_FLOAT4X4_H__
-#define __BX_FLOAT4x4_H__
+#define __BX_FLOAT4X4_H__
 
 #include "float4_t.h"
 
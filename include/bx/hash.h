@@ -6,7 +6,18 @@
 #ifndef __BX_HASH_H__
 #define __BX_HASH_H__
 
+#include <string.h> // memcpy
+
 #include "bx.h"
+#include "cpu.h"
+
+#ifndef BX_CONFIG_CRC32C_DISPATCH
+#	define BX_CONFIG_CRC32C_DISPATCH BX_CONFIG_TARGET_DISPATCH
+#endif // BX_CONFIG_CRC32C_DISPATCH
+
+#if BX_CONFIG_CRC32C_DISPATCH
+#	include <immintrin.h>
+#endif // BX_CONFIG_CRC32C_DISPATCH
 
 namespace bx
 {
@@ -109,6 +120,278 @@ namespace bx
 		return hashMurmur2A(&_data, sizeof(Ty) );
 	}
 
+	/// CRC-32C (Castagnoli), same CRC as used by iSCSI, ext4 and SSE4.2
+	/// crc32 instruction.
+	struct Crc32c
+	{
+		enum Enum
+		{
+			Polynomial = 0x82f63b78, //!< Reflected 0x1edc6f41.
+			LongBlock  = 8192,
+			ShortBlock = 256,
+		};
+	};
+
+	/// Lookup tables for slicing-by-8, and for appending LongBlock and
+	/// ShortBlock zero bytes to CRC, used to combine CRCs of interleaved
+	/// streams. Tables operate on raw CRC, without pre and post inversion.
+	struct Crc32cTable
+	{
+		Crc32cTable()
+		{
+			for (uint32_t ii = 0; ii < 256; ++ii)
+			{
+				uint32_t crc = ii;
+				for (uint32_t jj = 0; jj < 8; ++jj)
+				{
+					crc = (crc>>1) ^ (0 != (crc&1) ? uint32_t(Crc32c::Polynomial) : 0);
+				}
+
+				m_slice[0][ii] = crc;
+			}
+
+			for (uint32_t ii = 0; ii < 256; ++ii)
+			{
+				uint32_t crc = m_slice[0][ii];
+				for (uint32_t jj = 1; jj < 8; ++jj)
+				{
+					crc = m_slice[0][crc&0xff] ^ (crc>>8);
+					m_slice[jj][ii] = crc;
+				}
+			}
+
+			initShift(m_long,  Crc32c::LongBlock);
+			initShift(m_short, Crc32c::ShortBlock);
+		}
+
+		/// Returns raw CRC after appending zero bytes, _table is m_long or
+		/// m_short.
+		static uint32_t shift(const uint32_t _table[4][256], uint32_t _crc)
+		{
+			return _table[0][_crc&0xff]
+				 ^ _table[1][(_crc>>8)&0xff]
+				 ^ _table[2][(_crc>>16)&0xff]
+				 ^ _table[3][_crc>>24]
+				 ;
+		}
+
+		uint32_t m_slice[8][256];
+		uint32_t m_long[4][256];
+		uint32_t m_short[4][256];
+
+	private:
+		void initShift(uint32_t _table[4][256], uint32_t _numZeros)
+		{
+			// Appending zeros is linear, so it's enough to know what
+			// happens to each bit.
+			uint32_t column[32];
+			for (uint32_t bit = 0; bit < 32; ++bit)
+			{
+				uint32_t crc = 1u<<bit;
+				for (uint32_t ii = 0; ii < _numZeros; ++ii)
+				{
+					crc = m_slice[0][crc&0xff] ^ (crc>>8);
+				}
+
+				column[bit] = crc;
+			}
+
+			for (uint32_t ii = 0; ii < 4; ++ii)
+			{
+				for (uint32_t jj = 0; jj < 256; ++jj)
+				{
+					uint32_t crc = 0;
+					for (uint32_t bit = 0; bit < 8; ++bit)
+					{
+						crc ^= 0 != (jj & (1<<bit) ) ? column[ii*8 + bit] : 0;
+					}
+
+					_table[ii][jj] = crc;
+				}
+			}
+		}
+	};
+
+	/// Returns tables, built on first call.
+	inline const Crc32cTable& crc32cTable()
+	{
+		static const Crc32cTable s_table;
+		return s_table;
+	}
+
+	typedef uint32_t (*Crc32cFn)(uint32_t _crc, const void* _data, uint32_t _size);
+
+	/// Slicing-by-8, processes 8 bytes per iteration with 8 table lookups.
+	inline uint32_t crc32c_ref(uint32_t _crc, const void* _data, uint32_t _size)
+	{
+		const Crc32cTable& table = crc32cTable();
+		const uint8_t* data = (const uint8_t*)_data;
+		uint32_t crc = ~_crc;
+
+		for (; _size >= 8; _size -= 8, data += 8)
+		{
+			const uint32_t lo = crc ^ (uint32_t(data[0]) | (uint32_t(data[1])<<8) | (uint32_t(data[2])<<16) | (uint32_t(data[3])<<24) );
+			const uint32_t hi =        uint32_t(data[4]) | (uint32_t(data[5])<<8) | (uint32_t(data[6])<<16) | (uint32_t(data[7])<<24);
+
+			crc = table.m_slice[7][lo&0xff]
+				^ table.m_slice[6][(lo>>8)&0xff]
+				^ table.m_slice[5][(lo>>16)&0xff]
+				^ table.m_slice[4][lo>>24]
+				^ table.m_slice[3][hi&0xff]
+				^ table.m_slice[2][(hi>>8)&0xff]
+				^ table.m_slice[1][(hi>>16)&0xff]
+				^ table.m_slice[0][hi>>24]
+				;
+		}
+
+		for (; 0 < _size; --_size)
+		{
+			crc = table.m_slice[0][(crc ^ *data++)&0xff] ^ (crc>>8);
+		}
+
+		return ~crc;
+	}
+
+#if BX_CONFIG_CRC32C_DISPATCH
+	/// SSE4.2 crc32 instruction has 3 cycle latency and 1 cycle throughput,
+	/// large buffers are split in three streams that are processed
+	/// interleaved, and combined with Crc32cTable::shift.
+	BX_TARGET("sse4.2") inline uint32_t crc32c_sse42(uint32_t _crc, const void* _data, uint32_t _size)
+	{
+		const uint8_t* data = (const uint8_t*)_data;
+		uint32_t crc = ~_crc;
+
+		for (; 0 < _size && 0 != (uintptr_t(data) & 7); --_size)
+		{
+			crc = _mm_crc32_u8(crc, *data++);
+		}
+
+#	if BX_ARCH_64BIT
+		const Crc32cTable& table = crc32cTable();
+
+		for (; _size >= 3*Crc32c::LongBlock; _size -= 3*Crc32c::LongBlock, data += 3*Crc32c::LongBlock)
+		{
+			uint64_t crc0 = crc;
+			uint64_t crc1 = 0;
+			uint64_t crc2 = 0;
+
+			for (uint32_t ii = 0; ii < Crc32c::LongBlock; ii += 8)
+			{
+				uint64_t value[3];
+				memcpy(&value[0], &data[ii                     ], 8);
+				memcpy(&value[1], &data[ii +   Crc32c::LongBlock], 8);
+				memcpy(&value[2], &data[ii + 2*Crc32c::LongBlock], 8);
+				crc0 = _mm_crc32_u64(crc0, value[0]);
+				crc1 = _mm_crc32_u64(crc1, value[1]);
+				crc2 = _mm_crc32_u64(crc2, value[2]);
+			}
+
+			crc = Crc32cTable::shift(table.m_long, uint32_t(crc0) ) ^ uint32_t(crc1);
+			crc = Crc32cTable::shift(table.m_long, crc) ^ uint32_t(crc2);
+		}
+
+		for (; _size >= 3*Crc32c::ShortBlock; _size -= 3*Crc32c::ShortBlock, data += 3*Crc32c::ShortBlock)
+		{
+			uint64_t crc0 = crc;
+			uint64_t crc1 = 0;
+			uint64_t crc2 = 0;
+
+			for (uint32_t ii = 0; ii < Crc32c::ShortBlock; ii += 8)
+			{
+				uint64_t value[3];
+				memcpy(&value[0], &data[ii                      ], 8);
+				memcpy(&value[1], &data[ii +   Crc32c::ShortBlock], 8);
+				memcpy(&value[2], &data[ii + 2*Crc32c::ShortBlock], 8);
+				crc0 = _mm_crc32_u64(crc0, value[0]);
+				crc1 = _mm_crc32_u64(crc1, value[1]);
+				crc2 = _mm_crc32_u64(crc2, value[2]);
+			}
+
+			crc = Crc32cTable::shift(table.m_short, uint32_t(crc0) ) ^ uint32_t(crc1);
+			crc = Crc32cTable::shift(table.m_short, crc) ^ uint32_t(crc2);
+		}
+
+		for (; _size >= 8; _size -= 8, data += 8)
+		{
+			uint64_t value;
+			memcpy(&value, data, 8);
+			crc = uint32_t(_mm_crc32_u64(crc, value) );
+		}
+#	else
+		for (; _size >= 4; _size -= 4, data += 4)
+		{
+			uint32_t value;
+			memcpy(&value, data, 4);
+			crc = _mm_crc32_u32(crc, value);
+		}
+#	endif // BX_ARCH_64BIT
+
+		for (; 0 < _size; --_size)
+		{
+			crc = _mm_crc32_u8(crc, *data++);
+		}
+
+		return ~crc;
+	}
+#endif // BX_CONFIG_CRC32C_DISPATCH
+
+	/// Returns best implementation for given CpuFeatures flags.
+	inline Crc32cFn crc32c_select(uint32_t _features)
+	{
+#if BX_CONFIG_CRC32C_DISPATCH
+		if (0 != (_features & CpuFeatures::Sse42) )
+		{
+			return crc32c_sse42;
+		}
+#else
+		BX_UNUSED(_features);
+#endif // BX_CONFIG_CRC32C_DISPATCH
+
+		return crc32c_ref;
+	}
+
+	/// Updates CRC-32C with _size bytes of _data. Start with 0, CRC of
+	/// concatenated buffers is same as CRC of each buffer passed in order:
+	/// crc32c(crc32c(0, a), b) == crc32c(0, ab).
+	inline uint32_t crc32c(uint32_t _crc, const void* _data, uint32_t _size)
+	{
+		static const Crc32cFn s_fn = crc32c_select(cpuFeatures() );
+		return s_fn(_crc, _data, _size);
+	}
+
+	class HashCrc32c
+	{
+	public:
+		void begin(uint32_t _seed = 0)
+		{
+			m_hash = _seed;
+		}
+
+		void add(const void* _data, int _len)
+		{
+			m_hash = crc32c(m_hash, _data, uint32_t(_len) );
+		}
+
+		template<typename Ty>
+		void add(Ty _value)
+		{
+			add(&_value, sizeof(Ty) );
+		}
+
+		uint32_t end()
+		{
+			return m_hash;
+		}
+
+	private:
+		uint32_t m_hash;
+	};
+
+	inline uint32_t hashCrc32c(const void* _data, uint32_t _size)
+	{
+		return crc32c(0, _data, _size);
+	}
+
 } // namespace bx
 
 #endif // __BX_HASH_H__
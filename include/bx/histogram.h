@@ -0,0 +1,290 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_HISTOGRAM_H__
+#define __BX_HISTOGRAM_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "timer.h"
+#include "uint32_t.h"
+
+/// Number of linear sub-buckets per power of two is 2^(bits-1), relative
+/// error of recorded values is 1/2^(bits-1).
+#ifndef BX_CONFIG_LATENCY_HISTOGRAM_PRECISION
+#	define BX_CONFIG_LATENCY_HISTOGRAM_PRECISION 6
+#endif // BX_CONFIG_LATENCY_HISTOGRAM_PRECISION
+
+/// Number of shards per histogram, must be power of two. Each of first
+/// threads owns one shard, so that they don't contend on the same counters.
+#ifndef BX_CONFIG_LATENCY_HISTOGRAM_SHARDS
+#	define BX_CONFIG_LATENCY_HISTOGRAM_SHARDS 16
+#endif // BX_CONFIG_LATENCY_HISTOGRAM_SHARDS
+
+/// Number of shards shared by threads that don't own shard, must be power
+/// of two.
+#ifndef BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS
+#	define BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS 4
+#endif // BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS
+
+namespace bx
+{
+	/// Latency percentiles, in recorded units (getHPCounter ticks).
+	struct LatencyStats
+	{
+		uint64_t m_count;
+		uint64_t m_p50;
+		uint64_t m_p90;
+		uint64_t m_p99;
+		uint64_t m_p999;
+		uint64_t m_max;
+	};
+
+	/// Returns small per-thread index, assigned on first call. Indices
+	/// are not reused when threads exit.
+	inline uint32_t latencyHistogramThreadIndex()
+	{
+		static BX_THREAD uint32_t s_index = 0;
+		if (0 == s_index)
+		{
+			static Atomic<uint32_t> s_counter;
+			s_index = s_counter.fetchAdd(1, MemoryOrder::Relaxed) + 1;
+		}
+
+		return s_index - 1;
+	}
+
+	/// Log-linear histogram of 64-bit values, in style of HdrHistogram.
+	/// Values below 2^precision are counted exactly, larger values are
+	/// counted in 2^(precision-1) linear buckets per power of two.
+	///
+	/// HdrHistogram
+	/// http://hdrhistogram.github.io/HdrHistogram/
+	///
+	/// Recording is lock-free. First NumShards threads own their shard and
+	/// record with relaxed load and store, other threads share separate
+	/// NumSharedShards shards and record with relaxed fetchAdd. Shards are
+	/// merged on read.
+	class LatencyHistogram
+	{
+		BX_CLASS(LatencyHistogram
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+		BX_STATIC_ASSERT(0 == (BX_CONFIG_LATENCY_HISTOGRAM_SHARDS & (BX_CONFIG_LATENCY_HISTOGRAM_SHARDS-1) ), "BX_CONFIG_LATENCY_HISTOGRAM_SHARDS must be power of two.");
+		BX_STATIC_ASSERT(0 == (BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS & (BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS-1) ), "BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS must be power of two.");
+
+	public:
+		enum
+		{
+			SubBucketBits = BX_CONFIG_LATENCY_HISTOGRAM_PRECISION,
+			SubBucketHalf = 1<<(SubBucketBits-1),
+			NumBuckets    = (64-SubBucketBits)*SubBucketHalf + (1<<SubBucketBits),
+			NumShards       = BX_CONFIG_LATENCY_HISTOGRAM_SHARDS,
+			NumSharedShards = BX_CONFIG_LATENCY_HISTOGRAM_SHARED_SHARDS,
+		};
+
+		LatencyHistogram()
+		{
+		}
+
+		~LatencyHistogram()
+		{
+		}
+
+		/// Records value, negative values are recorded as 0.
+		void record(int64_t _value)
+		{
+			const uint64_t value = 0 < _value ? uint64_t(_value) : 0;
+			const uint32_t index = latencyHistogramThreadIndex();
+			const bool owned = index < NumShards;
+			Shard& shard = owned
+				? m_shard[index]
+				: m_shard[NumShards + (index & (NumSharedShards-1) )]
+				;
+			Atomic<uint64_t>& count = shard.m_count[bucketIndex(value)];
+
+			if (owned)
+			{
+				// Single writer, no need for locked read-modify-write.
+				count.store(count.load(MemoryOrder::Relaxed) + 1, MemoryOrder::Relaxed);
+			}
+			else
+			{
+				count.fetchAdd(1, MemoryOrder::Relaxed);
+			}
+
+			uint64_t max = shard.m_max.load(MemoryOrder::Relaxed);
+			while (value > max
+			&&    !shard.m_max.compareExchange(max, value, MemoryOrder::Relaxed) )
+			{
+			}
+		}
+
+		/// Clears all counters. Values recorded concurrently with reset
+		/// may be lost.
+		void reset()
+		{
+			for (uint32_t ii = 0; ii < NumShards+NumSharedShards; ++ii)
+			{
+				Shard& shard = m_shard[ii];
+				for (uint32_t jj = 0; jj < NumBuckets; ++jj)
+				{
+					shard.m_count[jj].store(0, MemoryOrder::Relaxed);
+				}
+
+				shard.m_max.store(0, MemoryOrder::Relaxed);
+			}
+		}
+
+		/// Merges shards and computes p50, p90, p99, p99.9 and max.
+		/// Percentiles are reported as highest value of their bucket.
+		void getStats(LatencyStats& _stats) const
+		{
+			uint64_t counts[NumBuckets];
+			uint64_t max;
+			const uint64_t total = merge(counts, max);
+
+			_stats.m_count = total;
+			_stats.m_p50   = percentile(counts, total, max, 50.0);
+			_stats.m_p90   = percentile(counts, total, max, 90.0);
+			_stats.m_p99   = percentile(counts, total, max, 99.0);
+			_stats.m_p999  = percentile(counts, total, max, 99.9);
+			_stats.m_max   = max;
+		}
+
+		/// Returns value at _percentile (0-100).
+		uint64_t getPercentile(double _percentile) const
+		{
+			uint64_t counts[NumBuckets];
+			uint64_t max;
+			const uint64_t total = merge(counts, max);
+			return percentile(counts, total, max, _percentile);
+		}
+
+		static uint32_t bucketIndex(uint64_t _value)
+		{
+			// Or-ing mask makes values below 2^bits land in shift 0,
+			// which counts them exactly.
+			const uint32_t msb   = 63 - uint32_t(uint64_cntlz(_value | ( (1<<SubBucketBits)-1) ) );
+			const uint32_t shift = msb - (SubBucketBits-1);
+			return shift*SubBucketHalf + uint32_t(_value>>shift);
+		}
+
+		/// Lowest value counted in bucket _index.
+		static uint64_t bucketLowest(uint32_t _index)
+		{
+			if (_index < (1<<SubBucketBits) )
+			{
+				return _index;
+			}
+
+			const uint32_t shift = _index/SubBucketHalf - 1;
+			const uint64_t top   = _index - shift*SubBucketHalf;
+			return top<<shift;
+		}
+
+		/// Highest value counted in bucket _index.
+		static uint64_t bucketHighest(uint32_t _index)
+		{
+			return _index+1 < NumBuckets
+				? bucketLowest(_index+1) - 1
+				: UINT64_MAX
+				;
+		}
+
+	private:
+		uint64_t merge(uint64_t* _counts, uint64_t& _max) const
+		{
+			uint64_t total = 0;
+			_max = 0;
+
+			for (uint32_t jj = 0; jj < NumBuckets; ++jj)
+			{
+				_counts[jj] = 0;
+			}
+
+			for (uint32_t ii = 0; ii < NumShards+NumSharedShards; ++ii)
+			{
+				const Shard& shard = m_shard[ii];
+				for (uint32_t jj = 0; jj < NumBuckets; ++jj)
+				{
+					const uint64_t count = shard.m_count[jj].load(MemoryOrder::Relaxed);
+					_counts[jj] += count;
+					total += count;
+				}
+
+				_max = uint64_max(_max, shard.m_max.load(MemoryOrder::Relaxed) );
+			}
+
+			return total;
+		}
+
+		static uint64_t percentile(const uint64_t* _counts, uint64_t _total, uint64_t _max, double _percentile)
+		{
+			if (0 == _total)
+			{
+				return 0;
+			}
+
+			const double rank = double(_total)*_percentile/100.0;
+			const uint64_t target = uint64_max(1, uint64_t(rank + 0.999999) );
+
+			uint64_t sum = 0;
+			for (uint32_t ii = 0; ii < NumBuckets; ++ii)
+			{
+				sum += _counts[ii];
+				if (sum >= target)
+				{
+					return uint64_min(bucketHighest(ii), _max);
+				}
+			}
+
+			return _max;
+		}
+
+		struct Shard
+		{
+			Atomic<uint64_t> m_count[NumBuckets];
+			Atomic<uint64_t> m_max;
+
+			// Histogram is not cache line aligned, full line keeps shards
+			// apart.
+			char m_pad[BX_CACHE_LINE_SIZE];
+		};
+
+		// Owned shards first, followed by shared ones.
+		Shard m_shard[NumShards+NumSharedShards];
+	};
+
+	/// Records getHPCounter ticks elapsed in scope.
+	class LatencyScope
+	{
+		BX_CLASS(LatencyScope
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		LatencyScope(LatencyHistogram& _histogram)
+			: m_histogram(_histogram)
+			, m_start(getHPCounter() )
+		{
+		}
+
+		~LatencyScope()
+		{
+			m_histogram.record(getHPCounter() - m_start);
+		}
+
+	private:
+		LatencyHistogram& m_histogram;
+		int64_t m_start;
+	};
+
+} // namespace bx
+
+#endif // __BX_HISTOGRAM_H__
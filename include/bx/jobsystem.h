@@ -0,0 +1,585 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_JOBSYSTEM_H__
+#define __BX_JOBSYSTEM_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "mutex.h"
+#include "os.h"
+#include "profiler.h"
+#include "sem.h"
+#include "thread.h"
+#include "uint32_t.h"
+
+#include <new> // placement new
+
+#ifndef BX_CONFIG_JOBSYSTEM_MAX_THREADS
+#	define BX_CONFIG_JOBSYSTEM_MAX_THREADS 64
+#endif // BX_CONFIG_JOBSYSTEM_MAX_THREADS
+
+#ifndef BX_CONFIG_JOBSYSTEM_QUEUE_SIZE
+#	define BX_CONFIG_JOBSYSTEM_QUEUE_SIZE 1024
+#endif // BX_CONFIG_JOBSYSTEM_QUEUE_SIZE
+
+#ifndef BX_CONFIG_JOBSYSTEM_SPIN_COUNT
+#	define BX_CONFIG_JOBSYSTEM_SPIN_COUNT 64
+#endif // BX_CONFIG_JOBSYSTEM_SPIN_COUNT
+
+namespace bx
+{
+	typedef void (*JobFn)(void* _userData);
+
+	struct JobContinuation;
+
+	/// Counts unfinished jobs. Counter is incremented when job is submitted
+	/// and decremented when job is done. Jobs can submit child jobs with
+	/// the same counter, then waiting on counter waits for whole job tree.
+	struct JobCounter
+	{
+		/// Set in m_value while continuation list might not be empty.
+		static const int32_t Continuation = INT32_MIN;
+
+		JobCounter()
+			: m_value(0)
+			, m_continuation(NULL)
+		{
+		}
+
+		/// Counter is not done while release is still submitting its
+		/// continuation, so waiter can't destroy counter under it.
+		bool isDone() const
+		{
+			return 0 == m_value.load(MemoryOrder::Acquire);
+		}
+
+		Atomic<int32_t> m_value;
+		Atomic<JobContinuation*> m_continuation; //!< Lock-free list, pushed by setContinuation.
+	};
+
+	struct Job
+	{
+		JobFn m_fn;
+		void* m_userData;
+		JobCounter* m_counter;
+#if BX_CONFIG_PROFILER
+		uint64_t m_flowId; //!< Set on submit, links submission to execution in captures.
+#endif // BX_CONFIG_PROFILER
+	};
+
+	/// Job submitted when counter is done. Any number of continuations can
+	/// wait on the same counter.
+	struct JobContinuation
+	{
+		Job m_job;
+		JobContinuation* m_next;
+	};
+
+	/// Chase-Lev work-stealing deque with fixed capacity. Owner pushes and
+	/// pops at bottom (LIFO), other threads steal from top (FIFO).
+	///
+	/// Dynamic Circular Work-Stealing Deque
+	/// http://dl.acm.org/citation.cfm?id=1073974
+	///
+	/// Correct and Efficient Work-Stealing for Weak Memory Models
+	/// http://dl.acm.org/citation.cfm?id=2442524
+	///
+	/// Memory ordering follows C11 version from the latter paper.
+	template <typename Ty, uint32_t MaxT>
+	class WorkStealingQueue
+	{
+		BX_CLASS(WorkStealingQueue
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+		BX_STATIC_ASSERT(0 == (MaxT & (MaxT-1) ), "MaxT must be power of two.");
+
+	public:
+		WorkStealingQueue()
+		{
+			BX_WARN_FALSE_SHARING(m_top.m_value, m_bottom.m_value);
+		}
+
+		~WorkStealingQueue()
+		{
+		}
+
+		/// Returns false if queue is full.
+		bool push(const Ty& _item) // owner only
+		{
+			const int32_t bottom = m_bottom.m_value.load(MemoryOrder::Relaxed);
+			const int32_t top    = m_top.m_value.load(MemoryOrder::Acquire);
+
+			if (bottom - top >= int32_t(MaxT) )
+			{
+				return false;
+			}
+
+			m_data[bottom & (MaxT-1)] = _item;
+
+			// item must be visible before bottom moves.
+			atomicFence(MemoryOrder::Release);
+			m_bottom.m_value.store(bottom + 1, MemoryOrder::Relaxed);
+
+			return true;
+		}
+
+		bool pop(Ty& _item) // owner only
+		{
+			const int32_t bottom = m_bottom.m_value.load(MemoryOrder::Relaxed) - 1;
+			m_bottom.m_value.store(bottom, MemoryOrder::Relaxed);
+
+			// bottom store must be visible to thieves before top is read.
+			atomicFence(MemoryOrder::SeqCst);
+			int32_t top = m_top.m_value.load(MemoryOrder::Relaxed);
+
+			if (top > bottom)
+			{
+				m_bottom.m_value.store(bottom + 1, MemoryOrder::Relaxed);
+				return false;
+			}
+
+			_item = m_data[bottom & (MaxT-1)];
+
+			if (top == bottom)
+			{
+				// Last item, race against thieves.
+				const bool ok = m_top.m_value.compareExchange(top, top + 1, MemoryOrder::SeqCst);
+				m_bottom.m_value.store(bottom + 1, MemoryOrder::Relaxed);
+				return ok;
+			}
+
+			return true;
+		}
+
+		bool steal(Ty& _item) // any thread
+		{
+			int32_t top = m_top.m_value.load(MemoryOrder::Acquire);
+			atomicFence(MemoryOrder::SeqCst);
+			const int32_t bottom = m_bottom.m_value.load(MemoryOrder::Acquire);
+
+			if (top >= bottom)
+			{
+				return false;
+			}
+
+			_item = m_data[top & (MaxT-1)];
+
+			return m_top.m_value.compareExchange(top, top + 1, MemoryOrder::SeqCst);
+		}
+
+		bool isEmpty() const
+		{
+			return m_bottom.m_value.load(MemoryOrder::Relaxed) <= m_top.m_value.load(MemoryOrder::Relaxed);
+		}
+
+	private:
+		// top is written by thieves, bottom only by owner.
+		CacheLinePadded<Atomic<int32_t> > m_top;
+		CacheLinePadded<Atomic<int32_t> > m_bottom;
+		Ty m_data[MaxT];
+	};
+
+	/// Work-stealing job scheduler. Every worker thread owns a deque, jobs
+	/// submitted from worker thread go to its own deque, jobs submitted
+	/// from other threads go to shared deque. Idle workers steal from
+	/// other deques, and park on semaphore when there is no work.
+	class JobSystem
+	{
+		BX_CLASS(JobSystem
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		JobSystem()
+			: m_worker(NULL)
+			, m_workerMem(NULL)
+			, m_numThreads(0)
+			, m_numSleeping(0)
+			, m_exit(0)
+		{
+		}
+
+		~JobSystem()
+		{
+			if (NULL != m_worker)
+			{
+				shutdown();
+			}
+		}
+
+		/// Starts _numThreads worker threads. If _numThreads is 0, one worker
+		/// is started per physical core, minus one for calling thread.
+		void init(uint32_t _numThreads = 0)
+		{
+			BX_CHECK(NULL == m_worker, "Already initialized!");
+
+			if (0 == _numThreads)
+			{
+				CpuTopology* topology = new CpuTopology;
+				getCpuTopology(*topology);
+				_numThreads = uint32_max(1, uint32_min(topology->m_numPhysical-1, BX_CONFIG_JOBSYSTEM_MAX_THREADS) );
+				delete topology;
+			}
+			BX_CHECK(0 < _numThreads && _numThreads <= BX_CONFIG_JOBSYSTEM_MAX_THREADS
+				, "Invalid number of threads %d (max: %d)."
+				, _numThreads
+				, BX_CONFIG_JOBSYSTEM_MAX_THREADS
+				);
+
+			m_numThreads = _numThreads;
+			m_exit.store(0, MemoryOrder::Relaxed);
+
+			// Worker 0 is shared deque for threads that are not workers.
+			// Workers contain cache line aligned deques, and array new
+			// doesn't guarantee alignment larger than 16 bytes.
+			m_workerMem = new uint8_t[(m_numThreads+1)*sizeof(Worker) + BX_CACHE_LINE_SIZE-1];
+			m_worker = (Worker*)(uintptr_t(m_workerMem + BX_CACHE_LINE_SIZE-1) & ~uintptr_t(BX_CACHE_LINE_SIZE-1) );
+			for (uint32_t ii = 0; ii <= m_numThreads; ++ii)
+			{
+				::new(&m_worker[ii]) Worker;
+				m_worker[ii].m_jobSystem = this;
+				m_worker[ii].m_index = ii;
+				m_worker[ii].m_rng = ii*0x9e3779b9+1;
+			}
+
+			for (uint32_t ii = 1; ii <= m_numThreads; ++ii)
+			{
+				m_worker[ii].m_thread.init(workerFunc, &m_worker[ii]);
+			}
+		}
+
+		void shutdown()
+		{
+			BX_CHECK(NULL != m_worker, "Not initialized!");
+
+			m_exit.store(1, MemoryOrder::Release);
+			m_sem.post(m_numThreads);
+
+			for (uint32_t ii = 1; ii <= m_numThreads; ++ii)
+			{
+				m_worker[ii].m_thread.shutdown();
+			}
+
+			for (uint32_t ii = 0; ii <= m_numThreads; ++ii)
+			{
+				m_worker[ii].~Worker();
+			}
+
+			delete [] m_workerMem;
+			m_workerMem = NULL;
+			m_worker = NULL;
+			m_numThreads = 0;
+		}
+
+		uint32_t getNumThreads() const
+		{
+			return m_numThreads;
+		}
+
+		/// Returns worker index of calling thread, or 0 if calling thread is
+		/// not worker of this job system.
+		uint32_t getWorkerIndex() const
+		{
+			const Worker* worker = (const Worker*)m_tls.get();
+			return NULL != worker ? worker->m_index : 0;
+		}
+
+		void submit(JobFn _fn, void* _userData, JobCounter* _counter = NULL)
+		{
+			Job job;
+			job.m_fn = _fn;
+			job.m_userData = _userData;
+			job.m_counter = _counter;
+			submit(&job, 1);
+		}
+
+		void submit(const Job* _jobs, uint32_t _num)
+		{
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				if (NULL != _jobs[ii].m_counter)
+				{
+					retain(_jobs[ii].m_counter);
+				}
+			}
+
+			Worker& worker = m_worker[getWorkerIndex()];
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				Job job = _jobs[ii];
+#if BX_CONFIG_PROFILER
+				job.m_flowId = profileFlowBegin("submit");
+#endif // BX_CONFIG_PROFILER
+
+				if (!push(worker, job) )
+				{
+					// Queue is full, execute job immediately.
+					execute(job);
+				}
+			}
+
+			// Push must be visible before sleeping workers are checked.
+			atomicFence(MemoryOrder::SeqCst);
+			const int32_t numSleeping = m_numSleeping.load(MemoryOrder::Relaxed);
+			if (0 < numSleeping)
+			{
+				m_sem.post(uint32_min(_num, uint32_t(numSleeping) ) );
+			}
+		}
+
+		/// Executes other jobs until all jobs associated with counter are
+		/// done.
+		void wait(JobCounter* _counter)
+		{
+			Worker& worker = m_worker[getWorkerIndex()];
+
+			for (uint32_t spin = 0; !_counter->isDone(); )
+			{
+				Job job;
+				if (getJob(worker, job) )
+				{
+					execute(job);
+					spin = 0;
+				}
+				else if (++spin < BX_CONFIG_JOBSYSTEM_SPIN_COUNT)
+				{
+					cpuPause();
+				}
+				else
+				{
+					yield();
+				}
+			}
+		}
+
+		/// Adds pending work to counter without submitting job. Must be
+		/// matched with release. Used for work that is not finished when
+		/// job function returns, e.g. suspended fiber.
+		void retain(JobCounter* _counter)
+		{
+			_counter->m_value.fetchAdd(1, MemoryOrder::Relaxed);
+		}
+
+		/// Marks pending work of counter as done. When counter reaches zero
+		/// all its continuations are submitted.
+		void release(JobCounter* _counter)
+		{
+			// Work results must be visible before counter is decremented,
+			// and continuation must see results of all work.
+			const int32_t old = _counter->m_value.fetchSub(1, MemoryOrder::AcqRel);
+
+			// Counter must not be touched once it's done, since waiter is
+			// free to destroy it. Counter with continuation bit set is not
+			// done, list is taken before bit is cleared.
+			if ( (JobCounter::Continuation|1) == old)
+			{
+				JobContinuation* continuation = _counter->m_continuation.exchange(NULL, MemoryOrder::Acquire);
+
+				// If work was added in the meantime bit stays set, and
+				// continuations registered since are submitted when count
+				// reaches zero again.
+				int32_t expected = JobCounter::Continuation;
+				_counter->m_value.compareExchange(expected, 0, MemoryOrder::Release);
+
+				while (NULL != continuation)
+				{
+					// Continuation can be reused as soon as it's submitted.
+					JobContinuation* next = continuation->m_next;
+					submit(&continuation->m_job, 1);
+					continuation = next;
+				}
+			}
+		}
+
+		/// Submits _continuation job when all work associated with counter
+		/// is done. Any number of continuations can be registered on the
+		/// same counter, each must stay valid until it's submitted. Returns
+		/// false if counter is already done, in which case job is not
+		/// submitted.
+		bool setContinuation(JobCounter* _counter, JobContinuation* _continuation)
+		{
+			// Registration holds reference, so count can't reach zero
+			// before continuation is in the list.
+			int32_t old = _counter->m_value.load(MemoryOrder::Relaxed);
+			do
+			{
+				if (0 == (old & INT32_MAX) )
+				{
+					return false;
+				}
+
+			} while (!_counter->m_value.compareExchange(old, (old+1)|JobCounter::Continuation, MemoryOrder::Relaxed) );
+
+			JobContinuation* head = _counter->m_continuation.load(MemoryOrder::Relaxed);
+			do
+			{
+				_continuation->m_next = head;
+
+			} while (!_counter->m_continuation.compareExchange(head, _continuation, MemoryOrder::Release) );
+
+			release(_counter);
+
+			return true;
+		}
+
+	private:
+		struct Worker
+		{
+			WorkStealingQueue<Job, BX_CONFIG_JOBSYSTEM_QUEUE_SIZE> m_queue;
+			LwMutex m_lock;
+			Thread m_thread;
+			JobSystem* m_jobSystem;
+			uint32_t m_index;
+			uint32_t m_rng;
+		};
+
+		static int32_t workerFunc(void* _userData)
+		{
+			Worker& worker = *(Worker*)_userData;
+			return worker.m_jobSystem->run(worker);
+		}
+
+		int32_t run(Worker& _worker)
+		{
+			m_tls.set(&_worker);
+			BX_PROFILE_THREAD_NAME("bx worker");
+
+			uint32_t spin = 0;
+			while (0 == m_exit.load(MemoryOrder::Acquire) )
+			{
+				Job job;
+				if (getJob(_worker, job) )
+				{
+					execute(job);
+					spin = 0;
+					continue;
+				}
+
+				if (++spin < BX_CONFIG_JOBSYSTEM_SPIN_COUNT)
+				{
+					cpuPause();
+					continue;
+				}
+
+				spin = 0;
+
+				// Recheck after announcing sleep, otherwise job submitted
+				// between last check and increment would not wake anyone.
+				m_numSleeping.fetchAdd(1);
+				if (getJob(_worker, job) )
+				{
+					m_numSleeping.fetchSub(1, MemoryOrder::Relaxed);
+					execute(job);
+					continue;
+				}
+
+				m_sem.wait();
+				m_numSleeping.fetchSub(1, MemoryOrder::Relaxed);
+			}
+
+			m_tls.set(NULL);
+
+			return 0;
+		}
+
+		bool push(Worker& _worker, const Job& _job)
+		{
+			if (0 == _worker.m_index)
+			{
+				LwMutexScope lock(_worker.m_lock);
+				return _worker.m_queue.push(_job);
+			}
+
+			return _worker.m_queue.push(_job);
+		}
+
+		bool getJob(Worker& _worker, Job& _job)
+		{
+			if (0 == _worker.m_index)
+			{
+				if (!_worker.m_queue.isEmpty() )
+				{
+					LwMutexScope lock(_worker.m_lock);
+					if (_worker.m_queue.pop(_job) )
+					{
+						return true;
+					}
+				}
+			}
+			else if (_worker.m_queue.pop(_job) )
+			{
+				return true;
+			}
+
+			// xorshift, pick random victim to spread thieves.
+			uint32_t rng = _worker.m_rng;
+			rng ^= rng << 13;
+			rng ^= rng >> 17;
+			rng ^= rng << 5;
+			_worker.m_rng = rng;
+
+			const uint32_t num = m_numThreads+1;
+			for (uint32_t ii = 0, victim = rng % num; ii < num; ++ii, victim = (victim+1) % num)
+			{
+				if (victim != _worker.m_index
+				&&  m_worker[victim].m_queue.steal(_job) )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void execute(const Job& _job)
+		{
+#if BX_CONFIG_PROFILER
+			ProfileScope scope("job");
+			profileFlowEnd("job", _job.m_flowId);
+#endif // BX_CONFIG_PROFILER
+
+			_job.m_fn(_job.m_userData);
+
+			if (NULL != _job.m_counter)
+			{
+				release(_job.m_counter);
+			}
+		}
+
+		Worker* m_worker;
+		uint8_t* m_workerMem;
+		uint32_t m_numThreads;
+		Atomic<int32_t> m_numSleeping;
+		Atomic<uint32_t> m_exit;
+		Semaphore m_sem;
+		TlsData m_tls;
+	};
+
+	inline JobSystem*& jobSystemInstance()
+	{
+		static JobSystem* s_jobSystem = NULL;
+		return s_jobSystem;
+	}
+
+	/// Sets job system shared by helpers that don't take job system
+	/// argument (parallelFor, parallelReduce...). Pass NULL to unset.
+	inline void setJobSystem(JobSystem* _jobSystem)
+	{
+		jobSystemInstance() = _jobSystem;
+	}
+
+	inline JobSystem* getJobSystem()
+	{
+		return jobSystemInstance();
+	}
+
+} // namespace bx
+
+#endif // __BX_JOBSYSTEM_H__
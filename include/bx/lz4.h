@@ -0,0 +1,737 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_LZ4_H__
+#define __BX_LZ4_H__
+
+#include <string.h> // memcpy, memset
+
+#include "bx.h"
+#include "endian.h"
+#include "readerwriter.h"
+#include "uint32_t.h"
+
+/// Size of compressor hash table is 2^bits entries. Larger table finds
+/// more matches in large blocks, but costs more to clear per block.
+#ifndef BX_CONFIG_LZ4_HASH_BITS
+#	define BX_CONFIG_LZ4_HASH_BITS 12
+#endif // BX_CONFIG_LZ4_HASH_BITS
+
+/// Largest block DecompressingReader accepts. Corrupt block header can't
+/// make reader allocate more than this.
+#ifndef BX_CONFIG_LZ4_MAX_BLOCK_SIZE
+#	define BX_CONFIG_LZ4_MAX_BLOCK_SIZE (64<<20)
+#endif // BX_CONFIG_LZ4_MAX_BLOCK_SIZE
+
+namespace bx
+{
+	/// LZ4 block format
+	/// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+	///
+	/// Output of lz4Compress can be decompressed by any LZ4 block
+	/// decompressor and vice versa. Frame format used by CompressingWriter
+	/// is not LZ4 frame format, see Lz4BlockHeader.
+	struct Lz4
+	{
+		enum Enum
+		{
+			MinMatch     = 4,
+			LastLiterals = 5,  //!< Last 5 bytes of block are always literals.
+			MatchLimit   = 12, //!< Last match starts at least 12 bytes before end.
+			MaxOffset    = 65535,
+			HashBits     = BX_CONFIG_LZ4_HASH_BITS,
+		};
+	};
+
+	/// Worst case compressed size of _size bytes.
+	inline int32_t lz4CompressBound(int32_t _size)
+	{
+		return _size + _size/255 + 16;
+	}
+
+	inline uint32_t lz4Read32(const uint8_t* _ptr)
+	{
+		uint32_t value;
+		memcpy(&value, _ptr, sizeof(value) );
+		return value;
+	}
+
+	inline uint64_t lz4Read64(const uint8_t* _ptr)
+	{
+		uint64_t value;
+		memcpy(&value, _ptr, sizeof(value) );
+		return value;
+	}
+
+	inline uint32_t lz4Hash(const uint8_t* _ptr)
+	{
+		return (lz4Read32(_ptr)*2654435761u) >> (32-Lz4::HashBits);
+	}
+
+	/// Returns number of equal bytes at _ptr and _ref, stopping at _end.
+	inline uint32_t lz4MatchLength(const uint8_t* _ptr, const uint8_t* _ref, const uint8_t* _end)
+	{
+		const uint8_t* start = _ptr;
+
+		while (_ptr + 8 <= _end)
+		{
+			const uint64_t diff = lz4Read64(_ptr) ^ lz4Read64(_ref);
+			if (0 != diff)
+			{
+#if BX_CPU_ENDIAN_LITTLE
+				return uint32_t(_ptr - start) + uint32_t(uint64_cnttz(diff)>>3);
+#else
+				return uint32_t(_ptr - start) + uint32_t(uint64_cntlz(diff)>>3);
+#endif // BX_CPU_ENDIAN_LITTLE
+			}
+
+			_ptr += 8;
+			_ref += 8;
+		}
+
+		while (_ptr < _end
+		&&     *_ptr == *_ref)
+		{
+			++_ptr;
+			++_ref;
+		}
+
+		return uint32_t(_ptr - start);
+	}
+
+	/// Writes LZ4 length continuation bytes for length above 15.
+	inline uint8_t* lz4WriteLength(uint8_t* _dst, uint32_t _len)
+	{
+		for (; _len >= 255; _len -= 255)
+		{
+			*_dst++ = 255;
+		}
+
+		*_dst++ = uint8_t(_len);
+		return _dst;
+	}
+
+	inline uint8_t* lz4WriteSequence(uint8_t* _dst, const uint8_t* _literals, uint32_t _litLen, uint32_t _offset, uint32_t _matchLen)
+	{
+		const uint32_t matchCode = _matchLen - Lz4::MinMatch;
+		uint8_t* token = _dst++;
+		*token = uint8_t( (uint32_min(_litLen, 15)<<4) | uint32_min(matchCode, 15) );
+
+		if (_litLen >= 15)
+		{
+			_dst = lz4WriteLength(_dst, _litLen - 15);
+		}
+
+		// Match is followed by at least 12 input bytes, and output bound
+		// has 16 bytes of slack, so 8 byte chunks never cross either end.
+		for (uint32_t ii = 0; ii < _litLen; ii += 8)
+		{
+			memcpy(&_dst[ii], &_literals[ii], 8);
+		}
+
+		_dst += _litLen;
+
+		*_dst++ = uint8_t(_offset);
+		*_dst++ = uint8_t(_offset>>8);
+
+		if (matchCode >= 15)
+		{
+			_dst = lz4WriteLength(_dst, matchCode - 15);
+		}
+
+		return _dst;
+	}
+
+	/// Compresses _srcSize bytes into LZ4 block. _dst must be at least
+	/// lz4CompressBound(_srcSize) bytes. Returns compressed size.
+	///
+	/// Greedy single probe matcher, same approach as LZ4 fast mode. Search
+	/// step grows while no match is found, so incompressible data is
+	/// skipped quickly.
+	inline int32_t lz4Compress(void* _dst, const void* _src, int32_t _srcSize)
+	{
+		uint8_t* dst = (uint8_t*)_dst;
+		const uint8_t* src = (const uint8_t*)_src;
+		const uint8_t* end = src + _srcSize;
+		const uint8_t* anchor = src;
+
+		if (_srcSize > Lz4::MatchLimit)
+		{
+			uint32_t table[1<<Lz4::HashBits];
+			memset(table, 0, sizeof(table) );
+
+			const uint8_t* matchLimit = end - Lz4::MatchLimit;
+			const uint8_t* matchEnd   = end - Lz4::LastLiterals;
+			const uint8_t* ptr = src + 1;
+
+			while (ptr < matchLimit)
+			{
+				const uint32_t hash = lz4Hash(ptr);
+				const uint8_t* ref = src + table[hash];
+				table[hash] = uint32_t(ptr - src);
+
+				if (uint32_t(ptr - ref) > Lz4::MaxOffset
+				||  lz4Read32(ptr) != lz4Read32(ref) )
+				{
+					ptr += 1 + (uint32_t(ptr - anchor)>>6);
+					continue;
+				}
+
+				while (ptr > anchor
+				&&     ref > src
+				&&     ptr[-1] == ref[-1])
+				{
+					--ptr;
+					--ref;
+				}
+
+				const uint32_t matchLen = Lz4::MinMatch
+					+ lz4MatchLength(ptr + Lz4::MinMatch, ref + Lz4::MinMatch, matchEnd)
+					;
+
+				dst = lz4WriteSequence(dst
+					, anchor
+					, uint32_t(ptr - anchor)
+					, uint32_t(ptr - ref)
+					, matchLen
+					);
+
+				ptr += matchLen;
+				anchor = ptr;
+
+				if (ptr < matchLimit)
+				{
+					table[lz4Hash(ptr-2)] = uint32_t(ptr - 2 - src);
+				}
+			}
+		}
+
+		const uint32_t litLen = uint32_t(end - anchor);
+		*dst++ = uint8_t(uint32_min(litLen, 15)<<4);
+
+		if (litLen >= 15)
+		{
+			dst = lz4WriteLength(dst, litLen - 15);
+		}
+
+		memcpy(dst, anchor, litLen);
+		dst += litLen;
+
+		return int32_t(dst - (uint8_t*)_dst);
+	}
+
+	/// Reads LZ4 length continuation bytes. Returns false if input ends
+	/// or length exceeds _max.
+	inline bool lz4ReadLength(const uint8_t*& _ptr, const uint8_t* _end, uint32_t& _len, uint32_t _max)
+	{
+		uint32_t byte;
+		do
+		{
+			if (_ptr >= _end)
+			{
+				return false;
+			}
+
+			byte = *_ptr++;
+			_len += byte;
+
+			if (_len > _max)
+			{
+				return false;
+			}
+
+		} while (255 == byte);
+
+		return true;
+	}
+
+	/// Decompresses LZ4 block into _dst of _dstSize bytes. Returns
+	/// decompressed size, or -1 if block is corrupt or doesn't fit in
+	/// _dst. Never reads or writes outside of given buffers.
+	///
+	/// Literals and matches are copied in 8 or 16 byte chunks, which may
+	/// write past their end when there is room left in _dst. Bytes past
+	/// end are overwritten by following sequence, and content of _dst past
+	/// returned size is undefined.
+	inline int32_t lz4Decompress(void* _dst, int32_t _dstSize, const void* _src, int32_t _srcSize)
+	{
+		uint8_t* dst = (uint8_t*)_dst;
+		uint8_t* dstEnd = dst + _dstSize;
+		const uint8_t* src = (const uint8_t*)_src;
+		const uint8_t* srcEnd = src + _srcSize;
+
+		for (;;)
+		{
+			if (src >= srcEnd)
+			{
+				return -1;
+			}
+
+			const uint32_t token = *src++;
+
+			uint32_t litLen = token>>4;
+
+			// Common case, short literals are copied with single 16 byte
+			// move. Sequence can't be last, since last one ends exactly at
+			// end of input.
+			if (15 != litLen
+			&&  srcEnd - src >= 32
+			&&  dstEnd - dst >= 32)
+			{
+				memcpy(dst, src, 16);
+				dst += litLen;
+				src += litLen;
+			}
+			else
+			{
+				if (15 == litLen
+				&&  !lz4ReadLength(src, srcEnd, litLen, uint32_t(srcEnd - src) ) )
+				{
+					return -1;
+				}
+
+				if (litLen > uint32_t(srcEnd - src)
+				||  litLen > uint32_t(dstEnd - dst) )
+				{
+					return -1;
+				}
+
+				// Room for copying in 16 byte chunks past end of literals.
+				if (uint32_t(srcEnd - src) - litLen >= 16
+				&&  uint32_t(dstEnd - dst) - litLen >= 16)
+				{
+					for (uint32_t ii = 0; ii < litLen; ii += 16)
+					{
+						memcpy(&dst[ii], &src[ii], 16);
+					}
+				}
+				else
+				{
+					memcpy(dst, src, litLen);
+				}
+
+				dst += litLen;
+				src += litLen;
+
+				// Last sequence has only literals.
+				if (src == srcEnd)
+				{
+					break;
+				}
+			}
+
+			if (srcEnd - src < 2)
+			{
+				return -1;
+			}
+
+			const uint32_t offset = uint32_t(src[0]) | (uint32_t(src[1])<<8);
+			src += 2;
+
+			if (0 == offset
+			||  offset > uint32_t(dst - (uint8_t*)_dst) )
+			{
+				return -1;
+			}
+
+			uint32_t matchLen = token&15;
+
+			// Short match, up to 18 bytes, copied with three 8 byte moves.
+			if (15 != matchLen
+			&&  offset >= 8
+			&&  dstEnd - dst >= 32)
+			{
+				const uint8_t* ref = dst - offset;
+				memcpy(&dst[ 0], &ref[ 0], 8);
+				memcpy(&dst[ 8], &ref[ 8], 8);
+				memcpy(&dst[16], &ref[16], 8);
+				dst += matchLen + Lz4::MinMatch;
+				continue;
+			}
+
+			if (15 == matchLen
+			&&  !lz4ReadLength(src, srcEnd, matchLen, uint32_t(dstEnd - dst) ) )
+			{
+				return -1;
+			}
+
+			matchLen += Lz4::MinMatch;
+			if (matchLen > uint32_t(dstEnd - dst) )
+			{
+				return -1;
+			}
+
+			const uint8_t* ref = dst - offset;
+
+			if (uint32_t(dstEnd - dst) - matchLen >= 16)
+			{
+				if (offset >= 16)
+				{
+					for (uint32_t ii = 0; ii < matchLen; ii += 16)
+					{
+						memcpy(&dst[ii], &ref[ii], 16);
+					}
+				}
+				else if (offset >= 8)
+				{
+					for (uint32_t ii = 0; ii < matchLen; ii += 8)
+					{
+						memcpy(&dst[ii], &ref[ii], 8);
+					}
+				}
+				else
+				{
+					// Repeat pattern to first 8 bytes, then copy 8 byte
+					// chunks from distance that is multiple of offset.
+					// Distance is less than offset+8, so chunks are read
+					// only from bytes that already hold pattern.
+					static const uint8_t s_distance[8] = { 0, 8, 8, 9, 8, 10, 12, 14 };
+					const uint32_t distance = s_distance[offset];
+
+					for (uint32_t ii = 0; ii < 8; ++ii)
+					{
+						dst[ii] = ref[ii];
+					}
+
+					for (uint32_t ii = 8; ii < matchLen; ii += 8)
+					{
+						memcpy(&dst[ii], &dst[ii] - distance, 8);
+					}
+				}
+			}
+			else if (offset >= matchLen)
+			{
+				memcpy(dst, ref, matchLen);
+			}
+			else
+			{
+				for (uint32_t ii = 0; ii < matchLen; ++ii)
+				{
+					dst[ii] = ref[ii];
+				}
+			}
+
+			dst += matchLen;
+		}
+
+		return int32_t(dst - (uint8_t*)_dst);
+	}
+
+	/// Header of block written by CompressingWriter. Stream is sequence of
+	/// independent blocks, each one is 8 byte header, followed by payload:
+	///
+	///     uint32_t compressedSize; // little endian, bit 31 set if stored
+	///     uint32_t size;           // little endian, decompressed size
+	///     uint8_t  payload[compressedSize & 0x7fffffff];
+	///
+	/// Blocks don't reference each other, so reader can scan headers and
+	/// decompress blocks in parallel with lz4DecompressBlock.
+	struct Lz4BlockHeader
+	{
+		enum Enum
+		{
+			Size   = 8,
+			Stored = 0x80000000, //!< Payload is not compressed.
+		};
+
+		uint32_t m_compressedSize; //!< Payload size.
+		uint32_t m_size;           //!< Decompressed size.
+		bool m_stored;
+	};
+
+	inline void lz4WriteBlockHeader(void* _dst, const Lz4BlockHeader& _header)
+	{
+		const uint32_t header[2] =
+		{
+			toLittleEndian(_header.m_compressedSize | (_header.m_stored ? uint32_t(Lz4BlockHeader::Stored) : 0) ),
+			toLittleEndian(_header.m_size),
+		};
+		memcpy(_dst, header, sizeof(header) );
+	}
+
+	/// Parses Lz4BlockHeader::Size bytes at _src. Returns false if header
+	/// is invalid.
+	inline bool lz4ReadBlockHeader(const void* _src, Lz4BlockHeader& _header)
+	{
+		uint32_t header[2];
+		memcpy(header, _src, sizeof(header) );
+		const uint32_t compressedSize = toHostEndian(header[0], true);
+
+		_header.m_compressedSize = compressedSize & ~uint32_t(Lz4BlockHeader::Stored);
+		_header.m_size   = toHostEndian(header[1], true);
+		_header.m_stored = 0 != (compressedSize & Lz4BlockHeader::Stored);
+
+		return _header.m_size <= BX_CONFIG_LZ4_MAX_BLOCK_SIZE
+			&& _header.m_compressedSize <= uint32_t(lz4CompressBound(int32_t(_header.m_size) ) )
+			&& (!_header.m_stored || _header.m_compressedSize == _header.m_size)
+			;
+	}
+
+	/// Decompresses block payload described by _header into _dst. Returns
+	/// false if payload is corrupt.
+	inline bool lz4DecompressBlock(void* _dst, const Lz4BlockHeader& _header, const void* _payload)
+	{
+		if (_header.m_stored)
+		{
+			memcpy(_dst, _payload, _header.m_size);
+			return true;
+		}
+
+		return int32_t(_header.m_size) == lz4Decompress(_dst
+			, int32_t(_header.m_size)
+			, _payload
+			, int32_t(_header.m_compressedSize)
+			);
+	}
+
+	/// Compresses written data in independent LZ4 blocks of _blockSize
+	/// bytes and forwards framed blocks to underlying writer. Block that
+	/// doesn't compress is stored as is. Partial block is written on flush
+	/// and on destruction.
+	class CompressingWriter : public WriterI
+	{
+		BX_CLASS(CompressingWriter
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		CompressingWriter(WriterI* _writer, uint32_t _blockSize = 64<<10)
+			: m_writer(_writer)
+			, m_buffer(new uint8_t[_blockSize])
+			, m_compressed(new uint8_t[lz4CompressBound(int32_t(_blockSize) )])
+			, m_pos(0)
+			, m_size(_blockSize)
+		{
+			BX_CHECK(_blockSize <= BX_CONFIG_LZ4_MAX_BLOCK_SIZE, "Block size %d is above BX_CONFIG_LZ4_MAX_BLOCK_SIZE.", _blockSize);
+		}
+
+		virtual ~CompressingWriter()
+		{
+			flush();
+			delete [] m_compressed;
+			delete [] m_buffer;
+		}
+
+		virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
+		{
+			const uint8_t* data = (const uint8_t*)_data;
+			uint32_t size = uint32_t(_size);
+
+			while (0 < size)
+			{
+				// Whole blocks are compressed directly from caller's
+				// buffer.
+				if (0 == m_pos
+				&&  size >= m_size)
+				{
+					if (0 > writeBlock(data, m_size) )
+					{
+						return _size - int32_t(size);
+					}
+
+					data += m_size;
+					size -= m_size;
+					continue;
+				}
+
+				const uint32_t copy = uint32_min(size, m_size - m_pos);
+				memcpy(&m_buffer[m_pos], data, copy);
+				m_pos += copy;
+				data  += copy;
+				size  -= copy;
+
+				if (m_pos == m_size
+				&&  0 > flush() )
+				{
+					return _size - int32_t(size);
+				}
+			}
+
+			return _size;
+		}
+
+		/// Compresses and writes partial block. Returns number of bytes
+		/// written by underlying writer, or -1 on failure.
+		int32_t flush()
+		{
+			if (0 == m_pos)
+			{
+				return 0;
+			}
+
+			const uint32_t size = m_pos;
+			m_pos = 0;
+
+			return writeBlock(m_buffer, size);
+		}
+
+	private:
+		int32_t writeBlock(const uint8_t* _data, uint32_t _size)
+		{
+			const int32_t compressedSize = lz4Compress(m_compressed, _data, int32_t(_size) );
+
+			Lz4BlockHeader header;
+			header.m_stored = uint32_t(compressedSize) >= _size;
+			header.m_compressedSize = header.m_stored ? _size : uint32_t(compressedSize);
+			header.m_size = _size;
+
+			uint8_t temp[Lz4BlockHeader::Size];
+			lz4WriteBlockHeader(temp, header);
+
+			IoVec iov[2] =
+			{
+				{ temp, Lz4BlockHeader::Size },
+				{ header.m_stored ? _data : m_compressed, int32_t(header.m_compressedSize) },
+			};
+
+			const int32_t total = Lz4BlockHeader::Size + int32_t(header.m_compressedSize);
+			return total == m_writer->writev(iov, BX_COUNTOF(iov) ) ? total : -1;
+		}
+
+		WriterI* m_writer;
+		uint8_t* m_buffer;
+		uint8_t* m_compressed;
+		uint32_t m_pos;
+		uint32_t m_size;
+	};
+
+	/// Reads blocks written by CompressingWriter and returns decompressed
+	/// data. Reads that cover whole block are decompressed directly into
+	/// caller's buffer. Read returns fewer bytes than requested at end of
+	/// stream, or when block is corrupt.
+	class DecompressingReader : public ReaderI
+	{
+		BX_CLASS(DecompressingReader
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		DecompressingReader(ReaderI* _reader, uint32_t _blockSize = 64<<10)
+			: m_reader(_reader)
+			, m_buffer(new uint8_t[_blockSize])
+			, m_compressed(new uint8_t[lz4CompressBound(int32_t(_blockSize) )])
+			, m_pos(0)
+			, m_top(0)
+			, m_size(_blockSize)
+			, m_error(false)
+		{
+		}
+
+		virtual ~DecompressingReader()
+		{
+			delete [] m_compressed;
+			delete [] m_buffer;
+		}
+
+		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+		{
+			uint8_t* data = (uint8_t*)_data;
+			uint32_t size = uint32_t(_size);
+
+			while (0 < size)
+			{
+				if (m_pos == m_top)
+				{
+					Lz4BlockHeader header;
+					if (!readBlock(header) )
+					{
+						break;
+					}
+
+					if (size >= header.m_size)
+					{
+						if (!decompress(data, header) )
+						{
+							break;
+						}
+
+						data += header.m_size;
+						size -= header.m_size;
+						continue;
+					}
+
+					if (!decompress(m_buffer, header) )
+					{
+						break;
+					}
+
+					m_pos = 0;
+					m_top = header.m_size;
+				}
+
+				const uint32_t copy = uint32_min(size, m_top - m_pos);
+				memcpy(data, &m_buffer[m_pos], copy);
+				m_pos += copy;
+				data  += copy;
+				size  -= copy;
+			}
+
+			return _size - int32_t(size);
+		}
+
+		/// Returns true if corrupt block was encountered.
+		bool isCorrupt() const
+		{
+			return m_error;
+		}
+
+	private:
+		bool readBlock(Lz4BlockHeader& _header)
+		{
+			if (m_error)
+			{
+				return false;
+			}
+
+			uint8_t temp[Lz4BlockHeader::Size];
+			const int32_t result = m_reader->read(temp, Lz4BlockHeader::Size);
+			if (Lz4BlockHeader::Size != result)
+			{
+				// Clean end of stream is not an error.
+				m_error = 0 < result;
+				return false;
+			}
+
+			if (!lz4ReadBlockHeader(temp, _header) )
+			{
+				m_error = true;
+				return false;
+			}
+
+			if (_header.m_size > m_size)
+			{
+				delete [] m_compressed;
+				delete [] m_buffer;
+				m_size = _header.m_size;
+				m_buffer = new uint8_t[m_size];
+				m_compressed = new uint8_t[lz4CompressBound(int32_t(m_size) )];
+			}
+
+			const int32_t payload = int32_t(_header.m_compressedSize);
+			m_error = payload != m_reader->read(m_compressed, payload);
+
+			return !m_error;
+		}
+
+		bool decompress(uint8_t* _dst, const Lz4BlockHeader& _header)
+		{
+			m_error = !lz4DecompressBlock(_dst, _header, m_compressed);
+			return !m_error;
+		}
+
+		ReaderI* m_reader;
+		uint8_t* m_buffer;
+		uint8_t* m_compressed;
+		uint32_t m_pos;
+		uint32_t m_top;
+		uint32_t m_size;
+		bool m_error;
+	};
+
+} // namespace bx
+
+#endif // __BX_LZ4_H__
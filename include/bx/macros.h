@@ -50,6 +50,7 @@
 #	define BX_NO_VTABLE
 #	define BX_OVERRIDE
 #	define BX_PRINTF_ARGS(_format, _args) __attribute__ ( (format(__printf__, _format, _args) ) )
+#	define BX_TARGET(_target) __attribute__( (target(_target) ) )
 #	if BX_COMPILER_CLANG || BX_PLATFORM_IOS
 #		define BX_THREAD /* not supported right now */
 #	else
@@ -66,11 +67,23 @@
 #	define BX_NO_VTABLE __declspec(novtable)
 #	define BX_OVERRIDE override
 #	define BX_PRINTF_ARGS(_format, _args)
+#	define BX_TARGET(_target)
 #	define BX_THREAD __declspec(thread)
 #else
 #	error "Unknown BX_COMPILER_?"
 #endif
 
+/// Compiler accepts ISA extension intrinsics (SSSE3, SSE4.2, AVX2) in
+/// functions marked with BX_TARGET, so they can be selected at runtime
+/// by CPU features.
+#ifndef BX_CONFIG_TARGET_DISPATCH
+#	define BX_CONFIG_TARGET_DISPATCH (BX_CPU_X86 && (0 \
+				|| BX_COMPILER_CLANG \
+				|| (BX_COMPILER_GCC && (__GNUC__*100 + __GNUC_MINOR__) >= 409) \
+				|| (BX_COMPILER_MSVC && _MSC_VER >= 1910) \
+				) )
+#endif // BX_CONFIG_TARGET_DISPATCH
+
 // #define BX_STATIC_ASSERT(_condition, ...) static_assert(_condition, "" __VA_ARGS__)
 #define BX_STATIC_ASSERT(_condition, ...) typedef char BX_CONCATENATE(BX_STATIC_ASSERT_, __LINE__)[1][(_condition)]
 
@@ -161,8 +174,45 @@
 				)
 #endif // BX_CONFIG_CRT_FILE_READER_WRITER
 
+#ifndef BX_CONFIG_MMAP_FILE_READER
+#	define BX_CONFIG_MMAP_FILE_READER (0 \
+				|BX_PLATFORM_ANDROID \
+				|BX_PLATFORM_IOS \
+				|BX_PLATFORM_LINUX \
+				|BX_PLATFORM_OSX \
+				|BX_PLATFORM_QNX \
+				|BX_PLATFORM_WINDOWS \
+				)
+#endif // BX_CONFIG_MMAP_FILE_READER
+
+#ifndef BX_CONFIG_FD_FILE_READER_WRITER
+#	define BX_CONFIG_FD_FILE_READER_WRITER (0 \
+				|BX_PLATFORM_ANDROID \
+				|BX_PLATFORM_IOS \
+				|BX_PLATFORM_LINUX \
+				|BX_PLATFORM_OSX \
+				|BX_PLATFORM_QNX \
+				)
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+
 #ifndef BX_CONFIG_SEMAPHORE_PTHREAD
 #	define BX_CONFIG_SEMAPHORE_PTHREAD (BX_PLATFORM_OSX|BX_PLATFORM_IOS)
 #endif // BX_CONFIG_SEMAPHORE_PTHREAD
 
+#ifndef BX_CONFIG_SPINLOCK_MAX_BACKOFF
+#	define BX_CONFIG_SPINLOCK_MAX_BACKOFF 1024
+#endif // BX_CONFIG_SPINLOCK_MAX_BACKOFF
+
+#ifndef BX_CONFIG_LWMUTEX_SPIN_COUNT
+#	define BX_CONFIG_LWMUTEX_SPIN_COUNT 128
+#endif // BX_CONFIG_LWMUTEX_SPIN_COUNT
+
+#ifndef BX_CONFIG_MUTEX_PROFILE
+#	define BX_CONFIG_MUTEX_PROFILE 0
+#endif // BX_CONFIG_MUTEX_PROFILE
+
+#ifndef BX_CONFIG_LWMUTEX_FUTEX
+#	define BX_CONFIG_LWMUTEX_FUTEX (BX_PLATFORM_LINUX|BX_PLATFORM_ANDROID)
+#endif // BX_CONFIG_LWMUTEX_FUTEX
+
 #endif // __BX_MACROS_H__
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_MPMCQUEUE_H__
+#define __BX_MPMCQUEUE_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "uint32_t.h"
+
+namespace bx
+{
+	/// Bounded multi-producer multi-consumer queue of pointers. Capacity
+	/// is rounded up to power of two. Each cell carries sequence number
+	/// which tells producers and consumers whether cell is free or full,
+	/// so push and pop are single CAS on uncontended path.
+	///
+	/// Bounded MPMC queue
+	/// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+	template <typename Ty>
+	class MpMcBoundedQueueLf
+	{
+		BX_CLASS(MpMcBoundedQueueLf
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		MpMcBoundedQueueLf(uint32_t _capacity)
+			: m_mask(uint32_nextpow2(uint32_max(_capacity, 2) ) - 1)
+			, m_cell(new Cell[m_mask+1])
+		{
+			for (uint32_t ii = 0; ii <= m_mask; ++ii)
+			{
+				m_cell[ii].m_sequence.store(ii, MemoryOrder::Relaxed);
+			}
+		}
+
+		~MpMcBoundedQueueLf()
+		{
+			delete [] m_cell;
+		}
+
+		/// Returns false if queue is full.
+		bool push(Ty* _ptr)
+		{
+			uint32_t pos = m_write.load(MemoryOrder::Relaxed);
+
+			for (;;)
+			{
+				Cell& cell = m_cell[pos & m_mask];
+				const uint32_t sequence = cell.m_sequence.load(MemoryOrder::Acquire);
+				const int32_t diff = int32_t(sequence - pos);
+
+				if (0 == diff)
+				{
+					if (m_write.compareExchange(pos, pos+1, MemoryOrder::Relaxed) )
+					{
+						cell.m_ptr = _ptr;
+						cell.m_sequence.store(pos+1, MemoryOrder::Release);
+						return true;
+					}
+				}
+				else if (0 > diff)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_write.load(MemoryOrder::Relaxed);
+				}
+			}
+		}
+
+		/// Returns NULL if queue is empty.
+		Ty* pop()
+		{
+			uint32_t pos = m_read.load(MemoryOrder::Relaxed);
+
+			for (;;)
+			{
+				Cell& cell = m_cell[pos & m_mask];
+				const uint32_t sequence = cell.m_sequence.load(MemoryOrder::Acquire);
+				const int32_t diff = int32_t(sequence - (pos+1) );
+
+				if (0 == diff)
+				{
+					if (m_read.compareExchange(pos, pos+1, MemoryOrder::Relaxed) )
+					{
+						Ty* ptr = cell.m_ptr;
+						cell.m_sequence.store(pos+m_mask+1, MemoryOrder::Release);
+						return ptr;
+					}
+				}
+				else if (0 > diff)
+				{
+					return NULL;
+				}
+				else
+				{
+					pos = m_read.load(MemoryOrder::Relaxed);
+				}
+			}
+		}
+
+		uint32_t getCapacity() const
+		{
+			return m_mask+1;
+		}
+
+	private:
+		struct Cell
+		{
+			Atomic<uint32_t> m_sequence;
+			Ty* m_ptr;
+		};
+
+		// Producers and consumers contend on separate cache lines.
+		const uint32_t m_mask;
+		Cell* m_cell;
+		char m_pad[BX_CACHE_LINE_SIZE];
+		Atomic<uint32_t> m_write;
+		char m_padWrite[BX_CACHE_LINE_SIZE - sizeof(uint32_t)];
+		Atomic<uint32_t> m_read;
+		char m_padRead[BX_CACHE_LINE_SIZE - sizeof(uint32_t)];
+	};
+
+} // namespace bx
+
+#endif // __BX_MPMCQUEUE_H__
@@ -8,14 +8,28 @@
 
 #include "bx.h"
 #include "cpu.h"
+#include "os.h"
 #include "sem.h"
 
 #if BX_PLATFORM_NACL || BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID || BX_PLATFORM_OSX
 #	include <pthread.h>
+#	if BX_CONFIG_LWMUTEX_FUTEX
+#		include <unistd.h> // syscall
+#		include <sys/syscall.h>
+#		include <linux/futex.h>
+#	endif // BX_CONFIG_LWMUTEX_FUTEX
 #elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
 #	include <errno.h>
 #endif // BX_PLATFORM_
 
+#include <string.h> // memcpy
+
+#if BX_CONFIG_MUTEX_PROFILE
+#	include <stdio.h> // snprintf
+#	include "debug.h"
+#	include "timer.h"
+#endif // BX_CONFIG_MUTEX_PROFILE
+
 namespace bx
 {
 #if BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
@@ -52,36 +66,250 @@ namespace bx
 	}
 #endif // BX_PLATFORM_
 
+#if BX_CONFIG_MUTEX_PROFILE
+	class Mutex;
+
+	/// Per mutex lock contention statistics. Times are in getHPCounter ticks.
+	struct MutexProfile
+	{
+		const char* m_name;
+		uint64_t m_acquireCount;
+		uint64_t m_contendedCount;
+		int64_t m_waitTime;
+		int64_t m_maxWaitTime;
+		int64_t m_maxHoldTime;
+	};
+
+	struct MutexProfileRegistry
+	{
+		MutexProfileRegistry()
+			: m_first(NULL)
+		{
+			pthread_mutex_init(&m_lock, NULL);
+		}
+
+		~MutexProfileRegistry()
+		{
+			pthread_mutex_destroy(&m_lock);
+		}
+
+		pthread_mutex_t m_lock;
+		Mutex* m_first;
+	};
+
+	inline MutexProfileRegistry& getMutexProfileRegistry()
+	{
+		static MutexProfileRegistry s_registry;
+		return s_registry;
+	}
+#endif // BX_CONFIG_MUTEX_PROFILE
+
 	class Mutex
 	{
 	public:
-		Mutex()
+		explicit Mutex(const char* _name = NULL)
 		{
 			pthread_mutex_init(&m_handle, NULL);
+
+#if BX_CONFIG_MUTEX_PROFILE
+			memset(&m_profile, 0, sizeof(m_profile) );
+			m_profile.m_name = _name;
+			m_lockTime = 0;
+
+			MutexProfileRegistry& registry = getMutexProfileRegistry();
+			pthread_mutex_lock(&registry.m_lock);
+			m_prev = NULL;
+			m_next = registry.m_first;
+			if (NULL != m_next)
+			{
+				m_next->m_prev = this;
+			}
+			registry.m_first = this;
+			pthread_mutex_unlock(&registry.m_lock);
+#else
+			BX_UNUSED(_name);
+#endif // BX_CONFIG_MUTEX_PROFILE
 		}
 
 		~Mutex()
 		{
+#if BX_CONFIG_MUTEX_PROFILE
+			MutexProfileRegistry& registry = getMutexProfileRegistry();
+			pthread_mutex_lock(&registry.m_lock);
+			if (NULL != m_prev)
+			{
+				m_prev->m_next = m_next;
+			}
+			else
+			{
+				registry.m_first = m_next;
+			}
+
+			if (NULL != m_next)
+			{
+				m_next->m_prev = m_prev;
+			}
+			pthread_mutex_unlock(&registry.m_lock);
+#endif // BX_CONFIG_MUTEX_PROFILE
+
 			pthread_mutex_destroy(&m_handle);
 		}
 
 		void lock()
 		{
+#if BX_CONFIG_MUTEX_PROFILE
+			if (0 != pthread_mutex_trylock(&m_handle) )
+			{
+				const int64_t start = getHPCounter();
+				pthread_mutex_lock(&m_handle);
+				const int64_t wait = getHPCounter() - start;
+
+				// Stats are only modified while mutex is held.
+				++m_profile.m_contendedCount;
+				m_profile.m_waitTime += wait;
+				m_profile.m_maxWaitTime = wait > m_profile.m_maxWaitTime ? wait : m_profile.m_maxWaitTime;
+			}
+
+			++m_profile.m_acquireCount;
+			m_lockTime = getHPCounter();
+#else
 			pthread_mutex_lock(&m_handle);
+#endif // BX_CONFIG_MUTEX_PROFILE
+		}
+
+		bool tryLock()
+		{
+#if BX_CONFIG_MUTEX_PROFILE
+			if (0 == pthread_mutex_trylock(&m_handle) )
+			{
+				++m_profile.m_acquireCount;
+				m_lockTime = getHPCounter();
+				return true;
+			}
+
+			return false;
+#else
+			return 0 == pthread_mutex_trylock(&m_handle);
+#endif // BX_CONFIG_MUTEX_PROFILE
 		}
 
 		void unlock()
 		{
+#if BX_CONFIG_MUTEX_PROFILE
+			const int64_t hold = getHPCounter() - m_lockTime;
+			m_profile.m_maxHoldTime = hold > m_profile.m_maxHoldTime ? hold : m_profile.m_maxHoldTime;
+#endif // BX_CONFIG_MUTEX_PROFILE
+
 			pthread_mutex_unlock(&m_handle);
 		}
 
+#if BX_CONFIG_MUTEX_PROFILE
+		void setName(const char* _name)
+		{
+			m_profile.m_name = _name;
+		}
+
+		/// Statistics are updated without synchronization with reader, values
+		/// might be slightly stale.
+		const MutexProfile& getProfile() const
+		{
+			return m_profile;
+		}
+
+		void resetProfile()
+		{
+			const char* name = m_profile.m_name;
+			memset(&m_profile, 0, sizeof(m_profile) );
+			m_profile.m_name = name;
+		}
+#endif // BX_CONFIG_MUTEX_PROFILE
+
 	private:
 		Mutex(const Mutex& _rhs); // no copy constructor
 		Mutex& operator=(const Mutex& _rhs); // no assignment operator
 
 		pthread_mutex_t m_handle;
+
+#if BX_CONFIG_MUTEX_PROFILE
+		friend void mutexProfileEnum(void (*_fn)(const MutexProfile&, void*), void*);
+		friend void mutexProfileReset();
+
+		MutexProfile m_profile;
+		int64_t m_lockTime;
+		Mutex* m_prev;
+		Mutex* m_next;
+#endif // BX_CONFIG_MUTEX_PROFILE
 	};
 
+#if BX_CONFIG_MUTEX_PROFILE
+	typedef void (*MutexProfileFn)(const MutexProfile& _profile, void* _userData);
+
+	/// Calls _fn for every live Mutex.
+	inline void mutexProfileEnum(MutexProfileFn _fn, void* _userData)
+	{
+		MutexProfileRegistry& registry = getMutexProfileRegistry();
+		pthread_mutex_lock(&registry.m_lock);
+		for (Mutex* mutex = registry.m_first; NULL != mutex; mutex = mutex->m_next)
+		{
+			_fn(mutex->m_profile, _userData);
+		}
+		pthread_mutex_unlock(&registry.m_lock);
+	}
+
+	inline void mutexProfileReset()
+	{
+		MutexProfileRegistry& registry = getMutexProfileRegistry();
+		pthread_mutex_lock(&registry.m_lock);
+		for (Mutex* mutex = registry.m_first; NULL != mutex; mutex = mutex->m_next)
+		{
+			mutex->resetProfile();
+		}
+		pthread_mutex_unlock(&registry.m_lock);
+	}
+
+	inline void mutexProfileDumpFn(const MutexProfile& _profile, void* _userData)
+	{
+		if (0 == _profile.m_acquireCount)
+		{
+			return;
+		}
+
+		const double toUs = 1000000.0/double(*(int64_t*)_userData);
+
+		char temp[256];
+		snprintf(temp, sizeof(temp), "%-32s %12llu %12llu %6.2f%% %12.1f %12.1f %12.1f\n"
+			, NULL != _profile.m_name ? _profile.m_name : "<unnamed>"
+			, (unsigned long long)_profile.m_acquireCount
+			, (unsigned long long)_profile.m_contendedCount
+			, double(_profile.m_contendedCount)*100.0/double(_profile.m_acquireCount)
+			, double(_profile.m_waitTime)*toUs
+			, double(_profile.m_maxWaitTime)*toUs
+			, double(_profile.m_maxHoldTime)*toUs
+			);
+		debugOutput(temp);
+	}
+
+	/// Outputs statistics for all live mutexes that were acquired at least
+	/// once. Times are in microseconds.
+	inline void mutexProfileDump()
+	{
+		char temp[256];
+		snprintf(temp, sizeof(temp), "%-32s %12s %12s %7s %12s %12s %12s\n"
+			, "name"
+			, "acquire"
+			, "contended"
+			, "%"
+			, "wait [us]"
+			, "max wait"
+			, "max hold"
+			);
+		debugOutput(temp);
+
+		int64_t freq = getHPFrequency();
+		mutexProfileEnum(mutexProfileDumpFn, &freq);
+	}
+#endif // BX_CONFIG_MUTEX_PROFILE
+
 	class MutexScope
 	{
 	public:
@@ -104,7 +332,290 @@ namespace bx
 		Mutex& m_mutex;
 	};
 
-	typedef Mutex LwMutex;
+	/// Test-and-test-and-set spin lock with exponential backoff. Use only
+	/// for very short critical sections. Once backoff saturates waiting
+	/// thread yields its time slice, so that lock holder can make progress
+	/// when threads outnumber cores.
+	class SpinLock
+	{
+	public:
+		SpinLock()
+			: m_lock(0)
+		{
+		}
+
+		~SpinLock()
+		{
+		}
+
+		void lock()
+		{
+			uint32_t backoff = 1;
+			while (!tryLock() )
+			{
+				do
+				{
+					if (backoff < BX_CONFIG_SPINLOCK_MAX_BACKOFF)
+					{
+						for (uint32_t ii = 0; ii < backoff; ++ii)
+						{
+							cpuPause();
+						}
+
+						backoff <<= 1;
+					}
+					else
+					{
+						yield();
+					}
+
+				} while (0 != m_lock.load(MemoryOrder::Relaxed) );
+			}
+		}
+
+		bool tryLock()
+		{
+			int32_t expected = 0;
+			return 0 == m_lock.load(MemoryOrder::Relaxed)
+				&& m_lock.compareExchange(expected, 1, MemoryOrder::Acquire)
+				;
+		}
+
+		void unlock()
+		{
+			m_lock.store(0, MemoryOrder::Release);
+		}
+
+	private:
+		SpinLock(const SpinLock& _rhs); // no copy constructor
+		SpinLock& operator=(const SpinLock& _rhs); // no assignment operator
+
+		Atomic<int32_t> m_lock;
+	};
+
+	class SpinLockScope
+	{
+	public:
+		SpinLockScope(SpinLock& _lock)
+			: m_lock(_lock)
+		{
+			m_lock.lock();
+		}
+
+		~SpinLockScope()
+		{
+			m_lock.unlock();
+		}
+
+	private:
+		SpinLockScope(); // no default constructor
+		SpinLockScope(const SpinLockScope& _rhs); // no copy constructor
+		SpinLockScope& operator=(const SpinLockScope& _rhs); // no assignment operator
+
+		SpinLock& m_lock;
+	};
+
+	/// Fair spin lock, threads acquire lock in order of arrival.
+	class TicketLock
+	{
+	public:
+		TicketLock()
+			: m_next(0)
+			, m_serving(0)
+		{
+		}
+
+		~TicketLock()
+		{
+		}
+
+		void lock()
+		{
+			const int32_t ticket = m_next.fetchAdd(1, MemoryOrder::Relaxed);
+
+			uint32_t spin = 0;
+			for (int32_t serving = m_serving.load(MemoryOrder::Acquire); ticket != serving; serving = m_serving.load(MemoryOrder::Acquire) )
+			{
+				// Back off proportionally to number of threads ahead in line,
+				// and yield once total spin time exceeds backoff limit.
+				const uint32_t wait = uint32_t(ticket - serving)*32;
+				if (spin < BX_CONFIG_SPINLOCK_MAX_BACKOFF)
+				{
+					for (uint32_t ii = 0; ii < wait; ++ii)
+					{
+						cpuPause();
+					}
+
+					spin += wait;
+				}
+				else
+				{
+					yield();
+				}
+			}
+		}
+
+		void unlock()
+		{
+			// Only lock owner writes m_serving.
+			m_serving.store(m_serving.load(MemoryOrder::Relaxed) + 1, MemoryOrder::Release);
+		}
+
+	private:
+		TicketLock(const TicketLock& _rhs); // no copy constructor
+		TicketLock& operator=(const TicketLock& _rhs); // no assignment operator
+
+		Atomic<int32_t> m_next;
+		Atomic<int32_t> m_serving;
+	};
+
+	class TicketLockScope
+	{
+	public:
+		TicketLockScope(TicketLock& _lock)
+			: m_lock(_lock)
+		{
+			m_lock.lock();
+		}
+
+		~TicketLockScope()
+		{
+			m_lock.unlock();
+		}
+
+	private:
+		TicketLockScope(); // no default constructor
+		TicketLockScope(const TicketLockScope& _rhs); // no copy constructor
+		TicketLockScope& operator=(const TicketLockScope& _rhs); // no assignment operator
+
+		TicketLock& m_lock;
+	};
+
+#if BX_CONFIG_LWMUTEX_FUTEX
+	inline void futexWait(volatile int32_t* _addr, int32_t _value)
+	{
+		syscall(SYS_futex, _addr, FUTEX_WAIT_PRIVATE, _value, NULL, NULL, 0);
+	}
+
+	inline void futexWake(volatile int32_t* _addr, int32_t _count)
+	{
+		syscall(SYS_futex, _addr, FUTEX_WAKE_PRIVATE, _count, NULL, NULL, 0);
+	}
+
+	/// Adaptive lock, spins BX_CONFIG_LWMUTEX_SPIN_COUNT times before
+	/// sleeping on futex.
+	///
+	/// Futexes Are Tricky
+	/// http://www.akkadia.org/drepper/futex.pdf
+	class LwMutex
+	{
+	public:
+		LwMutex()
+			: m_state(Unlocked)
+		{
+		}
+
+		~LwMutex()
+		{
+		}
+
+		void lock()
+		{
+			for (uint32_t ii = 0; ii < BX_CONFIG_LWMUTEX_SPIN_COUNT; ++ii)
+			{
+				if (tryLock() )
+				{
+					return;
+				}
+
+				cpuPause();
+			}
+
+			// Mark lock as contended, so that unlock knows it has to wake
+			// sleeping threads.
+			int32_t state = m_state.exchange(Contended, MemoryOrder::Acquire);
+			while (Unlocked != state)
+			{
+				futexWait(m_state.getPtr(), Contended);
+				state = m_state.exchange(Contended, MemoryOrder::Acquire);
+			}
+		}
+
+		bool tryLock()
+		{
+			int32_t expected = Unlocked;
+			return Unlocked == m_state.load(MemoryOrder::Relaxed)
+				&& m_state.compareExchange(expected, Locked, MemoryOrder::Acquire)
+				;
+		}
+
+		void unlock()
+		{
+			if (Contended == m_state.exchange(Unlocked, MemoryOrder::Release) )
+			{
+				futexWake(m_state.getPtr(), 1);
+			}
+		}
+
+	private:
+		LwMutex(const LwMutex& _rhs); // no copy constructor
+		LwMutex& operator=(const LwMutex& _rhs); // no assignment operator
+
+		enum
+		{
+			Unlocked,
+			Locked,
+			Contended,
+		};
+
+		Atomic<int32_t> m_state;
+	};
+#else
+	/// Adaptive lock, spins BX_CONFIG_LWMUTEX_SPIN_COUNT times before
+	/// blocking on OS mutex.
+	class LwMutex
+	{
+	public:
+		LwMutex()
+		{
+		}
+
+		~LwMutex()
+		{
+		}
+
+		void lock()
+		{
+			for (uint32_t ii = 0; ii < BX_CONFIG_LWMUTEX_SPIN_COUNT; ++ii)
+			{
+				if (m_mutex.tryLock() )
+				{
+					return;
+				}
+
+				cpuPause();
+			}
+
+			m_mutex.lock();
+		}
+
+		bool tryLock()
+		{
+			return m_mutex.tryLock();
+		}
+
+		void unlock()
+		{
+			m_mutex.unlock();
+		}
+
+	private:
+		LwMutex(const LwMutex& _rhs); // no copy constructor
+		LwMutex& operator=(const LwMutex& _rhs); // no assignment operator
+
+		Mutex m_mutex;
+	};
+#endif // BX_CONFIG_LWMUTEX_FUTEX
 
 	class LwMutexScope
 	{
@@ -128,6 +639,212 @@ namespace bx
 		LwMutex& m_mutex;
 	};
 
+	/// Reader-writer lock. Multiple readers can hold lock at the same time,
+	/// writers get exclusive access. Where supported, waiting writers are
+	/// preferred over new readers to avoid writer starvation.
+	class RwMutex
+	{
+	public:
+		RwMutex()
+		{
+#if BX_PLATFORM_WINDOWS >= 0x0600
+			InitializeSRWLock(&m_handle);
+#elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
+#elif BX_PLATFORM_LINUX && defined(__GLIBC__)
+			pthread_rwlockattr_t attr;
+			pthread_rwlockattr_init(&attr);
+			pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+			pthread_rwlock_init(&m_handle, &attr);
+			pthread_rwlockattr_destroy(&attr);
+#else
+			pthread_rwlock_init(&m_handle, NULL);
+#endif // BX_PLATFORM_
+		}
+
+		~RwMutex()
+		{
+#if !(BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360)
+			pthread_rwlock_destroy(&m_handle);
+#endif // BX_PLATFORM_
+		}
+
+		void readLock()
+		{
+#if BX_PLATFORM_WINDOWS >= 0x0600
+			AcquireSRWLockShared(&m_handle);
+#elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
+			m_handle.lock();
+#else
+			pthread_rwlock_rdlock(&m_handle);
+#endif // BX_PLATFORM_
+		}
+
+		void readUnlock()
+		{
+#if BX_PLATFORM_WINDOWS >= 0x0600
+			ReleaseSRWLockShared(&m_handle);
+#elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
+			m_handle.unlock();
+#else
+			pthread_rwlock_unlock(&m_handle);
+#endif // BX_PLATFORM_
+		}
+
+		void writeLock()
+		{
+#if BX_PLATFORM_WINDOWS >= 0x0600
+			AcquireSRWLockExclusive(&m_handle);
+#elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
+			m_handle.lock();
+#else
+			pthread_rwlock_wrlock(&m_handle);
+#endif // BX_PLATFORM_
+		}
+
+		void writeUnlock()
+		{
+#if BX_PLATFORM_WINDOWS >= 0x0600
+			ReleaseSRWLockExclusive(&m_handle);
+#elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
+			m_handle.unlock();
+#else
+			pthread_rwlock_unlock(&m_handle);
+#endif // BX_PLATFORM_
+		}
+
+	private:
+		RwMutex(const RwMutex& _rhs); // no copy constructor
+		RwMutex& operator=(const RwMutex& _rhs); // no assignment operator
+
+#if BX_PLATFORM_WINDOWS >= 0x0600
+		SRWLOCK m_handle;
+#elif BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
+		// Pre-Vista Windows doesn't have SRW locks, readers serialize.
+		Mutex m_handle;
+#else
+		pthread_rwlock_t m_handle;
+#endif // BX_PLATFORM_
+	};
+
+	class RwMutexReadScope
+	{
+	public:
+		RwMutexReadScope(RwMutex& _mutex)
+			: m_mutex(_mutex)
+		{
+			m_mutex.readLock();
+		}
+
+		~RwMutexReadScope()
+		{
+			m_mutex.readUnlock();
+		}
+
+	private:
+		RwMutexReadScope(); // no default constructor
+		RwMutexReadScope(const RwMutexReadScope& _rhs); // no copy constructor
+		RwMutexReadScope& operator=(const RwMutexReadScope& _rhs); // no assignment operator
+
+		RwMutex& m_mutex;
+	};
+
+	class RwMutexWriteScope
+	{
+	public:
+		RwMutexWriteScope(RwMutex& _mutex)
+			: m_mutex(_mutex)
+		{
+			m_mutex.writeLock();
+		}
+
+		~RwMutexWriteScope()
+		{
+			m_mutex.writeUnlock();
+		}
+
+	private:
+		RwMutexWriteScope(); // no default constructor
+		RwMutexWriteScope(const RwMutexWriteScope& _rhs); // no copy constructor
+		RwMutexWriteScope& operator=(const RwMutexWriteScope& _rhs); // no assignment operator
+
+		RwMutex& m_mutex;
+	};
+
+	/// Sequence lock for small POD values that are read often and written
+	/// rarely. Readers never write shared memory, they retry copy if writer
+	/// was active while they were reading. Writers are serialized.
+	///
+	/// Ty must be POD type, it's copied with memcpy.
+	template <typename Ty>
+	class SeqLock
+	{
+	public:
+		SeqLock()
+			: m_seq(0)
+		{
+			memset(&m_data, 0, sizeof(Ty) );
+		}
+
+		SeqLock(const Ty& _value)
+			: m_seq(0)
+		{
+			memcpy(&m_data, &_value, sizeof(Ty) );
+		}
+
+		~SeqLock()
+		{
+		}
+
+		void write(const Ty& _value)
+		{
+			SpinLockScope lock(m_lock);
+
+			// Odd sequence number means write is in progress. Release fence
+			// keeps data stores from moving above odd sequence store.
+			const int32_t seq = m_seq.load(MemoryOrder::Relaxed);
+			m_seq.store(seq+1, MemoryOrder::Relaxed);
+			atomicFence(MemoryOrder::Release);
+
+			memcpy(&m_data, &_value, sizeof(Ty) );
+
+			m_seq.store(seq+2, MemoryOrder::Release);
+		}
+
+		Ty read() const
+		{
+			Ty result;
+			read(result);
+			return result;
+		}
+
+		void read(Ty& _result) const
+		{
+			int32_t seq;
+			do
+			{
+				for (seq = m_seq.load(MemoryOrder::Acquire); 0 != (seq&1); seq = m_seq.load(MemoryOrder::Acquire) )
+				{
+					cpuPause();
+				}
+
+				memcpy(&_result, &m_data, sizeof(Ty) );
+
+				// Acquire fence keeps data loads from moving below sequence
+				// recheck.
+				atomicFence(MemoryOrder::Acquire);
+
+			} while (seq != m_seq.load(MemoryOrder::Relaxed) );
+		}
+
+	private:
+		SeqLock(const SeqLock& _rhs); // no copy constructor
+		SeqLock& operator=(const SeqLock& _rhs); // no assignment operator
+
+		Atomic<int32_t> m_seq;
+		Ty m_data;
+		SpinLock m_lock;
+	};
+
 } // namespace bx
 
 #endif // __BX_MUTEX_H__
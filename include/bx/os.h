@@ -28,11 +28,25 @@
 #		include <sys/syscall.h>
 #	endif // BX_PLATFORM_LINUX
 
+#	if BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+#		include <stdio.h> // fopen, snprintf
+#		include <stdlib.h> // strtoul
+#		include <unistd.h> // sysconf
+#	elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+#		include <unistd.h> // sysconf
+#	endif // BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+
 #	if BX_PLATFORM_ANDROID
 #		include "debug.h" // getTid is not implemented...
 #	endif // BX_PLATFORM_ANDROID
 #endif // BX_PLATFORM_
 
+#include <string.h> // memset
+
+#ifndef BX_CONFIG_MAX_CPUS
+#	define BX_CONFIG_MAX_CPUS 256
+#endif // BX_CONFIG_MAX_CPUS
+
 namespace bx
 {
 	inline void sleep(uint32_t _ms)
@@ -63,6 +77,8 @@ namespace bx
 		return ::GetCurrentThreadId();
 #elif BX_PLATFORM_LINUX
 		return (pid_t)::syscall(SYS_gettid);
+#elif BX_PLATFORM_ANDROID
+		return (pid_t)::gettid();
 #elif BX_PLATFORM_IOS || BX_PLATFORM_OSX
 		return (mach_port_t)::pthread_mach_thread_np(pthread_self() );
 #elif BX_PLATFORM_NACL
@@ -125,6 +141,362 @@ namespace bx
 #endif // BX_PLATFORM_
 	}
 
+	/// Set of logical CPUs.
+	struct CpuMask
+	{
+		CpuMask()
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			memset(m_bits, 0, sizeof(m_bits) );
+		}
+
+		void set(uint32_t _cpu)
+		{
+			if (_cpu < BX_CONFIG_MAX_CPUS)
+			{
+				m_bits[_cpu/64] |= UINT64_C(1)<<(_cpu%64);
+			}
+		}
+
+		void unset(uint32_t _cpu)
+		{
+			if (_cpu < BX_CONFIG_MAX_CPUS)
+			{
+				m_bits[_cpu/64] &= ~(UINT64_C(1)<<(_cpu%64) );
+			}
+		}
+
+		bool isSet(uint32_t _cpu) const
+		{
+			return _cpu < BX_CONFIG_MAX_CPUS
+				&& 0 != (m_bits[_cpu/64] & (UINT64_C(1)<<(_cpu%64) ) )
+				;
+		}
+
+		uint32_t count() const
+		{
+			uint32_t result = 0;
+			for (uint32_t ii = 0; ii < BX_CONFIG_MAX_CPUS; ++ii)
+			{
+				result += isSet(ii);
+			}
+
+			return result;
+		}
+
+		/// Returns lowest CPU index in set, or BX_CONFIG_MAX_CPUS if set is
+		/// empty.
+		uint32_t first() const
+		{
+			for (uint32_t ii = 0; ii < BX_CONFIG_MAX_CPUS; ++ii)
+			{
+				if (isSet(ii) )
+				{
+					return ii;
+				}
+			}
+
+			return BX_CONFIG_MAX_CPUS;
+		}
+
+		uint64_t m_bits[(BX_CONFIG_MAX_CPUS+63)/64];
+	};
+
+	/// Parses Linux CPU list format ("0-3,8,10-11").
+	inline void cpuMaskFromList(CpuMask& _mask, const char* _list)
+	{
+		_mask.clear();
+
+		const char* ptr = _list;
+		while ('\0' != *ptr)
+		{
+			if (*ptr < '0' || *ptr > '9')
+			{
+				++ptr;
+				continue;
+			}
+
+			uint32_t first = 0;
+			for (; *ptr >= '0' && *ptr <= '9'; ++ptr)
+			{
+				first = first*10 + (*ptr-'0');
+			}
+
+			uint32_t last = first;
+			if ('-' == *ptr)
+			{
+				last = 0;
+				for (++ptr; *ptr >= '0' && *ptr <= '9'; ++ptr)
+				{
+					last = last*10 + (*ptr-'0');
+				}
+			}
+
+			for (uint32_t ii = first; ii <= last && ii < BX_CONFIG_MAX_CPUS; ++ii)
+			{
+				_mask.set(ii);
+			}
+		}
+	}
+
+	struct CpuInfo
+	{
+		uint32_t m_core;    //!< Physical core index, unique across packages.
+		uint32_t m_package; //!< Physical package (socket).
+		uint32_t m_node;    //!< NUMA node.
+		CpuMask m_smtSiblings; //!< Logical CPUs sharing physical core, including this one.
+		CpuMask m_cacheShared[3]; //!< Logical CPUs sharing L1/L2/L3 data cache.
+		uint32_t m_cacheSize[3]; //!< L1/L2/L3 data cache size in bytes, 0 if unknown.
+	};
+
+	/// CPU topology. Structure is large (one CpuInfo per possible logical
+	/// CPU), query it once and keep it around.
+	struct CpuTopology
+	{
+		uint32_t m_numLogical;
+		uint32_t m_numPhysical;
+		uint32_t m_numPackages;
+		uint32_t m_numNodes;
+		CpuMask m_online;
+		CpuInfo m_cpu[BX_CONFIG_MAX_CPUS];
+	};
+
+#if BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+	inline bool sysfsRead(const char* _path, char* _out, uint32_t _size)
+	{
+		FILE* file = fopen(_path, "rb");
+		if (NULL == file)
+		{
+			return false;
+		}
+
+		size_t size = fread(_out, 1, _size-1, file);
+		fclose(file);
+		_out[size] = '\0';
+
+		return 0 != size;
+	}
+
+	inline bool sysfsReadUint(const char* _path, uint32_t& _out)
+	{
+		char temp[64];
+		if (!sysfsRead(_path, temp, sizeof(temp) ) )
+		{
+			return false;
+		}
+
+		_out = (uint32_t)strtoul(temp, NULL, 10);
+		return true;
+	}
+#endif // BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+
+	/// Fills CPU topology. Where detailed topology is not available every
+	/// online logical CPU is reported as separate physical core.
+	inline void getCpuTopology(CpuTopology& _topology)
+	{
+		memset( (void*)&_topology, 0, sizeof(CpuTopology) );
+
+		bool detailed = false;
+
+#if BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+		char temp[1024];
+		char path[256];
+
+		if (sysfsRead("/sys/devices/system/cpu/online", temp, sizeof(temp) ) )
+		{
+			cpuMaskFromList(_topology.m_online, temp);
+			detailed = true;
+		}
+
+		for (uint32_t cpu = 0; cpu < BX_CONFIG_MAX_CPUS; ++cpu)
+		{
+			if (!_topology.m_online.isSet(cpu) )
+			{
+				continue;
+			}
+
+			CpuInfo& info = _topology.m_cpu[cpu];
+
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+			sysfsReadUint(path, info.m_package);
+
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+			if (sysfsRead(path, temp, sizeof(temp) ) )
+			{
+				cpuMaskFromList(info.m_smtSiblings, temp);
+			}
+			else
+			{
+				info.m_smtSiblings.set(cpu);
+			}
+
+			for (uint32_t index = 0; index < 16; ++index)
+			{
+				uint32_t level;
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, index);
+				if (!sysfsReadUint(path, level) )
+				{
+					break;
+				}
+
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/type", cpu, index);
+				if (1 > level
+				||  3 < level
+				||  !sysfsRead(path, temp, sizeof(temp) )
+				||  0 == strncmp(temp, "Instruction", 11) )
+				{
+					continue;
+				}
+
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/size", cpu, index);
+				if (sysfsRead(path, temp, sizeof(temp) ) )
+				{
+					char* end;
+					uint32_t size = (uint32_t)strtoul(temp, &end, 10);
+					info.m_cacheSize[level-1] = 'K' == *end ? size<<10 : 'M' == *end ? size<<20 : size;
+				}
+
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+				if (sysfsRead(path, temp, sizeof(temp) ) )
+				{
+					cpuMaskFromList(info.m_cacheShared[level-1], temp);
+				}
+			}
+		}
+
+		for (uint32_t node = 0; node < 64; ++node)
+		{
+			snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+			if (!sysfsRead(path, temp, sizeof(temp) ) )
+			{
+				continue;
+			}
+
+			CpuMask mask;
+			cpuMaskFromList(mask, temp);
+			for (uint32_t cpu = 0; cpu < BX_CONFIG_MAX_CPUS; ++cpu)
+			{
+				if (mask.isSet(cpu) )
+				{
+					_topology.m_cpu[cpu].m_node = node;
+				}
+			}
+
+			_topology.m_numNodes = node+1;
+		}
+#elif BX_PLATFORM_WINDOWS
+		SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+		DWORD size = sizeof(info);
+		if (GetLogicalProcessorInformation(info, &size) )
+		{
+			detailed = true;
+
+			for (DWORD ii = 0, num = size/sizeof(info[0]); ii < num; ++ii)
+			{
+				CpuMask mask;
+				mask.m_bits[0] = (uint64_t)info[ii].ProcessorMask;
+
+				for (uint32_t cpu = 0; cpu < 64; ++cpu)
+				{
+					if (!mask.isSet(cpu) )
+					{
+						continue;
+					}
+
+					CpuInfo& cpuInfo = _topology.m_cpu[cpu];
+
+					switch (info[ii].Relationship)
+					{
+					case RelationProcessorCore:
+						_topology.m_online.set(cpu);
+						cpuInfo.m_smtSiblings = mask;
+						break;
+
+					case RelationCache:
+						if (1 <= info[ii].Cache.Level
+						&&  3 >= info[ii].Cache.Level
+						&&  CacheInstruction != info[ii].Cache.Type)
+						{
+							cpuInfo.m_cacheShared[info[ii].Cache.Level-1] = mask;
+							cpuInfo.m_cacheSize[info[ii].Cache.Level-1] = info[ii].Cache.Size;
+						}
+						break;
+
+					case RelationNumaNode:
+						cpuInfo.m_node = info[ii].NumaNode.NodeNumber;
+						_topology.m_numNodes = uint32_t(cpuInfo.m_node+1) > _topology.m_numNodes ? cpuInfo.m_node+1 : _topology.m_numNodes;
+						break;
+
+					case RelationProcessorPackage:
+						cpuInfo.m_package = _topology.m_numPackages;
+						break;
+
+					default:
+						break;
+					}
+				}
+
+				if (RelationProcessorPackage == info[ii].Relationship)
+				{
+					++_topology.m_numPackages;
+				}
+			}
+		}
+#endif // BX_PLATFORM_
+
+		if (!detailed)
+		{
+			uint32_t numCpus = 1;
+#if BX_PLATFORM_WINDOWS
+			SYSTEM_INFO si;
+			GetSystemInfo(&si);
+			numCpus = si.dwNumberOfProcessors;
+#elif BX_PLATFORM_POSIX && !BX_PLATFORM_NACL
+			long result = sysconf(_SC_NPROCESSORS_ONLN);
+			numCpus = 0 < result ? uint32_t(result) : 1;
+#endif // BX_PLATFORM_
+
+			for (uint32_t cpu = 0; cpu < numCpus && cpu < BX_CONFIG_MAX_CPUS; ++cpu)
+			{
+				_topology.m_online.set(cpu);
+				_topology.m_cpu[cpu].m_smtSiblings.set(cpu);
+			}
+		}
+
+		// Number physical cores by first SMT sibling.
+		uint32_t maxPackage = 0;
+		for (uint32_t cpu = 0; cpu < BX_CONFIG_MAX_CPUS; ++cpu)
+		{
+			if (!_topology.m_online.isSet(cpu) )
+			{
+				continue;
+			}
+
+			CpuInfo& info = _topology.m_cpu[cpu];
+			const uint32_t first = info.m_smtSiblings.first();
+
+			if (first == cpu
+			||  !_topology.m_online.isSet(first) )
+			{
+				info.m_core = _topology.m_numPhysical++;
+			}
+			else
+			{
+				info.m_core = _topology.m_cpu[first].m_core;
+			}
+
+			maxPackage = info.m_package > maxPackage ? info.m_package : maxPackage;
+			++_topology.m_numLogical;
+		}
+
+		_topology.m_numPackages = maxPackage+1;
+		_topology.m_numNodes = 0 == _topology.m_numNodes ? 1 : _topology.m_numNodes;
+	}
+
 } // namespace bx
 
 #endif // __BX_OS_H__
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_PARALLEL_H__
+#define __BX_PARALLEL_H__
+
+#include "bx.h"
+#include "jobsystem.h"
+#include "uint32_t.h"
+
+#ifndef BX_CONFIG_PARALLEL_MAX_CHUNKS
+#	define BX_CONFIG_PARALLEL_MAX_CHUNKS 128
+#endif // BX_CONFIG_PARALLEL_MAX_CHUNKS
+
+namespace bx
+{
+	/// Returns grain size for range of _num elements. When _grain is 0 range
+	/// is split into roughly 8 chunks per thread.
+	inline uint32_t parallelGrain(JobSystem* _jobSystem, uint32_t _num, uint32_t _grain)
+	{
+		if (0 != _grain)
+		{
+			return _grain;
+		}
+
+		const uint32_t numThreads = NULL != _jobSystem ? _jobSystem->getNumThreads()+1 : 1;
+		return uint32_max(1, _num/(numThreads*8) );
+	}
+
+	/// Splits range in half until it's smaller than grain. Upper halves are
+	/// submitted as jobs, so idle workers steal big chunks of work first.
+	template <typename FnT>
+	struct ParallelForJob
+	{
+		static void run(void* _userData)
+		{
+			ParallelForJob* job = (ParallelForJob*)_userData;
+			job->execute();
+		}
+
+		void execute()
+		{
+			ParallelForJob child[32];
+			JobCounter counter;
+			uint32_t num = 0;
+
+			uint32_t end = m_end;
+			while (end - m_begin > m_grain)
+			{
+				const uint32_t mid = m_begin + (end - m_begin)/2;
+
+				ParallelForJob& half = child[num++];
+				half.m_jobSystem = m_jobSystem;
+				half.m_fn = m_fn;
+				half.m_begin = mid;
+				half.m_end = end;
+				half.m_grain = m_grain;
+				m_jobSystem->submit(run, &half, &counter);
+
+				end = mid;
+			}
+
+			(*m_fn)(m_begin, end);
+
+			if (0 != num)
+			{
+				m_jobSystem->wait(&counter);
+			}
+		}
+
+		JobSystem* m_jobSystem;
+		const FnT* m_fn;
+		uint32_t m_begin;
+		uint32_t m_end;
+		uint32_t m_grain;
+	};
+
+	/// Calls _fn(begin, end) for sub-ranges of [_begin, _end) in parallel.
+	/// Sub-ranges are not smaller than _grain, unless range is smaller than
+	/// _grain. If _grain is 0, it's selected based on number of threads.
+	/// Without job system loop runs serially on calling thread.
+	template <typename FnT>
+	inline void parallelFor(JobSystem* _jobSystem, uint32_t _begin, uint32_t _end, uint32_t _grain, const FnT& _fn)
+	{
+		if (_end <= _begin)
+		{
+			return;
+		}
+
+		const uint32_t grain = parallelGrain(_jobSystem, _end - _begin, _grain);
+
+		if (NULL == _jobSystem
+		||  _end - _begin <= grain)
+		{
+			_fn(_begin, _end);
+			return;
+		}
+
+		ParallelForJob<FnT> job;
+		job.m_jobSystem = _jobSystem;
+		job.m_fn = &_fn;
+		job.m_begin = _begin;
+		job.m_end = _end;
+		job.m_grain = grain;
+		job.execute();
+	}
+
+	/// Same as above, using job system set with setJobSystem.
+	template <typename FnT>
+	inline void parallelFor(uint32_t _begin, uint32_t _end, uint32_t _grain, const FnT& _fn)
+	{
+		parallelFor(getJobSystem(), _begin, _end, _grain, _fn);
+	}
+
+	template <typename Ty, typename FnT>
+	struct ParallelReduceChunkFn
+	{
+		void operator()(uint32_t _begin, uint32_t _end) const
+		{
+			for (uint32_t ii = _begin; ii < _end; ++ii)
+			{
+				const uint32_t begin = m_begin + ii*m_chunkSize;
+				const uint32_t end   = uint32_min(begin + m_chunkSize, m_end);
+				m_partial[ii].m_value = (*m_fn)(begin, end);
+			}
+		}
+
+		CacheLinePadded<Ty>* m_partial;
+		const FnT* m_fn;
+		uint32_t m_begin;
+		uint32_t m_end;
+		uint32_t m_chunkSize;
+	};
+
+	/// Calls Ty _fn(begin, end) for sub-ranges of [_begin, _end) in parallel,
+	/// and combines partial results with Ty _reduce(Ty, Ty). Partial results
+	/// are combined in order, so _reduce needs to be associative, but not
+	/// commutative, and result is deterministic for given range and grain.
+	/// _identity must be identity element of _reduce, it's returned for
+	/// empty range.
+	template <typename Ty, typename FnT, typename ReduceT>
+	inline Ty parallelReduce(JobSystem* _jobSystem, uint32_t _begin, uint32_t _end, uint32_t _grain, const Ty& _identity, const FnT& _fn, const ReduceT& _reduce)
+	{
+		if (_end <= _begin)
+		{
+			return _identity;
+		}
+
+		const uint32_t num   = _end - _begin;
+		const uint32_t grain = parallelGrain(_jobSystem, num, _grain);
+
+		if (NULL == _jobSystem
+		||  num <= grain)
+		{
+			return _fn(_begin, _end);
+		}
+
+		const uint32_t maxChunks = uint32_min( (num + grain - 1)/grain, BX_CONFIG_PARALLEL_MAX_CHUNKS);
+		const uint32_t chunkSize = (num + maxChunks - 1)/maxChunks;
+		const uint32_t numChunks = (num + chunkSize - 1)/chunkSize;
+
+		// Partial results are padded to cache line, so that threads writing
+		// neighbouring results don't invalidate each other's cache lines.
+		CacheLinePadded<Ty> partial[BX_CONFIG_PARALLEL_MAX_CHUNKS];
+
+		ParallelReduceChunkFn<Ty, FnT> chunkFn;
+		chunkFn.m_partial = partial;
+		chunkFn.m_fn = &_fn;
+		chunkFn.m_begin = _begin;
+		chunkFn.m_end = _end;
+		chunkFn.m_chunkSize = chunkSize;
+		parallelFor(_jobSystem, 0, numChunks, 1, chunkFn);
+
+		Ty result = _identity;
+		for (uint32_t ii = 0; ii < numChunks; ++ii)
+		{
+			result = _reduce(result, partial[ii].m_value);
+		}
+
+		return result;
+	}
+
+	/// Same as above, using job system set with setJobSystem.
+	template <typename Ty, typename FnT, typename ReduceT>
+	inline Ty parallelReduce(uint32_t _begin, uint32_t _end, uint32_t _grain, const Ty& _identity, const FnT& _fn, const ReduceT& _reduce)
+	{
+		return parallelReduce(getJobSystem(), _begin, _end, _grain, _identity, _fn, _reduce);
+	}
+
+} // namespace bx
+
+#endif // __BX_PARALLEL_H__
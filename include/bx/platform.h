@@ -108,6 +108,10 @@
 #	define BX_CACHE_LINE_SIZE 64
 #endif // 
 
+#ifndef BX_CACHE_LINE_SIZE
+#	define BX_CACHE_LINE_SIZE 64
+#endif // BX_CACHE_LINE_SIZE
+
 #if defined(__x86_64__) || defined(_M_X64) || defined(__64BIT__) || defined(__powerpc64__) || defined(__ppc64__)
 #	undef BX_ARCH_64BIT
 #	define BX_ARCH_64BIT 1
@@ -0,0 +1,459 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_PROFILER_H__
+#define __BX_PROFILER_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "mutex.h"
+#include "os.h"
+#include "thread.h"
+#include "timer.h"
+#include "uint32_t.h"
+
+/// Enables BX_PROFILE_SCOPE instrumentation. When disabled macros compile
+/// to nothing.
+#ifndef BX_CONFIG_PROFILER
+#	define BX_CONFIG_PROFILER 0
+#endif // BX_CONFIG_PROFILER
+
+/// Number of events in per-thread buffer, must be power of two. Events
+/// are dropped when collector doesn't keep up.
+#ifndef BX_CONFIG_PROFILER_BUFFER_SIZE
+#	define BX_CONFIG_PROFILER_BUFFER_SIZE 4096
+#endif // BX_CONFIG_PROFILER_BUFFER_SIZE
+
+#if BX_CONFIG_PROFILER
+/// Profiles enclosing scope. _name must be string literal, or otherwise
+/// outlive profiler.
+#	define BX_PROFILE_SCOPE(_name) bx::ProfileScope BX_CONCATENATE(bxProfileScope, __LINE__)(_name)
+#	define BX_PROFILE_BEGIN(_name) bx::profileBegin(_name)
+#	define BX_PROFILE_END(_name) bx::profileEnd(_name)
+#	define BX_PROFILE_COUNTER(_name, _value) bx::profileCounter(_name, _value)
+#	define BX_PROFILE_THREAD_NAME(_name) bx::profileThreadName(_name)
+#else
+#	define BX_PROFILE_SCOPE(_name) do {} while (0)
+#	define BX_PROFILE_BEGIN(_name) do {} while (0)
+#	define BX_PROFILE_END(_name) do {} while (0)
+#	define BX_PROFILE_COUNTER(_name, _value) do {} while (0)
+#	define BX_PROFILE_THREAD_NAME(_name) do {} while (0)
+#endif // BX_CONFIG_PROFILER
+
+namespace bx
+{
+	struct ProfilerEventType
+	{
+		enum Enum
+		{
+			Begin,
+			End,
+			Counter,    //!< m_value is counter value.
+			FlowBegin,  //!< m_value is flow id, binds to enclosing scope.
+			FlowEnd,    //!< m_value is flow id, binds to enclosing scope.
+			ThreadName, //!< m_name is name of emitting thread.
+		};
+	};
+
+	struct ProfilerEvent
+	{
+		int64_t m_time; //!< getHPCounter ticks.
+		const char* m_name;
+		uint64_t m_value;
+		uint32_t m_type; //!< ProfilerEventType::Enum
+	};
+
+	/// Receives events drained from thread buffers, called from collector
+	/// thread. Events of one thread are delivered in order.
+	struct BX_NO_VTABLE ProfilerCallbackI
+	{
+		virtual ~ProfilerCallbackI() = 0;
+		virtual void events(uint32_t _tid, const ProfilerEvent* _events, uint32_t _num) = 0;
+	};
+
+	inline ProfilerCallbackI::~ProfilerCallbackI()
+	{
+	}
+
+	/// Single producer, single consumer event buffer. Owner thread writes
+	/// events, collector reads them.
+	class ProfilerThreadBuffer
+	{
+		BX_CLASS(ProfilerThreadBuffer
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+		BX_STATIC_ASSERT(0 == (BX_CONFIG_PROFILER_BUFFER_SIZE & (BX_CONFIG_PROFILER_BUFFER_SIZE-1) ), "BX_CONFIG_PROFILER_BUFFER_SIZE must be power of two.");
+
+	public:
+		ProfilerThreadBuffer(uint32_t _tid)
+			: m_next(NULL)
+			, m_readCache(0)
+			, m_tid(_tid)
+			, m_flowSeq(0)
+		{
+			BX_WARN_FALSE_SHARING(m_write, m_read);
+			BX_WARN_FALSE_SHARING(m_flowSeq, m_read);
+			BX_WARN_FALSE_SHARING(m_event[0], m_read);
+		}
+
+		void push(const char* _name, ProfilerEventType::Enum _type, uint64_t _value = 0) // owner only
+		{
+			const int64_t now = getHPCounter();
+			const uint32_t write = m_write.load(MemoryOrder::Relaxed);
+
+			// Collector's read position is reloaded only when buffer looks
+			// full, to avoid touching its cache line on every event.
+			if (write - m_readCache >= BX_CONFIG_PROFILER_BUFFER_SIZE)
+			{
+				m_readCache = m_read.load(MemoryOrder::Acquire);
+				if (write - m_readCache >= BX_CONFIG_PROFILER_BUFFER_SIZE)
+				{
+					m_dropped.store(m_dropped.load(MemoryOrder::Relaxed) + 1, MemoryOrder::Relaxed);
+					return;
+				}
+			}
+
+			ProfilerEvent& event = m_event[write & (BX_CONFIG_PROFILER_BUFFER_SIZE-1)];
+			event.m_time = now;
+			event.m_name = _name;
+			event.m_value = _value;
+			event.m_type = _type;
+			m_write.store(write + 1, MemoryOrder::Release);
+		}
+
+		/// Passes buffered events to _callback, returns number of events.
+		uint32_t drain(ProfilerCallbackI* _callback) // collector only
+		{
+			const uint32_t read  = m_read.load(MemoryOrder::Relaxed);
+			const uint32_t write = m_write.load(MemoryOrder::Acquire);
+			const uint32_t num   = write - read;
+
+			if (0 != num)
+			{
+				const uint32_t first = read & (BX_CONFIG_PROFILER_BUFFER_SIZE-1);
+				const uint32_t num0  = uint32_min(num, BX_CONFIG_PROFILER_BUFFER_SIZE - first);
+				_callback->events(m_tid, &m_event[first], num0);
+
+				if (num0 < num)
+				{
+					_callback->events(m_tid, &m_event[0], num - num0);
+				}
+
+				// Events must be consumed before owner can overwrite them.
+				m_read.store(write, MemoryOrder::Release);
+			}
+
+			return num;
+		}
+
+		uint32_t getTid() const
+		{
+			return m_tid;
+		}
+
+		uint32_t getNumDropped() const
+		{
+			return m_dropped.load(MemoryOrder::Relaxed);
+		}
+
+		/// Returns flow id unique across threads. Never returns 0.
+		uint64_t nextFlowId() // owner only
+		{
+			++m_flowSeq;
+			return (uint64_t(m_tid)<<32) | m_flowSeq;
+		}
+
+		ProfilerThreadBuffer* m_next;
+
+	private:
+		// Owner line.
+		Atomic<uint32_t> m_write;
+		Atomic<uint32_t> m_dropped;
+		uint32_t m_readCache;
+		uint32_t m_tid;
+		uint32_t m_flowSeq;
+
+		// Collector line. Buffers are heap allocated without cache line
+		// alignment, full line of padding on both sides keeps m_read off
+		// owner's fields and events.
+		char m_pad[BX_CACHE_LINE_SIZE];
+		Atomic<uint32_t> m_read;
+		char m_padRead[BX_CACHE_LINE_SIZE];
+
+		ProfilerEvent m_event[BX_CONFIG_PROFILER_BUFFER_SIZE];
+	};
+
+	/// Collects profiler events from all threads. Every thread that emits
+	/// events gets its own buffer on first event, buffers are kept until
+	/// shutdown. Instrumented threads must not emit events during shutdown.
+	class Profiler
+	{
+		BX_CLASS(Profiler
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		Profiler()
+			: m_callback(NULL)
+			, m_tls(NULL)
+			, m_intervalMs(0)
+			, m_exit(0)
+		{
+		}
+
+		~Profiler()
+		{
+			if (NULL != m_callback)
+			{
+				shutdown();
+			}
+		}
+
+		/// Starts collector thread which drains buffers every _intervalMs
+		/// milliseconds. If _intervalMs is 0 no thread is started, and
+		/// events are drained only by calling collect.
+		void init(ProfilerCallbackI* _callback, uint32_t _intervalMs = 10)
+		{
+			BX_CHECK(NULL == m_callback, "Already initialized!");
+			BX_CHECK(NULL != _callback, "Callback must be set.");
+
+			// TLS key is recreated on every init, so that threads don't
+			// keep buffers of previous session.
+			m_tls = new TlsData;
+			m_callback = _callback;
+			m_intervalMs = _intervalMs;
+			m_exit.store(0, MemoryOrder::Relaxed);
+
+			if (0 != m_intervalMs)
+			{
+				m_thread.init(collectorFunc, this, 0, "bx profiler");
+			}
+		}
+
+		/// Stops collector thread, drains remaining events and frees
+		/// buffers.
+		void shutdown()
+		{
+			BX_CHECK(NULL != m_callback, "Not initialized!");
+
+			if (m_thread.isRunning() )
+			{
+				m_exit.store(1, MemoryOrder::Release);
+				m_thread.shutdown();
+			}
+
+			collect();
+
+			ProfilerThreadBuffer* buffer = m_head.exchange(NULL, MemoryOrder::Acquire);
+			while (NULL != buffer)
+			{
+				ProfilerThreadBuffer* next = buffer->m_next;
+				delete buffer;
+				buffer = next;
+			}
+
+			delete m_tls;
+			m_tls = NULL;
+			m_callback = NULL;
+		}
+
+		/// Returns calling thread's buffer, allocating it on first call.
+		/// Returns NULL if profiler is not initialized.
+		ProfilerThreadBuffer* getThreadBuffer()
+		{
+			if (NULL == m_tls)
+			{
+				return NULL;
+			}
+
+			ProfilerThreadBuffer* buffer = (ProfilerThreadBuffer*)m_tls->get();
+			if (NULL == buffer)
+			{
+				buffer = new ProfilerThreadBuffer(getTid() );
+				m_tls->set(buffer);
+
+				ProfilerThreadBuffer* head = m_head.load(MemoryOrder::Relaxed);
+				do
+				{
+					buffer->m_next = head;
+				} while (!m_head.compareExchange(head, buffer, MemoryOrder::Release) );
+			}
+
+			return buffer;
+		}
+
+		/// Drains all thread buffers to callback. Returns number of events.
+		uint32_t collect()
+		{
+			MutexScope lock(m_collectLock);
+
+			uint32_t num = 0;
+			for (ProfilerThreadBuffer* buffer = m_head.load(MemoryOrder::Acquire); NULL != buffer; buffer = buffer->m_next)
+			{
+				num += buffer->drain(m_callback);
+			}
+
+			return num;
+		}
+
+		/// Number of events dropped because buffers were full.
+		uint32_t getNumDropped() const
+		{
+			uint32_t num = 0;
+			for (const ProfilerThreadBuffer* buffer = m_head.load(MemoryOrder::Acquire); NULL != buffer; buffer = buffer->m_next)
+			{
+				num += buffer->getNumDropped();
+			}
+
+			return num;
+		}
+
+	private:
+		static int32_t collectorFunc(void* _userData)
+		{
+			Profiler* profiler = (Profiler*)_userData;
+
+			while (0 == profiler->m_exit.load(MemoryOrder::Acquire) )
+			{
+				profiler->collect();
+				sleep(profiler->m_intervalMs);
+			}
+
+			return 0;
+		}
+
+		ProfilerCallbackI* m_callback;
+		TlsData* m_tls;
+		Atomic<ProfilerThreadBuffer*> m_head;
+		Mutex m_collectLock;
+		Thread m_thread;
+		uint32_t m_intervalMs;
+		Atomic<uint32_t> m_exit;
+	};
+
+	inline Profiler*& profilerInstance()
+	{
+		static Profiler* s_profiler = NULL;
+		return s_profiler;
+	}
+
+	/// Sets profiler used by BX_PROFILE_* macros. Pass NULL to unset.
+	inline void setProfiler(Profiler* _profiler)
+	{
+		profilerInstance() = _profiler;
+	}
+
+	inline Profiler* getProfiler()
+	{
+		return profilerInstance();
+	}
+
+	/// Returns calling thread's buffer of profiler set with setProfiler,
+	/// or NULL if there is no profiler.
+	inline ProfilerThreadBuffer* profileThreadBuffer()
+	{
+		Profiler* profiler = getProfiler();
+		return NULL != profiler ? profiler->getThreadBuffer() : NULL;
+	}
+
+	inline void profileEvent(const char* _name, ProfilerEventType::Enum _type, uint64_t _value = 0)
+	{
+		ProfilerThreadBuffer* buffer = profileThreadBuffer();
+		if (NULL != buffer)
+		{
+			buffer->push(_name, _type, _value);
+		}
+	}
+
+	inline void profileBegin(const char* _name)
+	{
+		profileEvent(_name, ProfilerEventType::Begin);
+	}
+
+	inline void profileEnd(const char* _name)
+	{
+		profileEvent(_name, ProfilerEventType::End);
+	}
+
+	inline void profileCounter(const char* _name, int64_t _value)
+	{
+		profileEvent(_name, ProfilerEventType::Counter, uint64_t(_value) );
+	}
+
+	/// Names calling thread in captures. _name must outlive profiler.
+	inline void profileThreadName(const char* _name)
+	{
+		profileEvent(_name, ProfilerEventType::ThreadName);
+	}
+
+	/// Emits _name scope with flow start, returns flow id to be passed to
+	/// profileFlowEnd where flow continues. Returns 0 if there is no
+	/// profiler.
+	inline uint64_t profileFlowBegin(const char* _name)
+	{
+		ProfilerThreadBuffer* buffer = profileThreadBuffer();
+		if (NULL == buffer)
+		{
+			return 0;
+		}
+
+		const uint64_t id = buffer->nextFlowId();
+		buffer->push(_name, ProfilerEventType::Begin);
+		buffer->push(_name, ProfilerEventType::FlowBegin, id);
+		buffer->push(_name, ProfilerEventType::End);
+		return id;
+	}
+
+	/// Ends flow started by profileFlowBegin, binds to enclosing scope.
+	inline void profileFlowEnd(const char* _name, uint64_t _id)
+	{
+		if (0 != _id)
+		{
+			profileEvent(_name, ProfilerEventType::FlowEnd, _id);
+		}
+	}
+
+	class ProfileScope
+	{
+		BX_CLASS(ProfileScope
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		ProfileScope(const char* _name)
+			: m_buffer(NULL)
+			, m_name(_name)
+		{
+			Profiler* profiler = getProfiler();
+			if (NULL != profiler)
+			{
+				m_buffer = profiler->getThreadBuffer();
+				if (NULL != m_buffer)
+				{
+					m_buffer->push(_name, ProfilerEventType::Begin);
+				}
+			}
+		}
+
+		~ProfileScope()
+		{
+			if (NULL != m_buffer)
+			{
+				m_buffer->push(m_name, ProfilerEventType::End);
+			}
+		}
+
+	private:
+		ProfilerThreadBuffer* m_buffer;
+		const char* m_name;
+	};
+
+} // namespace bx
+
+#endif // __BX_PROFILER_H__
@@ -10,8 +10,36 @@
 #include <string.h>
 
 #include "bx.h"
+#include "allocator.h"
+#include "endian.h"
+#include "hash.h"
 #include "uint32_t.h"
 
+#if BX_CONFIG_MMAP_FILE_READER || BX_CONFIG_FD_FILE_READER_WRITER
+#	if BX_PLATFORM_WINDOWS
+#		include <windows.h>
+#	else
+#		include <errno.h>    // errno
+#		include <fcntl.h>    // open, posix_fadvise, sync_file_range
+#		include <sys/mman.h> // mmap, madvise
+#		include <sys/stat.h> // fstat
+#		include <sys/uio.h>  // pwritev
+#		include <unistd.h>   // close, pread, pwrite
+#	endif // BX_PLATFORM_WINDOWS
+#endif // BX_CONFIG_MMAP_FILE_READER || BX_CONFIG_FD_FILE_READER_WRITER
+
+/// Alignment of buffer address, size and file offset required for
+/// FdFlags::Direct I/O. Logical block size of most devices is 512 or 4096.
+#ifndef BX_CONFIG_FD_DIRECT_ALIGNMENT
+#	define BX_CONFIG_FD_DIRECT_ALIGNMENT 4096
+#endif // BX_CONFIG_FD_DIRECT_ALIGNMENT
+
+/// Amount of streamed data FdFlags::NoCache lets accumulate in page
+/// cache before it's written back and dropped.
+#ifndef BX_CONFIG_FD_NOCACHE_WINDOW
+#	define BX_CONFIG_FD_NOCACHE_WINDOW (8<<20)
+#endif // BX_CONFIG_FD_NOCACHE_WINDOW
+
 #if BX_COMPILER_MSVC
 #	define fseeko64 _fseeki64
 #	define ftello64 _ftelli64
@@ -42,16 +70,56 @@ namespace bx
 	{
 	}
 
+	/// Buffer for gathered write.
+	struct IoVec
+	{
+		const void* m_data;
+		int32_t m_size;
+	};
+
+	inline int32_t ioVecSize(const IoVec* _iov, uint32_t _num)
+	{
+		int32_t size = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			size += _iov[ii].m_size;
+		}
+
+		return size;
+	}
+
 	struct BX_NO_VTABLE WriterI
 	{
 		virtual ~WriterI() = 0;
 		virtual int32_t write(const void* _data, int32_t _size) = 0;
+
+		/// Writes _num buffers as one contiguous block. Default
+		/// implementation calls write for each buffer, writers that can
+		/// gather in single call override it.
+		virtual int32_t writev(const IoVec* _iov, uint32_t _num);
 	};
 
 	inline WriterI::~WriterI()
 	{
 	}
 
+	inline int32_t WriterI::writev(const IoVec* _iov, uint32_t _num)
+	{
+		int32_t total = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const int32_t result = write(_iov[ii].m_data, _iov[ii].m_size);
+			total += 0 < result ? result : 0;
+
+			if (result != _iov[ii].m_size)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
 	struct BX_NO_VTABLE SeekerI
 	{
 		virtual ~SeekerI() = 0;
@@ -86,6 +154,27 @@ namespace bx
 		return result;
 	}
 
+	/// Read array and convert it to host endianess in place.
+	template<typename Ty>
+	inline int32_t readHE(ReaderI* _reader, Ty* _data, uint32_t _num, bool _fromLittleEndian)
+	{
+		const int32_t result = _reader->read(_data, int32_t(_num*sizeof(Ty) ) );
+
+#if BX_CPU_ENDIAN_LITTLE
+		const bool swap = !_fromLittleEndian;
+#else
+		const bool swap = _fromLittleEndian;
+#endif // BX_CPU_ENDIAN_LITTLE
+
+		if (swap
+		&&  0 < result)
+		{
+			endianSwapArray(_data, _data, uint32_t(result)/sizeof(Ty) );
+		}
+
+		return result;
+	}
+
 	/// Write data.
 	inline int32_t write(WriterI* _writer, const void* _data, int32_t _size)
 	{
@@ -99,6 +188,12 @@ namespace bx
 		return _writer->write(&_value, sizeof(Ty) );
 	}
 
+	/// Write gathered data.
+	inline int32_t writev(WriterI* _writer, const IoVec* _iov, uint32_t _num)
+	{
+		return _writer->writev(_iov, _num);
+	}
+
 	/// Write value as little endian.
 	template<typename Ty>
 	inline int32_t writeLE(WriterI* _writer, const Ty& _value)
@@ -117,6 +212,53 @@ namespace bx
 		return result;
 	}
 
+	/// Write array with swapped byte order, swapped in chunks on stack.
+	template<typename Ty>
+	inline int32_t writeEndianSwapped(WriterI* _writer, const Ty* _data, uint32_t _num)
+	{
+		Ty temp[4096/sizeof(Ty)];
+
+		int32_t total = 0;
+		for (uint32_t ii = 0; ii < _num; ii += BX_COUNTOF(temp) )
+		{
+			const uint32_t num = uint32_min(BX_COUNTOF(temp), _num-ii);
+			endianSwapArray(temp, &_data[ii], num);
+
+			const int32_t size = int32_t(num*sizeof(Ty) );
+			const int32_t result = _writer->write(temp, size);
+			total += 0 < result ? result : 0;
+
+			if (result != size)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
+	/// Write array as little endian.
+	template<typename Ty>
+	inline int32_t writeLE(WriterI* _writer, const Ty* _data, uint32_t _num)
+	{
+#if BX_CPU_ENDIAN_BIG
+		return writeEndianSwapped(_writer, _data, _num);
+#else
+		return _writer->write(_data, int32_t(_num*sizeof(Ty) ) );
+#endif // BX_CPU_ENDIAN_BIG
+	}
+
+	/// Write array as big endian.
+	template<typename Ty>
+	inline int32_t writeBE(WriterI* _writer, const Ty* _data, uint32_t _num)
+	{
+#if BX_CPU_ENDIAN_LITTLE
+		return writeEndianSwapped(_writer, _data, _num);
+#else
+		return _writer->write(_data, int32_t(_num*sizeof(Ty) ) );
+#endif // BX_CPU_ENDIAN_LITTLE
+	}
+
 	inline int64_t skip(SeekerI* _seeker, int64_t _offset)
 	{
 		return _seeker->seek(_offset, Whence::Current);
@@ -204,6 +346,86 @@ namespace bx
 		uint32_t m_size;
 	};
 
+	/// Heap memory block. Grows by at least half of its size, so that
+	/// writing N bytes in small pieces takes O(log N) reallocs.
+	class MemoryBlock : public MemoryBlockI
+	{
+		BX_CLASS(MemoryBlock
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		MemoryBlock(ReallocatorI* _allocator, uint32_t _reserve = 0)
+			: m_allocator(_allocator)
+			, m_data(NULL)
+			, m_size(0)
+		{
+			reserve(_reserve);
+		}
+
+		virtual ~MemoryBlock()
+		{
+			if (NULL != m_data)
+			{
+				BX_FREE(m_allocator, m_data);
+			}
+		}
+
+		virtual void* more(uint32_t _size = 0) BX_OVERRIDE
+		{
+			if (0 < _size)
+			{
+				const uint64_t grow = uint64_max(_size, m_size/2);
+				const uint64_t size = BX_ALIGN_MASK(m_size + grow, UINT64_C(0xfff) );
+				BX_CHECK(UINT32_MAX >= size, "Memory block can't grow beyond 4GB.");
+				resize(uint32_t(uint64_min(size, UINT32_MAX) ) );
+			}
+
+			return m_data;
+		}
+
+		virtual uint32_t getSize() BX_OVERRIDE
+		{
+			return m_size;
+		}
+
+		/// Grows block to at least _size bytes.
+		void reserve(uint32_t _size)
+		{
+			if (_size > m_size)
+			{
+				resize(_size);
+			}
+		}
+
+		void* getData() const
+		{
+			return m_data;
+		}
+
+		/// Hands off ownership of data to caller, data must be freed with
+		/// block's allocator. Block is empty after release.
+		void* release()
+		{
+			void* data = m_data;
+			m_data = NULL;
+			m_size = 0;
+			return data;
+		}
+
+	private:
+		void resize(uint32_t _size)
+		{
+			m_data = BX_REALLOC(m_allocator, m_data, _size);
+			m_size = _size;
+		}
+
+		ReallocatorI* m_allocator;
+		void* m_data;
+		uint32_t m_size;
+	};
+
 	inline int64_t int64_min(int64_t _a, int64_t _b)
 	{
 		return _a < _b ? _a : _b;
@@ -270,6 +492,11 @@ namespace bx
 			return size;
 		}
 
+		virtual int32_t writev(const IoVec* _iov, uint32_t _num) BX_OVERRIDE
+		{
+			return write(NULL, ioVecSize(_iov, _num) );
+		}
+
 	private:
 		int64_t m_pos;
 		int64_t m_top;
@@ -377,13 +604,9 @@ namespace bx
 
 		virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
 		{
-			int32_t morecore = int32_t(m_pos - m_size) + _size;
-
-			if (0 < morecore)
+			if (m_pos + _size > m_size)
 			{
-				morecore = BX_ALIGN_MASK(morecore, 0xfff);
-				m_data = (uint8_t*)m_memBlock->more(morecore);
-				m_size = m_memBlock->getSize();
+				grow(_size);
 			}
 
 			int64_t reminder = m_size-m_pos;
@@ -394,7 +617,44 @@ namespace bx
 			return size;
 		}
 
+		virtual int32_t writev(const IoVec* _iov, uint32_t _num) BX_OVERRIDE
+		{
+			// Grow once for all buffers.
+			const int32_t total = ioVecSize(_iov, _num);
+			if (m_pos + total > m_size)
+			{
+				grow(total);
+			}
+
+			const int64_t start = m_pos;
+			for (uint32_t ii = 0; ii < _num && m_pos < m_size; ++ii)
+			{
+				int64_t reminder = m_size-m_pos;
+				int32_t size = uint32_min(_iov[ii].m_size, int32_t(reminder > INT32_MAX ? INT32_MAX : reminder) );
+				memcpy(&m_data[m_pos], _iov[ii].m_data, size);
+				m_pos += size;
+			}
+
+			m_top = int64_max(m_top, m_pos);
+			return int32_t(m_pos - start);
+		}
+
 	private:
+		void grow(int32_t _size)
+		{
+			// Block might already have room, it's not known before first
+			// write, or if it was reserved after writer was created.
+			m_data = (uint8_t*)m_memBlock->more();
+			m_size = m_memBlock->getSize();
+
+			const int64_t morecore = m_pos + _size - m_size;
+			if (0 < morecore)
+			{
+				m_data = (uint8_t*)m_memBlock->more(uint32_t(morecore) );
+				m_size = m_memBlock->getSize();
+			}
+		}
+
 		MemoryBlockI* m_memBlock;
 		uint8_t* m_data;
 		int64_t m_pos;
@@ -419,93 +679,1211 @@ namespace bx
 		StaticMemoryBlock m_smb;
 	};
 
-#if BX_CONFIG_CRT_FILE_READER_WRITER
-	class CrtFileReader : public FileReaderI
+	/// Accumulates writes in internal buffer and forwards them to
+	/// underlying writer only when buffer is full, or on flush. Typed
+	/// writes called directly on BufferedWriter are inlined and don't go
+	/// through virtual call.
+	///
+	/// Write returns number of bytes accepted, which is less than size
+	/// when underlying writer fails. Destructor can't report errors, call
+	/// flush before destroying writer to check that all data was written.
+	class BufferedWriter : public WriterI
 	{
+		BX_CLASS(BufferedWriter
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
 	public:
-		CrtFileReader()
-			: m_file(NULL)
+		BufferedWriter(WriterI* _writer, uint32_t _size = 64<<10)
+			: m_writer(_writer)
+			, m_buffer(new uint8_t[_size])
+			, m_pos(0)
+			, m_size(_size)
 		{
 		}
 
-		virtual ~CrtFileReader()
+		virtual ~BufferedWriter()
 		{
+			const int32_t result = flush();
+			BX_WARN(0 <= result, "Buffered data is lost, underlying writer failed.");
+			BX_UNUSED(result);
+			delete [] m_buffer;
 		}
 
-		virtual int32_t open(const char* _filePath) BX_OVERRIDE
+		virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
 		{
-			m_file = fopen(_filePath, "rb");
-			return NULL == m_file;
+			const uint8_t* data = (const uint8_t*)_data;
+
+			// Large write would be split in buffer sized chunks, skip
+			// buffer instead.
+			if (uint32_t(_size) >= m_size)
+			{
+				return 0 > flush() ? 0 : m_writer->write(data, _size);
+			}
+
+			if (uint32_t(_size) <= m_size - m_pos)
+			{
+				memcpy(&m_buffer[m_pos], data, _size);
+				m_pos += _size;
+				return _size;
+			}
+
+			if (0 > flush() )
+			{
+				return 0;
+			}
+
+			memcpy(m_buffer, data, _size);
+			m_pos = _size;
+			return _size;
 		}
 
-		virtual int32_t close() BX_OVERRIDE
+		virtual int32_t writev(const IoVec* _iov, uint32_t _num) BX_OVERRIDE
 		{
-			fclose(m_file);
-			return 0;
+			const uint32_t size = uint32_t(ioVecSize(_iov, _num) );
+
+			if (size >= m_size)
+			{
+				return 0 > flush() ? 0 : m_writer->writev(_iov, _num);
+			}
+
+			if (size > m_size - m_pos
+			&&  0 > flush() )
+			{
+				return 0;
+			}
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				memcpy(&m_buffer[m_pos], _iov[ii].m_data, _iov[ii].m_size);
+				m_pos += _iov[ii].m_size;
+			}
+
+			return int32_t(size);
 		}
 
-		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		/// Writes value without virtual call when it fits in buffer.
+		template<typename Ty>
+		int32_t write(const Ty& _value)
 		{
-			fseeko64(m_file, _offset, _whence);
-			return ftello64(m_file);
+			if (sizeof(Ty) <= m_size - m_pos)
+			{
+				memcpy(&m_buffer[m_pos], &_value, sizeof(Ty) );
+				m_pos += sizeof(Ty);
+				return sizeof(Ty);
+			}
+
+			return write(&_value, sizeof(Ty) );
 		}
 
-		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+		/// Forwards buffered data to underlying writer. Returns number of
+		/// bytes written by underlying writer, or -1 on failure. Data that
+		/// wasn't written stays in buffer, and flush can be retried.
+		int32_t flush()
 		{
-			return (int32_t)fread(_data, 1, _size, m_file);
+			if (0 == m_pos)
+			{
+				return 0;
+			}
+
+			const int32_t result = m_writer->write(m_buffer, m_pos);
+			if (int32_t(m_pos) == result)
+			{
+				m_pos = 0;
+				return result;
+			}
+
+			if (0 < result)
+			{
+				m_pos -= result;
+				memmove(m_buffer, &m_buffer[result], m_pos);
+			}
+
+			return -1;
 		}
 
 	private:
-		FILE* m_file;
+		WriterI* m_writer;
+		uint8_t* m_buffer;
+		uint32_t m_pos;
+		uint32_t m_size;
 	};
 
-	class CrtFileWriter : public FileWriterI
+	/// Reads from underlying reader in buffer sized chunks. Typed reads
+	/// called directly on BufferedReader are inlined and don't go through
+	/// virtual call.
+	class BufferedReader : public ReaderI
 	{
+		BX_CLASS(BufferedReader
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
 	public:
-		CrtFileWriter()
-			: m_file(NULL)
+		BufferedReader(ReaderI* _reader, uint32_t _size = 64<<10)
+			: m_reader(_reader)
+			, m_buffer(new uint8_t[_size])
+			, m_pos(0)
+			, m_top(0)
+			, m_size(_size)
 		{
 		}
 
-		virtual ~CrtFileWriter()
+		virtual ~BufferedReader()
 		{
+			delete [] m_buffer;
 		}
 
-		virtual int32_t open(const char* _filePath, bool _append = false) BX_OVERRIDE
+		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
 		{
-			if (_append)
+			uint8_t* data = (uint8_t*)_data;
+			uint32_t size = uint32_t(_size);
+
+			const uint32_t available = uint32_min(size, m_top - m_pos);
+			memcpy(data, &m_buffer[m_pos], available);
+			m_pos += available;
+			data  += available;
+			size  -= available;
+
+			if (0 == size)
 			{
-				m_file = fopen(_filePath, "ab");
+				return _size;
 			}
-			else
+
+			// Large read would be split in buffer sized chunks, skip
+			// buffer instead.
+			if (size >= m_size)
 			{
-				m_file = fopen(_filePath, "wb");
+				const int32_t result = m_reader->read(data, int32_t(size) );
+				return int32_t(available) + (0 < result ? result : 0);
 			}
 
-			return NULL == m_file;
+			const int32_t result = m_reader->read(m_buffer, int32_t(m_size) );
+			m_pos = 0;
+			m_top = 0 < result ? uint32_t(result) : 0;
+
+			const uint32_t rest = uint32_min(size, m_top);
+			memcpy(data, m_buffer, rest);
+			m_pos = rest;
+
+			return int32_t(available + rest);
 		}
 
-		virtual int32_t close() BX_OVERRIDE
+		/// Reads value without virtual call when it's already buffered.
+		template<typename Ty>
+		int32_t read(Ty& _value)
 		{
-			fclose(m_file);
-			return 0;
+			if (sizeof(Ty) <= m_top - m_pos)
+			{
+				memcpy(&_value, &m_buffer[m_pos], sizeof(Ty) );
+				m_pos += sizeof(Ty);
+				return sizeof(Ty);
+			}
+
+			return read(&_value, sizeof(Ty) );
 		}
 
-		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		/// Number of bytes buffered and not yet read.
+		uint32_t available() const
+		{
+			return m_top - m_pos;
+		}
+
+	private:
+		ReaderI* m_reader;
+		uint8_t* m_buffer;
+		uint32_t m_pos;
+		uint32_t m_top;
+		uint32_t m_size;
+	};
+
+	/// Forwards writes to underlying writer, and updates CRC-32C of
+	/// written data while it's still in cache. Checksum covers bytes
+	/// underlying writer accepted.
+	class ChecksumWriter : public WriterI
+	{
+		BX_CLASS(ChecksumWriter
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		ChecksumWriter(WriterI* _writer, uint32_t _crc = 0)
+			: m_writer(_writer)
+			, m_crc(_crc)
+		{
+		}
+
+		virtual ~ChecksumWriter()
 		{
-			fseeko64(m_file, _offset, _whence);
-			return ftello64(m_file);
 		}
 
 		virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
 		{
-			return (int32_t)fwrite(_data, 1, _size, m_file);
+			const int32_t result = m_writer->write(_data, _size);
+			m_crc = crc32c(m_crc, _data, 0 < result ? uint32_t(result) : 0);
+			return result;
+		}
+
+		virtual int32_t writev(const IoVec* _iov, uint32_t _num) BX_OVERRIDE
+		{
+			const int32_t result = m_writer->writev(_iov, _num);
+
+			uint32_t size = 0 < result ? uint32_t(result) : 0;
+			for (uint32_t ii = 0; ii < _num && 0 < size; ++ii)
+			{
+				const uint32_t len = uint32_min(size, uint32_t(_iov[ii].m_size) );
+				m_crc = crc32c(m_crc, _iov[ii].m_data, len);
+				size -= len;
+			}
+
+			return result;
+		}
+
+		/// CRC-32C of data written so far.
+		uint32_t getChecksum() const
+		{
+			return m_crc;
+		}
+
+		void reset(uint32_t _crc = 0)
+		{
+			m_crc = _crc;
 		}
 
 	private:
-		FILE* m_file;
+		WriterI* m_writer;
+		uint32_t m_crc;
 	};
-#endif // BX_CONFIG_CRT_FILE_READER_WRITER
+
+	/// Forwards reads to underlying reader, and updates CRC-32C of read
+	/// data while it's still in cache.
+	class ChecksumReader : public ReaderI
+	{
+		BX_CLASS(ChecksumReader
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		ChecksumReader(ReaderI* _reader, uint32_t _crc = 0)
+			: m_reader(_reader)
+			, m_crc(_crc)
+		{
+		}
+
+		virtual ~ChecksumReader()
+		{
+		}
+
+		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+		{
+			const int32_t result = m_reader->read(_data, _size);
+			m_crc = crc32c(m_crc, _data, 0 < result ? uint32_t(result) : 0);
+			return result;
+		}
+
+		/// CRC-32C of data read so far.
+		uint32_t getChecksum() const
+		{
+			return m_crc;
+		}
+
+		void reset(uint32_t _crc = 0)
+		{
+			m_crc = _crc;
+		}
+
+	private:
+		ReaderI* m_reader;
+		uint32_t m_crc;
+	};
+
+#if BX_CONFIG_CRT_FILE_READER_WRITER
+	class CrtFileReader : public FileReaderI
+	{
+	public:
+		CrtFileReader()
+			: m_file(NULL)
+		{
+		}
+
+		virtual ~CrtFileReader()
+		{
+		}
+
+		virtual int32_t open(const char* _filePath) BX_OVERRIDE
+		{
+			m_file = fopen(_filePath, "rb");
+			return NULL == m_file;
+		}
+
+		virtual int32_t close() BX_OVERRIDE
+		{
+			fclose(m_file);
+			return 0;
+		}
+
+		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		{
+			fseeko64(m_file, _offset, _whence);
+			return ftello64(m_file);
+		}
+
+		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+		{
+			return (int32_t)fread(_data, 1, _size, m_file);
+		}
+
+	private:
+		FILE* m_file;
+	};
+
+	class CrtFileWriter : public FileWriterI
+	{
+	public:
+		CrtFileWriter()
+			: m_file(NULL)
+		{
+		}
+
+		virtual ~CrtFileWriter()
+		{
+		}
+
+		virtual int32_t open(const char* _filePath, bool _append = false) BX_OVERRIDE
+		{
+			if (_append)
+			{
+				m_file = fopen(_filePath, "ab");
+			}
+			else
+			{
+				m_file = fopen(_filePath, "wb");
+			}
+
+			return NULL == m_file;
+		}
+
+		virtual int32_t close() BX_OVERRIDE
+		{
+			fclose(m_file);
+			return 0;
+		}
+
+		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		{
+			fseeko64(m_file, _offset, _whence);
+			return ftello64(m_file);
+		}
+
+		virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
+		{
+			return (int32_t)fwrite(_data, 1, _size, m_file);
+		}
+
+	private:
+		FILE* m_file;
+	};
+#endif // BX_CONFIG_CRT_FILE_READER_WRITER
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+	struct FdFlags
+	{
+		/// Flags passed to FdFileReader and FdFileWriter, options not
+		/// supported by OS are ignored.
+		enum Enum
+		{
+			Direct     = 0x1, //!< Bypass page cache for aligned requests, see BX_CONFIG_FD_DIRECT_ALIGNMENT.
+			Sequential = 0x2, //!< Aggressive read-ahead.
+			Random     = 0x4, //!< Disable read-ahead.
+			NoCache    = 0x8, //!< Drop streamed data from page cache, so it doesn't evict hot pages.
+		};
+	};
+
+	/// Returns true if request can be served with O_DIRECT.
+	inline bool isFdDirectAligned(const void* _data, uint32_t _size, int64_t _offset)
+	{
+		const uint64_t mask = BX_CONFIG_FD_DIRECT_ALIGNMENT-1;
+		return 0 == ( (uint64_t(uintptr_t(_data) ) | _size | uint64_t(_offset) ) & mask);
+	}
+
+	/// Opens file descriptor and applies FdFlags. With FdFlags::Direct
+	/// _direct receives second descriptor opened with O_DIRECT, or -1 if
+	/// OS or file system doesn't support it.
+	inline int fdOpen(const char* _filePath, int _oflag, uint32_t _flags, int& _direct)
+	{
+		_direct = -1;
+
+		const int fd = ::open(_filePath, _oflag, 0644);
+		if (-1 == fd)
+		{
+			return -1;
+		}
+
+		if (0 != (_flags & FdFlags::Direct) )
+		{
+#if defined(O_DIRECT)
+			// Descriptor is already created and truncated, second open
+			// only needs access mode.
+			_direct = ::open(_filePath, (_oflag & O_ACCMODE)|O_DIRECT);
+#elif BX_PLATFORM_IOS || BX_PLATFORM_OSX
+			fcntl(fd, F_NOCACHE, 1);
+#endif // defined(O_DIRECT)
+		}
+
+#if BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+		if (0 != (_flags & FdFlags::Sequential) )
+		{
+			posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+		else if (0 != (_flags & FdFlags::Random) )
+		{
+			posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+		}
+#elif BX_PLATFORM_IOS || BX_PLATFORM_OSX
+		if (0 != (_flags & FdFlags::NoCache) )
+		{
+			fcntl(fd, F_NOCACHE, 1);
+		}
+
+		fcntl(fd, F_RDAHEAD, 0 != (_flags & FdFlags::Random) ? 0 : 1);
+#endif // BX_PLATFORM_
+
+		return fd;
+	}
+
+	/// Reads until _size bytes are read, end of file, or error.
+	inline int32_t fdRead(int _fd, void* _data, int32_t _size, int64_t _offset)
+	{
+		uint8_t* data = (uint8_t*)_data;
+		int32_t total = 0;
+
+		while (total < _size)
+		{
+			const ssize_t result = pread(_fd, &data[total], size_t(_size - total), off_t(_offset + total) );
+			if (0 < result)
+			{
+				total += int32_t(result);
+			}
+			else if (0 == result
+				 ||  EINTR != errno)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
+	/// Writes until _size bytes are written, or error.
+	inline int32_t fdWrite(int _fd, const void* _data, int32_t _size, int64_t _offset)
+	{
+		const uint8_t* data = (const uint8_t*)_data;
+		int32_t total = 0;
+
+		while (total < _size)
+		{
+			const ssize_t result = pwrite(_fd, &data[total], size_t(_size - total), off_t(_offset + total) );
+			if (0 < result)
+			{
+				total += int32_t(result);
+			}
+			else if (0 == result
+				 ||  EINTR != errno)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
+	/// Writes all buffers, gathered in as few pwritev calls as possible.
+	inline int32_t fdWritev(int _fd, const IoVec* _iov, uint32_t _num, int64_t _offset)
+	{
+		int32_t total = 0;
+
+#if BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+		struct iovec iov[64];
+		uint32_t first = 0;
+		int32_t skip = 0; // Bytes of _iov[first] already written.
+
+		while (first < _num)
+		{
+			uint32_t num = 0;
+			for (uint32_t ii = first; ii < _num && num < BX_COUNTOF(iov); ++ii, ++num)
+			{
+				const int32_t offset = ii == first ? skip : 0;
+				iov[num].iov_base = (void*)( (const uint8_t*)_iov[ii].m_data + offset);
+				iov[num].iov_len  = size_t(_iov[ii].m_size - offset);
+			}
+
+			const ssize_t result = pwritev(_fd, iov, int(num), off_t(_offset + total) );
+			if (0 > result
+			&&  EINTR == errno)
+			{
+				continue;
+			}
+
+			if (0 >= result)
+			{
+				break;
+			}
+
+			total += int32_t(result);
+
+			int64_t written = skip + result;
+			while (first < _num
+			&&     written >= _iov[first].m_size)
+			{
+				written -= _iov[first].m_size;
+				++first;
+			}
+
+			skip = int32_t(written);
+		}
+#else
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const int32_t result = fdWrite(_fd, _iov[ii].m_data, _iov[ii].m_size, _offset + total);
+			total += result;
+
+			if (result != _iov[ii].m_size)
+			{
+				break;
+			}
+		}
+#endif // BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+
+		return total;
+	}
+
+	inline int64_t fdSize(int _fd)
+	{
+		struct stat st;
+		return 0 == fstat(_fd, &st) ? int64_t(st.st_size) : 0;
+	}
+
+	/// Unbuffered file reader, reads go straight to pread without stdio
+	/// buffering. With FdFlags::Direct aligned reads skip page cache, and
+	/// unaligned reads go through it.
+	class FdFileReader : public FileReaderI
+	{
+		BX_CLASS(FdFileReader
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		FdFileReader(uint32_t _flags = FdFlags::Sequential)
+			: m_fd(-1)
+			, m_fdDirect(-1)
+			, m_pos(0)
+			, m_dropped(0)
+			, m_flags(_flags)
+		{
+		}
+
+		virtual ~FdFileReader()
+		{
+			if (-1 != m_fd)
+			{
+				close();
+			}
+		}
+
+		virtual int32_t open(const char* _filePath) BX_OVERRIDE
+		{
+			BX_CHECK(-1 == m_fd, "File is already open!");
+
+			m_fd = fdOpen(_filePath, O_RDONLY, m_flags, m_fdDirect);
+			m_pos = 0;
+			m_dropped = 0;
+
+			return -1 == m_fd;
+		}
+
+		virtual int32_t close() BX_OVERRIDE
+		{
+			BX_CHECK(-1 != m_fd, "File is not open!");
+
+			if (-1 != m_fdDirect)
+			{
+				::close(m_fdDirect);
+				m_fdDirect = -1;
+			}
+
+			::close(m_fd);
+			m_fd = -1;
+
+			return 0;
+		}
+
+		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		{
+			switch (_whence)
+			{
+				case Whence::Begin:
+					m_pos = int64_max(_offset, 0);
+					break;
+
+				case Whence::Current:
+					m_pos = int64_max(m_pos + _offset, 0);
+					break;
+
+				case Whence::End:
+					m_pos = int64_max(fdSize(m_fd) - _offset, 0);
+					break;
+			}
+
+			return m_pos;
+		}
+
+		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+		{
+			const int32_t result = readAt(m_pos, _data, _size);
+			m_pos += result;
+
+#if BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+			if (0 != (m_flags & FdFlags::NoCache)
+			&&  BX_CONFIG_FD_NOCACHE_WINDOW <= m_pos - m_dropped)
+			{
+				// Pages are clean, they are dropped immediately.
+				posix_fadvise(m_fd, m_dropped, m_pos - m_dropped, POSIX_FADV_DONTNEED);
+				m_dropped = m_pos;
+			}
+#endif // BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+
+			return result;
+		}
+
+		/// Reads at _offset without moving read position. Can be called
+		/// from multiple threads at once.
+		int32_t readAt(int64_t _offset, void* _data, int32_t _size)
+		{
+			if (-1 != m_fdDirect
+			&&  isFdDirectAligned(_data, _size, _offset) )
+			{
+				return fdRead(m_fdDirect, _data, _size, _offset);
+			}
+
+			return fdRead(m_fd, _data, _size, _offset);
+		}
+
+		/// Returns true if aligned requests bypass page cache.
+		bool isDirect() const
+		{
+			return -1 != m_fdDirect;
+		}
+
+		int getFd() const
+		{
+			return m_fd;
+		}
+
+	private:
+		int m_fd;
+		int m_fdDirect;
+		int64_t m_pos;
+		int64_t m_dropped;
+		uint32_t m_flags;
+	};
+
+	/// Unbuffered file writer, writes go straight to pwrite without stdio
+	/// buffering. Wrap it with BufferedWriter when writing small values.
+	///
+	/// With FdFlags::NoCache written data is written back in
+	/// BX_CONFIG_FD_NOCACHE_WINDOW sized windows and dropped from page
+	/// cache once it's on disk, so bulk writes stream at device speed
+	/// without evicting hot pages. Window follows sequential write
+	/// position, writeAt is not tracked.
+	class FdFileWriter : public FileWriterI
+	{
+		BX_CLASS(FdFileWriter
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		FdFileWriter(uint32_t _flags = 0)
+			: m_fd(-1)
+			, m_fdDirect(-1)
+			, m_pos(0)
+			, m_synced(0)
+			, m_dropped(0)
+			, m_flags(_flags)
+		{
+		}
+
+		virtual ~FdFileWriter()
+		{
+			if (-1 != m_fd)
+			{
+				close();
+			}
+		}
+
+		virtual int32_t open(const char* _filePath, bool _append = false) BX_OVERRIDE
+		{
+			BX_CHECK(-1 == m_fd, "File is already open!");
+
+			// O_APPEND is not used since it makes pwrite ignore offset.
+			m_fd = fdOpen(_filePath, O_WRONLY|O_CREAT|(_append ? 0 : O_TRUNC), m_flags, m_fdDirect);
+			m_pos = -1 != m_fd && _append ? fdSize(m_fd) : 0;
+			m_synced = m_pos;
+			m_dropped = m_pos;
+
+			return -1 == m_fd;
+		}
+
+		virtual int32_t close() BX_OVERRIDE
+		{
+			BX_CHECK(-1 != m_fd, "File is not open!");
+
+			if (0 != (m_flags & FdFlags::NoCache) )
+			{
+				writeBehind(true);
+			}
+
+			if (-1 != m_fdDirect)
+			{
+				::close(m_fdDirect);
+				m_fdDirect = -1;
+			}
+
+			::close(m_fd);
+			m_fd = -1;
+
+			return 0;
+		}
+
+		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		{
+			switch (_whence)
+			{
+				case Whence::Begin:
+					m_pos = int64_max(_offset, 0);
+					break;
+
+				case Whence::Current:
+					m_pos = int64_max(m_pos + _offset, 0);
+					break;
+
+				case Whence::End:
+					m_pos = int64_max(fdSize(m_fd) - _offset, 0);
+					break;
+			}
+
+			return m_pos;
+		}
+
+		virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
+		{
+			const int32_t result = writeAt(m_pos, _data, _size);
+			advance(result);
+			return result;
+		}
+
+		virtual int32_t writev(const IoVec* _iov, uint32_t _num) BX_OVERRIDE
+		{
+			const int32_t result = writevAt(m_pos, _iov, _num);
+			advance(result);
+			return result;
+		}
+
+		/// Writes at _offset without moving write position. Can be called
+		/// from multiple threads at once.
+		int32_t writeAt(int64_t _offset, const void* _data, int32_t _size)
+		{
+			if (-1 != m_fdDirect
+			&&  isFdDirectAligned(_data, _size, _offset) )
+			{
+				return fdWrite(m_fdDirect, _data, _size, _offset);
+			}
+
+			return fdWrite(m_fd, _data, _size, _offset);
+		}
+
+		/// Gathered writeAt, buffers are written with single syscall.
+		int32_t writevAt(int64_t _offset, const IoVec* _iov, uint32_t _num)
+		{
+			if (-1 != m_fdDirect)
+			{
+				bool aligned = true;
+				int64_t offset = _offset;
+				for (uint32_t ii = 0; ii < _num && aligned; ++ii)
+				{
+					aligned = isFdDirectAligned(_iov[ii].m_data, _iov[ii].m_size, offset);
+					offset += _iov[ii].m_size;
+				}
+
+				if (aligned)
+				{
+					return fdWritev(m_fdDirect, _iov, _num, _offset);
+				}
+			}
+
+			return fdWritev(m_fd, _iov, _num, _offset);
+		}
+
+		/// Reserves disk space for _size bytes without changing file
+		/// size, which avoids fragmentation and allocation during
+		/// streaming. Returns false if it's not supported.
+		bool preallocate(int64_t _size)
+		{
+#if (BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX) && defined(FALLOC_FL_KEEP_SIZE)
+			return 0 == fallocate(m_fd, FALLOC_FL_KEEP_SIZE, 0, off_t(_size) );
+#elif BX_PLATFORM_IOS || BX_PLATFORM_OSX
+			fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, off_t(_size), 0 };
+			return -1 != fcntl(m_fd, F_PREALLOCATE, &store);
+#else
+			BX_UNUSED(_size);
+			return false;
+#endif // BX_PLATFORM_
+		}
+
+		/// Waits until written data is on disk.
+		void sync()
+		{
+#if BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+			fdatasync(m_fd);
+#else
+			fsync(m_fd);
+#endif // BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+		}
+
+		/// Returns true if aligned requests bypass page cache.
+		bool isDirect() const
+		{
+			return -1 != m_fdDirect;
+		}
+
+		int getFd() const
+		{
+			return m_fd;
+		}
+
+	private:
+		void advance(int32_t _size)
+		{
+			m_pos += _size;
+
+			if (0 != (m_flags & FdFlags::NoCache)
+			&&  BX_CONFIG_FD_NOCACHE_WINDOW <= m_pos - m_synced)
+			{
+				writeBehind(false);
+			}
+		}
+
+		void writeBehind(bool _wait)
+		{
+#if BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+			// Start writeback of new window, then wait for previous one,
+			// so that device is kept busy while window is written.
+			if (m_synced < m_pos)
+			{
+				sync_file_range(m_fd, m_synced, m_pos - m_synced, SYNC_FILE_RANGE_WRITE);
+			}
+
+			const int64_t end = _wait ? m_pos : m_synced;
+			if (m_dropped < end)
+			{
+				sync_file_range(m_fd, m_dropped, end - m_dropped
+					, SYNC_FILE_RANGE_WAIT_BEFORE|SYNC_FILE_RANGE_WRITE|SYNC_FILE_RANGE_WAIT_AFTER
+					);
+				posix_fadvise(m_fd, m_dropped, end - m_dropped, POSIX_FADV_DONTNEED);
+			}
+
+			m_dropped = end;
+#else
+			BX_UNUSED(_wait);
+#endif // BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+			m_synced = m_pos;
+		}
+
+		int m_fd;
+		int m_fdDirect;
+		int64_t m_pos;
+		int64_t m_synced;
+		int64_t m_dropped;
+		uint32_t m_flags;
+	};
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+
+#if BX_CONFIG_MMAP_FILE_READER
+	struct MmapHint
+	{
+		/// Flags passed to MmapFileReader, OS might ignore them.
+		enum Enum
+		{
+			Sequential = 0x1, //!< Aggressive read-ahead, pages can be freed soon after access.
+			Random     = 0x2, //!< Disable read-ahead.
+			WillNeed   = 0x4, //!< Start reading whole file into page cache.
+			HugePage   = 0x8, //!< Back mapping with huge pages where supported.
+		};
+	};
+
+	/// Maps whole file read-only, so parsers can work directly on mapped
+	/// pages without copying data. Mapping is shared with page cache, and
+	/// with other processes mapping the same file.
+	class MmapFileReader : public FileReaderI
+	{
+		BX_CLASS(MmapFileReader
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		MmapFileReader(uint32_t _hints = MmapHint::Sequential)
+			: m_data(NULL)
+			, m_pos(0)
+			, m_top(0)
+			, m_hints(_hints)
+#if BX_PLATFORM_WINDOWS
+			, m_file(INVALID_HANDLE_VALUE)
+			, m_mapping(NULL)
+#endif // BX_PLATFORM_WINDOWS
+			, m_open(false)
+		{
+		}
+
+		virtual ~MmapFileReader()
+		{
+			if (m_open)
+			{
+				close();
+			}
+		}
+
+		virtual int32_t open(const char* _filePath) BX_OVERRIDE
+		{
+			BX_CHECK(!m_open, "File is already open!");
+
+			m_data = NULL;
+			m_pos = 0;
+			m_top = 0;
+
+#if BX_PLATFORM_WINDOWS
+			const DWORD flags = 0 != (m_hints & MmapHint::Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN
+				: 0 != (m_hints & MmapHint::Random) ? FILE_FLAG_RANDOM_ACCESS
+				: FILE_ATTRIBUTE_NORMAL
+				;
+			m_file = CreateFileA(_filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+			if (INVALID_HANDLE_VALUE == m_file)
+			{
+				return 1;
+			}
+
+			// Whole file must fit into address space.
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size)
+			||  uint64_t(SIZE_T(size.QuadPart) ) != uint64_t(size.QuadPart) )
+			{
+				CloseHandle(m_file);
+				m_file = INVALID_HANDLE_VALUE;
+				return 1;
+			}
+
+			// Empty file can't be mapped.
+			if (0 < size.QuadPart)
+			{
+				m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+				m_data = NULL != m_mapping ? (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+				if (NULL == m_data)
+				{
+					if (NULL != m_mapping)
+					{
+						CloseHandle(m_mapping);
+						m_mapping = NULL;
+					}
+
+					CloseHandle(m_file);
+					m_file = INVALID_HANDLE_VALUE;
+					return 1;
+				}
+			}
+
+			m_top = size.QuadPart;
+#else
+			const int fd = ::open(_filePath, O_RDONLY);
+			if (-1 == fd)
+			{
+				return 1;
+			}
+
+			// Whole file must fit into address space.
+			struct stat st;
+			if (0 != fstat(fd, &st)
+			||  uint64_t(size_t(st.st_size) ) != uint64_t(st.st_size) )
+			{
+				::close(fd);
+				return 1;
+			}
+
+			// Empty file can't be mapped.
+			if (0 < st.st_size)
+			{
+				void* data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+				if (MAP_FAILED == data)
+				{
+					::close(fd);
+					return 1;
+				}
+
+				m_data = (const uint8_t*)data;
+			}
+
+			// Mapping keeps file referenced.
+			::close(fd);
+
+			m_top = int64_t(st.st_size);
+#endif // BX_PLATFORM_WINDOWS
+
+			m_open = true;
+			advise(m_hints);
+
+			return 0;
+		}
+
+		virtual int32_t close() BX_OVERRIDE
+		{
+			BX_CHECK(m_open, "File is not open!");
+
+#if BX_PLATFORM_WINDOWS
+			if (NULL != m_data)
+			{
+				UnmapViewOfFile(m_data);
+				CloseHandle(m_mapping);
+				m_mapping = NULL;
+			}
+
+			CloseHandle(m_file);
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (NULL != m_data)
+			{
+				munmap( (void*)m_data, size_t(m_top) );
+			}
+#endif // BX_PLATFORM_WINDOWS
+
+			m_data = NULL;
+			m_pos = 0;
+			m_top = 0;
+			m_open = false;
+
+			return 0;
+		}
+
+		/// Applies MmapHint flags to whole mapping.
+		void advise(uint32_t _hints)
+		{
+			m_hints = _hints;
+
+#if BX_PLATFORM_WINDOWS
+			// Read-ahead hints are passed to CreateFile on open.
+#else
+			if (NULL == m_data)
+			{
+				return;
+			}
+
+			void* data = (void*)m_data;
+			const size_t size = size_t(m_top);
+
+			if (0 != (_hints & MmapHint::Sequential) )
+			{
+				madvise(data, size, MADV_SEQUENTIAL);
+			}
+			else if (0 != (_hints & MmapHint::Random) )
+			{
+				madvise(data, size, MADV_RANDOM);
+			}
+
+			if (0 != (_hints & MmapHint::WillNeed) )
+			{
+				madvise(data, size, MADV_WILLNEED);
+			}
+
+#	if defined(MADV_HUGEPAGE)
+			if (0 != (_hints & MmapHint::HugePage) )
+			{
+				// Fails unless kernel supports huge pages for page cache.
+				madvise(data, size, MADV_HUGEPAGE);
+			}
+#	endif // defined(MADV_HUGEPAGE)
+#endif // BX_PLATFORM_WINDOWS
+		}
+
+		virtual int64_t seek(int64_t _offset = 0, Whence::Enum _whence = Whence::Current) BX_OVERRIDE
+		{
+			switch (_whence)
+			{
+				case Whence::Begin:
+					m_pos = int64_clamp(_offset, 0, m_top);
+					break;
+
+				case Whence::Current:
+					m_pos = int64_clamp(m_pos + _offset, 0, m_top);
+					break;
+
+				case Whence::End:
+					m_pos = int64_clamp(m_top - _offset, 0, m_top);
+					break;
+			}
+
+			return m_pos;
+		}
+
+		virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+		{
+			int64_t reminder = m_top-m_pos;
+			int32_t size = uint32_min(_size, int32_t(reminder > INT32_MAX ? INT32_MAX : reminder) );
+			if (0 >= size)
+			{
+				return 0;
+			}
+
+			memcpy(_data, &m_data[m_pos], size);
+			m_pos += size;
+			return size;
+		}
+
+		/// Returns pointer to mapped data at current position. Pointer is
+		/// valid until file is closed.
+		const uint8_t* getDataPtr() const
+		{
+			return &m_data[m_pos];
+		}
+
+		int64_t getPos() const
+		{
+			return m_pos;
+		}
+
+		int64_t remaining() const
+		{
+			return m_top-m_pos;
+		}
+
+		int64_t getSize() const
+		{
+			return m_top;
+		}
+
+	private:
+		const uint8_t* m_data;
+		int64_t m_pos;
+		int64_t m_top;
+		uint32_t m_hints;
+#if BX_PLATFORM_WINDOWS
+		HANDLE m_file;
+		HANDLE m_mapping;
+#endif // BX_PLATFORM_WINDOWS
+		bool m_open;
+	};
+#endif // BX_CONFIG_MMAP_FILE_READER
 
 } // namespace bx
 
@@ -10,6 +10,8 @@
 #include "cpu.h"
 #include "uint32_t.h"
 
+#include <string.h> // memcpy
+
 namespace bx
 {
 	class RingBufferControl
@@ -32,6 +34,11 @@ namespace bx
 			return distance(m_read, m_current);
 		}
 
+		uint32_t getRead() const // consumer only
+		{
+			return m_read;
+		}
+
 		uint32_t consume(uint32_t _size) // consumer only
 		{
 			const uint32_t maxSize    = distance(m_read, m_current);
@@ -95,8 +102,10 @@ namespace bx
 			: m_size(_size)
 			, m_current(0)
 			, m_write(0)
-			, m_read(0)
 		{
+			m_read.m_value = 0;
+			BX_WARN_FALSE_SHARING(m_current, m_read.m_value);
+			BX_WARN_FALSE_SHARING(m_write, m_read.m_value);
 		}
 
 		~SpScRingBufferControl()
@@ -105,24 +114,31 @@ namespace bx
 
 		uint32_t available() const
 		{
-			return distance(m_read, m_current);
+			return distance(m_read.m_value, atomicLoad(&m_current, MemoryOrder::Acquire) );
+		}
+
+		uint32_t getRead() const // consumer only
+		{
+			return m_read.m_value;
 		}
 
 		uint32_t consume(uint32_t _size) // consumer only
 		{
-			const uint32_t maxSize    = distance(m_read, m_current);
+			const uint32_t maxSize    = distance(m_read.m_value, atomicLoad(&m_current, MemoryOrder::Acquire) );
 			const uint32_t sizeNoSign = uint32_and(_size, 0x7FFFFFFF);
 			const uint32_t test       = uint32_sub(sizeNoSign, maxSize);
 			const uint32_t size       = uint32_sels(test, _size, maxSize);
-			const uint32_t advance    = uint32_add(m_read, size);
+			const uint32_t advance    = uint32_add(m_read.m_value, size);
 			const uint32_t read       = uint32_mod(advance, m_size);
-			m_read = read;
+
+			// data must be read before producer can reuse it.
+			atomicStore(&m_read.m_value, read, MemoryOrder::Release);
 			return size;
 		}
 
 		uint32_t reserve(uint32_t _size) // producer only
 		{
-			const uint32_t dist       = distance(m_write, m_read)-1;
+			const uint32_t dist       = distance(m_write, atomicLoad(&m_read.m_value, MemoryOrder::Acquire) )-1;
 			const uint32_t maxSize    = uint32_sels(dist, m_size-1, dist);
 			const uint32_t sizeNoSign = uint32_and(_size, 0x7FFFFFFF);
 			const uint32_t test       = uint32_sub(sizeNoSign, maxSize);
@@ -144,8 +160,7 @@ namespace bx
 
 			// must commit all memory writes before moving m_current pointer
 			// once m_current pointer moves data is used by consumer thread
-			memoryBarrier();
-			m_current = current;
+			atomicStore(&m_current, current, MemoryOrder::Release);
 			return size;
 		}
 
@@ -158,10 +173,16 @@ namespace bx
 			return result;
 		}
 
+		// Producer line, m_size is read-only and consumer already reads
+		// m_current from this line.
 		const uint32_t m_size;
 		uint32_t m_current;
 		uint32_t m_write;
-		uint32_t m_read;
+
+		// Consumer line. Padded type starts on next line, and producer
+		// fields fit in 16 bytes, so they stay on separate lines even
+		// when heap allocation is only 16 byte aligned.
+		CacheLinePadded<uint32_t> m_read;
 
 	private:
 		SpScRingBufferControl(const SpScRingBufferControl&);
@@ -174,7 +195,7 @@ namespace bx
 	public:
 		ReadRingBufferT(Control& _control, const char* _buffer, uint32_t _size)
 			: m_control(_control)
-			, m_read(_control.m_read)
+			, m_read(_control.getRead() )
 			, m_end(m_read+_size)
 			, m_size(_size)
 			, m_buffer(_buffer)
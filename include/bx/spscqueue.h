@@ -27,9 +27,11 @@ namespace bx
 	public:
 		SpScUnboundedQueueLf()
 			: m_first(new Node(NULL) )
-			, m_divider(m_first)
 			, m_last(m_first)
 		{
+			m_divider.m_value = m_first;
+			BX_WARN_FALSE_SHARING(m_divider.m_value, m_last);
+			BX_WARN_FALSE_SHARING(m_divider.m_value, m_first);
 		}
 
 		~SpScUnboundedQueueLf()
@@ -45,8 +47,8 @@ namespace bx
 		void push(Ty* _ptr) // producer only
 		{
 			m_last->m_next = new Node( (void*)_ptr);
-			atomicExchangePtr( (void**)&m_last, m_last->m_next);
-			while (m_first != m_divider)
+			atomicStore(&m_last, m_last->m_next, MemoryOrder::Release);
+			while (m_first != atomicLoad(&m_divider.m_value, MemoryOrder::Acquire) )
 			{
 				Node* node = m_first;
 				m_first = m_first->m_next;
@@ -56,9 +58,9 @@ namespace bx
 
 		Ty* peek() // consumer only
 		{
-			if (m_divider != m_last)
+			if (m_divider.m_value != atomicLoad(&m_last, MemoryOrder::Acquire) )
 			{
-				Ty* ptr = (Ty*)m_divider->m_next->m_ptr;
+				Ty* ptr = (Ty*)m_divider.m_value->m_next->m_ptr;
 				return ptr;
 			}
 
@@ -67,10 +69,10 @@ namespace bx
 
 		Ty* pop() // consumer only
 		{
-			if (m_divider != m_last)
+			if (m_divider.m_value != atomicLoad(&m_last, MemoryOrder::Acquire) )
 			{
-				Ty* ptr = (Ty*)m_divider->m_next->m_ptr;
-				atomicExchangePtr( (void**)&m_divider, m_divider->m_next);
+				Ty* ptr = (Ty*)m_divider.m_value->m_next->m_ptr;
+				atomicStore(&m_divider.m_value, m_divider.m_value->m_next, MemoryOrder::Release);
 				return ptr;
 			}
 
@@ -90,9 +92,13 @@ namespace bx
 			Node* m_next;
 		};
 
+		// m_first and m_last are written by producer, m_divider by consumer.
+		// Padded type starts on next line, and producer fields fit in 16
+		// bytes, so they stay on separate lines even when heap allocation
+		// is only 16 byte aligned.
 		Node* m_first;
-		Node* m_divider;
 		Node* m_last;
+		CacheLinePadded<Node*> m_divider;
 	};
 
 	template<typename Ty>
@@ -0,0 +1,413 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_TASKGRAPH_H__
+#define __BX_TASKGRAPH_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "jobsystem.h"
+#include "timer.h"
+
+namespace bx
+{
+	/// Directed acyclic graph of jobs. Nodes and edges are declared once,
+	/// then graph is compiled and can be executed repeatedly without any
+	/// allocation. Node is submitted to job system as soon as all its
+	/// predecessors are done. Start and end time of every node is captured
+	/// on each run, so that critical path can be inspected.
+	class TaskGraph
+	{
+		BX_CLASS(TaskGraph
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		enum { Invalid = UINT32_MAX };
+
+		TaskGraph()
+			: m_node(NULL)
+			, m_edge(NULL)
+			, m_successor(NULL)
+			, m_order(NULL)
+			, m_pathCost(NULL)
+			, m_pathNext(NULL)
+			, m_jobSystem(NULL)
+			, m_maxNodes(0)
+			, m_maxEdges(0)
+			, m_numNodes(0)
+			, m_numEdges(0)
+			, m_startTime(0)
+			, m_endTime(0)
+			, m_compiled(false)
+		{
+		}
+
+		~TaskGraph()
+		{
+			shutdown();
+		}
+
+		void init(uint32_t _maxNodes, uint32_t _maxEdges)
+		{
+			BX_CHECK(NULL == m_node, "Already initialized!");
+
+			m_maxNodes = _maxNodes;
+			m_maxEdges = _maxEdges;
+			m_numNodes = 0;
+			m_numEdges = 0;
+			m_compiled = false;
+
+			m_node = new Node[_maxNodes];
+			m_order = new uint32_t[_maxNodes];
+			m_pathCost = new int64_t[_maxNodes];
+			m_pathNext = new uint32_t[_maxNodes];
+			m_edge = new Edge[_maxEdges];
+			m_successor = new uint32_t[_maxEdges];
+		}
+
+		void shutdown()
+		{
+			delete [] m_node;
+			delete [] m_order;
+			delete [] m_pathCost;
+			delete [] m_pathNext;
+			delete [] m_edge;
+			delete [] m_successor;
+
+			m_node = NULL;
+			m_order = NULL;
+			m_pathCost = NULL;
+			m_pathNext = NULL;
+			m_edge = NULL;
+			m_successor = NULL;
+			m_maxNodes = 0;
+			m_maxEdges = 0;
+			m_numNodes = 0;
+			m_numEdges = 0;
+			m_compiled = false;
+		}
+
+		/// Returns node index, or TaskGraph::Invalid if graph is full.
+		uint32_t addNode(const char* _name, JobFn _fn, void* _userData)
+		{
+			BX_CHECK(!m_compiled, "Graph is already compiled.");
+
+			if (m_numNodes == m_maxNodes)
+			{
+				return Invalid;
+			}
+
+			const uint32_t idx = m_numNodes++;
+			Node& node = m_node[idx];
+			node.m_graph = this;
+			node.m_name = _name;
+			node.m_fn = _fn;
+			node.m_userData = _userData;
+			node.m_numPredecessors = 0;
+			node.m_pending.store(0, MemoryOrder::Relaxed);
+			node.m_firstSuccessor = 0;
+			node.m_numSuccessors = 0;
+			node.m_startTime = 0;
+			node.m_endTime = 0;
+			node.m_workerIndex = 0;
+			return idx;
+		}
+
+		/// Node _to runs after node _from is done. Returns false if graph is
+		/// full.
+		bool addEdge(uint32_t _from, uint32_t _to)
+		{
+			BX_CHECK(!m_compiled, "Graph is already compiled.");
+			BX_CHECK(_from < m_numNodes && _to < m_numNodes && _from != _to
+				, "Invalid edge %d -> %d."
+				, _from
+				, _to
+				);
+
+			if (m_numEdges == m_maxEdges)
+			{
+				return false;
+			}
+
+			Edge& edge = m_edge[m_numEdges++];
+			edge.m_from = _from;
+			edge.m_to = _to;
+			return true;
+		}
+
+		/// Builds successor lists and topological order. Returns false if
+		/// graph has a cycle.
+		bool compile()
+		{
+			for (uint32_t ii = 0; ii < m_numNodes; ++ii)
+			{
+				m_node[ii].m_numPredecessors = 0;
+				m_node[ii].m_numSuccessors = 0;
+			}
+
+			for (uint32_t ii = 0; ii < m_numEdges; ++ii)
+			{
+				++m_node[m_edge[ii].m_from].m_numSuccessors;
+				++m_node[m_edge[ii].m_to].m_numPredecessors;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t ii = 0; ii < m_numNodes; ++ii)
+			{
+				m_node[ii].m_firstSuccessor = offset;
+				offset += m_node[ii].m_numSuccessors;
+				m_node[ii].m_numSuccessors = 0;
+			}
+
+			for (uint32_t ii = 0; ii < m_numEdges; ++ii)
+			{
+				Node& from = m_node[m_edge[ii].m_from];
+				m_successor[from.m_firstSuccessor + from.m_numSuccessors++] = m_edge[ii].m_to;
+			}
+
+			// Kahn's algorithm, m_pending is used as scratch.
+			uint32_t num = 0;
+			for (uint32_t ii = 0; ii < m_numNodes; ++ii)
+			{
+				m_node[ii].m_pending.store(int32_t(m_node[ii].m_numPredecessors), MemoryOrder::Relaxed);
+				if (0 == m_node[ii].m_numPredecessors)
+				{
+					m_order[num++] = ii;
+				}
+			}
+
+			for (uint32_t ii = 0; ii < num; ++ii)
+			{
+				const Node& node = m_node[m_order[ii]];
+				for (uint32_t jj = 0; jj < node.m_numSuccessors; ++jj)
+				{
+					const uint32_t succ = m_successor[node.m_firstSuccessor + jj];
+					if (1 == m_node[succ].m_pending.fetchSub(1, MemoryOrder::Relaxed) )
+					{
+						m_order[num++] = succ;
+					}
+				}
+			}
+
+			m_compiled = num == m_numNodes;
+			BX_WARN(m_compiled, "Task graph has a cycle.");
+
+			return m_compiled;
+		}
+
+		/// Executes graph and waits until all nodes are done. Calling thread
+		/// executes jobs while waiting. Without job system nodes are executed
+		/// serially in topological order.
+		void execute(JobSystem* _jobSystem)
+		{
+			BX_CHECK(m_compiled, "Graph must be compiled before execution.");
+
+			m_startTime = getHPCounter();
+
+			if (NULL == _jobSystem)
+			{
+				for (uint32_t ii = 0; ii < m_numNodes; ++ii)
+				{
+					Node& node = m_node[m_order[ii]];
+					node.m_startTime = getHPCounter();
+					node.m_fn(node.m_userData);
+					node.m_endTime = getHPCounter();
+					node.m_workerIndex = 0;
+				}
+			}
+			else
+			{
+				m_jobSystem = _jobSystem;
+
+				for (uint32_t ii = 0; ii < m_numNodes; ++ii)
+				{
+					m_node[ii].m_pending.store(int32_t(m_node[ii].m_numPredecessors), MemoryOrder::Relaxed);
+				}
+
+				for (uint32_t ii = 0; ii < m_numNodes && 0 == m_node[m_order[ii]].m_numPredecessors; ++ii)
+				{
+					m_jobSystem->submit(runNode, &m_node[m_order[ii]], &m_counter);
+				}
+
+				m_jobSystem->wait(&m_counter);
+				m_jobSystem = NULL;
+			}
+
+			m_endTime = getHPCounter();
+		}
+
+		uint32_t getNumNodes() const
+		{
+			return m_numNodes;
+		}
+
+		const char* getNodeName(uint32_t _idx) const
+		{
+			return m_node[_idx].m_name;
+		}
+
+		/// Node start and end time of last run, in getHPCounter ticks
+		/// relative to start of run.
+		void getNodeTime(uint32_t _idx, int64_t& _start, int64_t& _end) const
+		{
+			_start = m_node[_idx].m_startTime - m_startTime;
+			_end   = m_node[_idx].m_endTime   - m_startTime;
+		}
+
+		/// Worker index of thread that executed node in last run.
+		uint32_t getNodeWorker(uint32_t _idx) const
+		{
+			return m_node[_idx].m_workerIndex;
+		}
+
+		/// Duration of last run in getHPCounter ticks.
+		int64_t getTime() const
+		{
+			return m_endTime - m_startTime;
+		}
+
+		/// Finds path through graph with the longest sum of node durations
+		/// in last run. Writes up to _max node indices from first to last
+		/// node into _nodes, and returns length of path. _duration receives
+		/// sum of node durations on path.
+		uint32_t getCriticalPath(uint32_t* _nodes, uint32_t _max, int64_t& _duration)
+		{
+			_duration = 0;
+
+			if (0 == m_numNodes)
+			{
+				return 0;
+			}
+
+			// Longest path starting at each node, computed in reverse
+			// topological order.
+			int64_t* cost = m_pathCost;
+			uint32_t* next = m_pathNext;
+
+			for (uint32_t ii = m_numNodes; ii > 0; --ii)
+			{
+				const uint32_t idx = m_order[ii-1];
+				const Node& node = m_node[idx];
+
+				int64_t best = 0;
+				uint32_t bestNext = Invalid;
+				for (uint32_t jj = 0; jj < node.m_numSuccessors; ++jj)
+				{
+					const uint32_t succ = m_successor[node.m_firstSuccessor + jj];
+					if (Invalid == bestNext
+					||  cost[succ] > best)
+					{
+						best = cost[succ];
+						bestNext = succ;
+					}
+				}
+
+				cost[idx] = best + (node.m_endTime - node.m_startTime);
+				next[idx] = bestNext;
+			}
+
+			uint32_t first = 0;
+			for (uint32_t ii = 1; ii < m_numNodes; ++ii)
+			{
+				first = cost[ii] > cost[first] ? ii : first;
+			}
+
+			_duration = cost[first];
+
+			uint32_t num = 0;
+			for (uint32_t idx = first; Invalid != idx; idx = next[idx])
+			{
+				if (num < _max)
+				{
+					_nodes[num] = idx;
+				}
+
+				++num;
+			}
+
+			return num;
+		}
+
+	private:
+		struct Node
+		{
+			TaskGraph* m_graph;
+			const char* m_name;
+			JobFn m_fn;
+			void* m_userData;
+			uint32_t m_numPredecessors;
+			Atomic<int32_t> m_pending;
+			uint32_t m_firstSuccessor;
+			uint32_t m_numSuccessors;
+			int64_t m_startTime;
+			int64_t m_endTime;
+			uint32_t m_workerIndex;
+		};
+
+		struct Edge
+		{
+			uint32_t m_from;
+			uint32_t m_to;
+		};
+
+		static void runNode(void* _userData)
+		{
+			Node* node = (Node*)_userData;
+			TaskGraph* graph = node->m_graph;
+
+			// Run one ready successor directly instead of going through
+			// queue, others are submitted so idle workers can pick them up.
+			while (NULL != node)
+			{
+				node->m_workerIndex = graph->m_jobSystem->getWorkerIndex();
+				node->m_startTime = getHPCounter();
+				node->m_fn(node->m_userData);
+				node->m_endTime = getHPCounter();
+
+				Node* next = NULL;
+				for (uint32_t ii = 0; ii < node->m_numSuccessors; ++ii)
+				{
+					// Node results must be visible to successors, and last
+					// predecessor must see results of all others.
+					Node* succ = &graph->m_node[graph->m_successor[node->m_firstSuccessor + ii] ];
+					if (1 == succ->m_pending.fetchSub(1, MemoryOrder::AcqRel) )
+					{
+						if (NULL == next)
+						{
+							next = succ;
+						}
+						else
+						{
+							graph->m_jobSystem->submit(runNode, succ, &graph->m_counter);
+						}
+					}
+				}
+
+				node = next;
+			}
+		}
+
+		Node* m_node;
+		Edge* m_edge;
+		uint32_t* m_successor;
+		uint32_t* m_order;
+		int64_t* m_pathCost;
+		uint32_t* m_pathNext;
+		JobSystem* m_jobSystem;
+		JobCounter m_counter;
+		uint32_t m_maxNodes;
+		uint32_t m_maxEdges;
+		uint32_t m_numNodes;
+		uint32_t m_numEdges;
+		int64_t m_startTime;
+		int64_t m_endTime;
+		bool m_compiled;
+	};
+
+} // namespace bx
+
+#endif // __BX_TASKGRAPH_H__
@@ -6,10 +6,17 @@
 #ifndef __BX_THREAD_H__
 #define __BX_THREAD_H__
 
+#include "bx.h"
+
 #if BX_PLATFORM_POSIX
 #	include <pthread.h>
+#	include <sched.h>
+#	if BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+#		include <sys/resource.h> // setpriority
+#	endif // BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
 #endif // BX_PLATFORM_POSIX
 
+#include "os.h"
 #include "sem.h"
 
 namespace bx
@@ -34,8 +41,10 @@ namespace bx
 			, m_userData(NULL)
 			, m_stackSize(0)
 			, m_exitCode(0 /*EXIT_SUCCESS*/)
+			, m_tid(0)
 			, m_running(false)
 		{
+			m_name[0] = '\0';
 		}
 
 		virtual ~Thread()
@@ -46,10 +55,20 @@ namespace bx
 			}
 		}
 
-		void init(ThreadFn _fn, void* _userData = NULL, uint32_t _stackSize = 0)
+		/// Starts thread. Optional _name is set as OS thread name, it's
+		/// visible in debuggers and profilers (Linux limits it to 15
+		/// characters).
+		void init(ThreadFn _fn, void* _userData = NULL, uint32_t _stackSize = 0, const char* _name = NULL)
 		{
 			BX_CHECK(!m_running, "Already running!");
 
+			m_name[0] = '\0';
+			if (NULL != _name)
+			{
+				strncpy(m_name, _name, sizeof(m_name)-1);
+				m_name[sizeof(m_name)-1] = '\0';
+			}
+
 			m_fn = _fn;
 			m_userData = _userData;
 			m_stackSize = _stackSize;
@@ -77,13 +96,11 @@ namespace bx
 				BX_CHECK(0 == result, "pthread_attr_setstacksize failed! %d", result);
 			}
 
-// 			sched_param sched;
-// 			sched.sched_priority = 0;
-// 			result = pthread_attr_setschedparam(&attr, &sched);
-// 			BX_CHECK(0 == result, "pthread_attr_setschedparam failed! %d", result);
-
 			result = pthread_create(&m_handle, &attr, &threadFunc, this);
-			BX_CHECK(0 == result, "pthread_attr_setschedparam failed! %d", result);
+			BX_CHECK(0 == result, "pthread_create failed! %d", result);
+
+			result = pthread_attr_destroy(&attr);
+			BX_CHECK(0 == result, "pthread_attr_destroy failed! %d", result);
 #endif // BX_PLATFORM_
 
 			m_sem.wait();
@@ -115,13 +132,102 @@ namespace bx
 			return m_running;
 		}
 
+		const char* getName() const
+		{
+			return m_name;
+		}
+
+		/// Restricts thread to run only on CPUs in _mask. Returns false if
+		/// not supported on platform, or if call failed.
+		bool setAffinity(const CpuMask& _mask)
+		{
+			BX_CHECK(m_running, "Not running!");
+#if BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (uint32_t ii = 0; ii < BX_CONFIG_MAX_CPUS && ii < CPU_SETSIZE; ++ii)
+			{
+				if (_mask.isSet(ii) )
+				{
+					CPU_SET(ii, &set);
+				}
+			}
+
+			return 0 == sched_setaffinity(m_tid, sizeof(set), &set);
+#elif BX_PLATFORM_WINDOWS
+			return 0 != SetThreadAffinityMask(m_handle, (DWORD_PTR)_mask.m_bits[0]);
+#else
+			BX_UNUSED(_mask);
+			return false;
+#endif // BX_PLATFORM_
+		}
+
+		/// Switches thread to real-time FIFO scheduling with _priority
+		/// (1-99 on Linux). Usually requires elevated privileges.
+		bool setRealtimePriority(int32_t _priority)
+		{
+			BX_CHECK(m_running, "Not running!");
+#if BX_PLATFORM_WINDOWS
+			BX_UNUSED(_priority);
+			return 0 != SetThreadPriority(m_handle, THREAD_PRIORITY_TIME_CRITICAL);
+#elif BX_PLATFORM_POSIX && !BX_PLATFORM_NACL
+			sched_param param;
+			param.sched_priority = _priority;
+			return 0 == pthread_setschedparam(m_handle, SCHED_FIFO, &param);
+#else
+			BX_UNUSED(_priority);
+			return false;
+#endif // BX_PLATFORM_
+		}
+
+		/// Sets nice value of thread with normal scheduling policy, from -20
+		/// (highest priority) to 19 (lowest priority). Negative values
+		/// usually require elevated privileges.
+		bool setNice(int32_t _nice)
+		{
+			BX_CHECK(m_running, "Not running!");
+#if BX_PLATFORM_LINUX || BX_PLATFORM_ANDROID
+			// On Linux nice value is per thread.
+			return 0 == setpriority(PRIO_PROCESS, m_tid, _nice);
+#elif BX_PLATFORM_WINDOWS
+			const int priority = _nice < -10 ? THREAD_PRIORITY_HIGHEST
+				: _nice <   0 ? THREAD_PRIORITY_ABOVE_NORMAL
+				: _nice ==  0 ? THREAD_PRIORITY_NORMAL
+				: _nice <  10 ? THREAD_PRIORITY_BELOW_NORMAL
+				:               THREAD_PRIORITY_LOWEST
+				;
+			return 0 != SetThreadPriority(m_handle, priority);
+#else
+			BX_UNUSED(_nice);
+			return false;
+#endif // BX_PLATFORM_
+		}
+
 	private:
 		int32_t entry()
 		{
+			m_tid = getTid();
+
+			if ('\0' != m_name[0])
+			{
+				setThreadName(m_name);
+			}
+
 			m_sem.post();
 			return m_fn(m_userData);
 		}
 
+		static void setThreadName(const char* _name)
+		{
+#if BX_PLATFORM_LINUX && defined(__GLIBC__)
+			pthread_setname_np(pthread_self(), _name);
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+			pthread_setname_np(_name);
+#else
+			BX_UNUSED(_name);
+#endif // BX_PLATFORM_
+		}
+
 #if BX_PLATFORM_WINDOWS|BX_PLATFORM_XBOX360
 		static DWORD WINAPI threadFunc(LPVOID _arg)
 		{
@@ -154,6 +260,8 @@ namespace bx
 		Semaphore m_sem;
 		uint32_t m_stackSize;
 		int32_t m_exitCode;
+		uint32_t m_tid;
+		char m_name[16];
 		bool m_running;
 	};
 
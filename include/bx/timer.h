@@ -7,18 +7,36 @@
 #define __BX_TIMER_H__
 
 #include "bx.h"
+#include "cpu.h"
 
-#if BX_PLATFORM_ANDROID
-#	include <time.h> // clock, clock_gettime
-#elif BX_PLATFORM_NACL || BX_PLATFORM_LINUX || BX_PLATFORM_OSX || BX_PLATFORM_IOS || BX_PLATFORM_QNX
+#if BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX || BX_PLATFORM_QNX
+#	include <time.h> // clock_gettime
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+#	include <mach/mach_time.h> // mach_absolute_time
+#elif BX_PLATFORM_EMSCRIPTEN
+#	include <time.h> // clock
+#elif BX_PLATFORM_NACL
 #	include <sys/time.h> // gettimeofday
 #elif BX_PLATFORM_WINDOWS
 #	include <windows.h>
 #endif // BX_PLATFORM_
 
+/// When enabled getHPCounter returns invariant TSC if CPU supports it,
+/// otherwise monotonic OS clock. TSC frequency is calibrated against
+/// monotonic clock on first call, which takes
+/// BX_CONFIG_TIMER_TSC_CALIBRATION_MS milliseconds.
+#ifndef BX_CONFIG_TIMER_TSC
+#	define BX_CONFIG_TIMER_TSC 0
+#endif // BX_CONFIG_TIMER_TSC
+
+#ifndef BX_CONFIG_TIMER_TSC_CALIBRATION_MS
+#	define BX_CONFIG_TIMER_TSC_CALIBRATION_MS 10
+#endif // BX_CONFIG_TIMER_TSC_CALIBRATION_MS
+
 namespace bx
 {
-	inline int64_t getHPCounter()
+	/// Monotonic OS clock, not affected by wall clock adjustments.
+	inline int64_t getMonotonicCounter()
 	{
 #if BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
 		LARGE_INTEGER li;
@@ -26,12 +44,16 @@ namespace bx
 		// http://support.microsoft.com/kb/274323
 		QueryPerformanceCounter(&li);
 		int64_t i64 = li.QuadPart;
-#elif BX_PLATFORM_ANDROID || BX_PLATFORM_EMSCRIPTEN
-		int64_t i64 = clock();
-#elif 0 // BX_PLATFORM_LINUX
+#elif BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX || BX_PLATFORM_QNX
+		// CLOCK_MONOTONIC_RAW is not slewed by NTP, but it's not serviced
+		// by vDSO on older kernels and costs a syscall.
 		struct timespec now;
-		clock_gettime(CLOCK_MONOTONIC_RAW, &now);
-		int64_t i64 = now.tv_sec*1000000 + now.tv_nsec/1000;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		int64_t i64 = int64_t(now.tv_sec)*INT64_C(1000000000) + now.tv_nsec;
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+		int64_t i64 = int64_t(mach_absolute_time() );
+#elif BX_PLATFORM_EMSCRIPTEN
+		int64_t i64 = clock();
 #else
 		struct timeval now;
 		gettimeofday(&now, 0);
@@ -40,19 +62,98 @@ namespace bx
 		return i64;
 	}
 
-	inline int64_t getHPFrequency()
+	/// Ticks per second of getMonotonicCounter.
+	inline int64_t getMonotonicFrequency()
 	{
 #if BX_PLATFORM_WINDOWS || BX_PLATFORM_XBOX360
 		LARGE_INTEGER li;
 		QueryPerformanceFrequency(&li);
 		return li.QuadPart;
-#elif BX_PLATFORM_ANDROID || BX_PLATFORM_EMSCRIPTEN
+#elif BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX || BX_PLATFORM_QNX
+		return INT64_C(1000000000);
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+		mach_timebase_info_data_t info;
+		mach_timebase_info(&info);
+		return INT64_C(1000000000)*info.denom/info.numer;
+#elif BX_PLATFORM_EMSCRIPTEN
 		return CLOCKS_PER_SEC;
 #else
 		return 1000000;
 #endif // BX_PLATFORM_
 	}
 
+	/// Reads CPU time stamp counter. Returns 0 on CPUs without TSC.
+	inline int64_t getTscCounter()
+	{
+#if BX_CPU_X86 && BX_COMPILER_MSVC
+		return int64_t(__rdtsc() );
+#elif BX_CPU_X86 && (BX_COMPILER_GCC || BX_COMPILER_CLANG)
+		return int64_t(__builtin_ia32_rdtsc() );
+#else
+		return 0;
+#endif // BX_CPU_X86
+	}
+
+	/// Measures TSC frequency against monotonic clock. Returns 0 if TSC
+	/// is not invariant, since its rate then changes with CPU frequency.
+	inline int64_t tscCalibrate(uint32_t _ms = BX_CONFIG_TIMER_TSC_CALIBRATION_MS)
+	{
+		if (0 == (cpuFeatures() & CpuFeatures::InvariantTsc) )
+		{
+			return 0;
+		}
+
+		const int64_t freq     = getMonotonicFrequency();
+		const int64_t duration = freq*_ms/1000;
+		const int64_t start    = getMonotonicCounter();
+		const int64_t tscStart = getTscCounter();
+
+		int64_t now;
+		do
+		{
+			now = getMonotonicCounter();
+		} while (now - start < duration);
+
+		const int64_t tscEnd = getTscCounter();
+
+		return int64_t(double(tscEnd - tscStart)*double(freq)/double(now - start) );
+	}
+
+	/// Calibrated TSC frequency, measured once. Returns 0 if TSC is not
+	/// usable.
+	inline int64_t getTscFrequency()
+	{
+		static const int64_t s_frequency = tscCalibrate();
+		return s_frequency;
+	}
+
+	/// High precision monotonic counter, see BX_CONFIG_TIMER_TSC.
+	inline int64_t getHPCounter()
+	{
+#if BX_CONFIG_TIMER_TSC
+		if (0 != getTscFrequency() )
+		{
+			return getTscCounter();
+		}
+#endif // BX_CONFIG_TIMER_TSC
+
+		return getMonotonicCounter();
+	}
+
+	/// Ticks per second of getHPCounter.
+	inline int64_t getHPFrequency()
+	{
+#if BX_CONFIG_TIMER_TSC
+		const int64_t tscFrequency = getTscFrequency();
+		if (0 != tscFrequency)
+		{
+			return tscFrequency;
+		}
+#endif // BX_CONFIG_TIMER_TSC
+
+		return getMonotonicFrequency();
+	}
+
 } // namespace bx
 
 #endif // __BX_TIMER_H__
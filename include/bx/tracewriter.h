@@ -0,0 +1,191 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_TRACEWRITER_H__
+#define __BX_TRACEWRITER_H__
+
+#include "bx.h"
+#include "profiler.h"
+#include "readerwriter.h"
+#include "string.h"
+
+namespace bx
+{
+	/// Streams profiler events as Chrome Trace Event Format JSON, which can
+	/// be loaded into chrome://tracing or Perfetto UI.
+	///
+	/// Trace Event Format
+	/// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+	///
+	/// Output is JSON array format, both viewers accept array without
+	/// closing bracket, so capture interrupted before end is still usable.
+	class ChromeTraceWriter : public ProfilerCallbackI
+	{
+		BX_CLASS(ChromeTraceWriter
+			, NO_COPY
+			, NO_ASSIGNMENT
+			);
+
+	public:
+		/// Timestamps are written relative to _baseTime, in microseconds.
+		ChromeTraceWriter(WriterI* _writer, uint32_t _pid = 0, int64_t _baseTime = getHPCounter(), int64_t _frequency = getHPFrequency() )
+			: m_writer(_writer)
+			, m_baseTime(_baseTime)
+			, m_toUs(1.0e6/double(_frequency) )
+			, m_pid(_pid)
+			, m_num(0)
+		{
+		}
+
+		virtual ~ChromeTraceWriter()
+		{
+		}
+
+		void begin()
+		{
+			write(m_writer, "[\n", 2);
+		}
+
+		void end()
+		{
+			write(m_writer, "\n]\n", 3);
+		}
+
+		virtual void events(uint32_t _tid, const ProfilerEvent* _events, uint32_t _num) BX_OVERRIDE
+		{
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				writeEvent(_tid, _events[ii]);
+			}
+		}
+
+		/// Number of events written.
+		uint32_t getNum() const
+		{
+			return m_num;
+		}
+
+	private:
+		void writeEvent(uint32_t _tid, const ProfilerEvent& _event)
+		{
+			char name[128];
+			escape(name, sizeof(name), _event.m_name);
+
+			const double ts = double(_event.m_time - m_baseTime)*m_toUs;
+			const char* separator = 0 == m_num ? "" : ",\n";
+
+			char temp[320];
+			int32_t len = 0;
+
+			switch (_event.m_type)
+			{
+			case ProfilerEventType::Begin:
+			case ProfilerEventType::End:
+				len = snprintf(temp, sizeof(temp), "%s{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u}"
+					, separator
+					, name
+					, ProfilerEventType::Begin == _event.m_type ? "B" : "E"
+					, ts
+					, m_pid
+					, _tid
+					);
+				break;
+
+			case ProfilerEventType::Counter:
+				len = snprintf(temp, sizeof(temp), "%s{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"value\":%lld}}"
+					, separator
+					, name
+					, ts
+					, m_pid
+					, _tid
+					, (long long)_event.m_value
+					);
+				break;
+
+			case ProfilerEventType::FlowBegin:
+			case ProfilerEventType::FlowEnd:
+				// Flow start and end are matched by name, category and id.
+				// Id is written as string since JSON numbers above 2^53
+				// lose precision.
+				len = snprintf(temp, sizeof(temp), "%s{\"name\":\"flow\",\"cat\":\"flow\",\"ph\":%s,\"id\":\"0x%llx\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u}"
+					, separator
+					, ProfilerEventType::FlowBegin == _event.m_type ? "\"s\"" : "\"f\",\"bp\":\"e\""
+					, (unsigned long long)_event.m_value
+					, ts
+					, m_pid
+					, _tid
+					);
+				break;
+
+			case ProfilerEventType::ThreadName:
+				len = snprintf(temp, sizeof(temp), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}"
+					, separator
+					, m_pid
+					, _tid
+					, name
+					);
+				break;
+
+			default:
+				return;
+			}
+
+			write(m_writer, temp, uint32_min(uint32_t(len), sizeof(temp)-1) );
+			++m_num;
+		}
+
+		/// Escapes JSON string, truncates if it doesn't fit.
+		static void escape(char* _dst, uint32_t _size, const char* _src)
+		{
+			static const char s_hex[] = "0123456789abcdef";
+
+			uint32_t pos = 0;
+			for (const char* ptr = NULL != _src ? _src : ""; '\0' != *ptr; ++ptr)
+			{
+				const uint8_t ch = uint8_t(*ptr);
+				char esc[7];
+				uint32_t len = 1;
+				esc[0] = char(ch);
+
+				if ('"' == ch
+				||  '\\' == ch)
+				{
+					esc[0] = '\\';
+					esc[1] = char(ch);
+					len = 2;
+				}
+				else if (0x20 > ch)
+				{
+					esc[0] = '\\';
+					esc[1] = 'u';
+					esc[2] = '0';
+					esc[3] = '0';
+					esc[4] = s_hex[ch>>4];
+					esc[5] = s_hex[ch&0xf];
+					len = 6;
+				}
+
+				if (pos + len >= _size)
+				{
+					break;
+				}
+
+				memcpy(&_dst[pos], esc, len);
+				pos += len;
+			}
+
+			_dst[pos] = '\0';
+		}
+
+		WriterI* m_writer;
+		int64_t m_baseTime;
+		double m_toUs;
+		uint32_t m_pid;
+		uint32_t m_num;
+	};
+
+} // namespace bx
+
+#endif // __BX_TRACEWRITER_H__
@@ -587,6 +587,16 @@ namespace bx
 		return _a < _b ? _b : _a;
 	}
 
+	inline uint64_t uint64_min(uint64_t _a, uint64_t _b)
+	{
+		return _a > _b ? _b : _a;
+	}
+
+	inline uint64_t uint64_max(uint64_t _a, uint64_t _b)
+	{
+		return _a < _b ? _b : _a;
+	}
+
 	inline uint64_t uint64_cntlz_ref(uint64_t _val)
 	{
 		return _val & UINT64_C(0xffffffff00000000)
@@ -599,7 +609,7 @@ namespace bx
 	inline uint64_t uint64_cntlz(uint64_t _val)
 	{
 #if BX_COMPILER_GCC
-		return __builtin_clz(_val);
+		return __builtin_clzll(_val);
 #elif BX_COMPILER_MSVC && BX_PLATFORM_WINDOWS && BX_ARCH_64BIT
 		unsigned long index;
 		_BitScanReverse64(&index, _val);
@@ -620,7 +630,7 @@ namespace bx
 	inline uint64_t uint64_cnttz(uint64_t _val)
 	{
 #if BX_COMPILER_GCC
-		return __builtin_ctz(_val);
+		return __builtin_ctzll(_val);
 #elif BX_COMPILER_MSVC && BX_PLATFORM_WINDOWS && BX_ARCH_64BIT
 		unsigned long index;
 		_BitScanForward64(&index, _val);
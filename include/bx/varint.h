@@ -0,0 +1,519 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BX_VARINT_H__
+#define __BX_VARINT_H__
+
+#include "bx.h"
+#include "cpu.h"
+#include "readerwriter.h"
+#include "uint32_t.h"
+
+#ifndef BX_CONFIG_VARINT_DISPATCH
+#	define BX_CONFIG_VARINT_DISPATCH BX_CONFIG_TARGET_DISPATCH
+#endif // BX_CONFIG_VARINT_DISPATCH
+
+#if BX_CONFIG_VARINT_DISPATCH
+#	include <immintrin.h>
+#endif // BX_CONFIG_VARINT_DISPATCH
+
+namespace bx
+{
+	/// Maps signed values to unsigned, so that small negative values
+	/// encode to small varints: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+	inline uint32_t toZigZag(int32_t _value)
+	{
+		return (uint32_t(_value)<<1) ^ uint32_t(_value>>31);
+	}
+
+	inline uint64_t toZigZag(int64_t _value)
+	{
+		return (uint64_t(_value)<<1) ^ uint64_t(_value>>63);
+	}
+
+	inline int32_t fromZigZag(uint32_t _value)
+	{
+		return int32_t(_value>>1) ^ -int32_t(_value&1);
+	}
+
+	inline int64_t fromZigZag(uint64_t _value)
+	{
+		return int64_t(_value>>1) ^ -int64_t(_value&1);
+	}
+
+	/// Number of bytes needed to encode _value as varint (1-10).
+	inline uint32_t varintSize(uint64_t _value)
+	{
+		const uint32_t bits = 64 - uint32_t(uint64_cntlz(_value|1) );
+		return (bits + 6)/7;
+	}
+
+	/// Encodes _value as unsigned LEB128, 7 bits per byte with high bit
+	/// set on all but last byte. Returns number of bytes written (1-10).
+	inline uint32_t varintEncode(uint8_t* _dst, uint64_t _value)
+	{
+		uint32_t size = 0;
+		while (0x80 <= _value)
+		{
+			_dst[size++] = uint8_t(_value | 0x80);
+			_value >>= 7;
+		}
+
+		_dst[size++] = uint8_t(_value);
+		return size;
+	}
+
+	/// Decodes unsigned LEB128. Returns number of bytes consumed, or 0 if
+	/// input is truncated or value doesn't fit.
+	inline uint32_t varintDecode(const uint8_t* _src, uint32_t _size, uint64_t& _value)
+	{
+		uint64_t value = 0;
+		for (uint32_t ii = 0, num = uint32_min(_size, 10); ii < num; ++ii)
+		{
+			const uint8_t byte = _src[ii];
+			value |= uint64_t(byte & 0x7f) << (ii*7);
+
+			if (0 == (byte & 0x80) )
+			{
+				if (9 == ii
+				&&  1 < byte)
+				{
+					return 0;
+				}
+
+				_value = value;
+				return ii+1;
+			}
+		}
+
+		return 0;
+	}
+
+	inline uint32_t varintDecode(const uint8_t* _src, uint32_t _size, uint32_t& _value)
+	{
+		uint32_t value = 0;
+		for (uint32_t ii = 0, num = uint32_min(_size, 5); ii < num; ++ii)
+		{
+			const uint8_t byte = _src[ii];
+			value |= uint32_t(byte & 0x7f) << (ii*7);
+
+			if (0 == (byte & 0x80) )
+			{
+				if (4 == ii
+				&&  0xf < byte)
+				{
+					return 0;
+				}
+
+				_value = value;
+				return ii+1;
+			}
+		}
+
+		return 0;
+	}
+
+	/// Write value as varint.
+	inline int32_t writeVarint(WriterI* _writer, uint64_t _value)
+	{
+		uint8_t temp[10];
+		const uint32_t size = varintEncode(temp, _value);
+		return _writer->write(temp, size);
+	}
+
+	/// Write signed value as zigzag varint.
+	inline int32_t writeZigZag(WriterI* _writer, int64_t _value)
+	{
+		return writeVarint(_writer, toZigZag(_value) );
+	}
+
+	/// Read varint. Returns number of bytes read, or 0 if stream ended or
+	/// value doesn't fit. Reads byte at a time, MemoryReader overload
+	/// decodes in place.
+	template<typename Ty>
+	inline int32_t readVarint(ReaderI* _reader, Ty& _value)
+	{
+		uint8_t temp[10];
+		for (uint32_t ii = 0; ii < BX_COUNTOF(temp); ++ii)
+		{
+			if (1 != _reader->read(&temp[ii], 1) )
+			{
+				return 0;
+			}
+
+			if (0 == (temp[ii] & 0x80) )
+			{
+				return int32_t(varintDecode(temp, ii+1, _value) );
+			}
+		}
+
+		return 0;
+	}
+
+	template<typename Ty>
+	inline int32_t readVarint(MemoryReader* _reader, Ty& _value)
+	{
+		const uint32_t size = uint32_t(int64_min(_reader->remaining(), UINT32_MAX) );
+		const uint32_t result = varintDecode(_reader->getDataPtr(), size, _value);
+		_reader->seek(result, Whence::Current);
+		return int32_t(result);
+	}
+
+	/// Read zigzag varint.
+	template<typename ReaderTy>
+	inline int32_t readZigZag(ReaderTy* _reader, int32_t& _value)
+	{
+		uint32_t value = 0;
+		const int32_t result = readVarint(_reader, value);
+		_value = 0 != result ? fromZigZag(value) : 0;
+		return result;
+	}
+
+	template<typename ReaderTy>
+	inline int32_t readZigZag(ReaderTy* _reader, int64_t& _value)
+	{
+		uint64_t value = 0;
+		const int32_t result = readVarint(_reader, value);
+		_value = 0 != result ? fromZigZag(value) : 0;
+		return result;
+	}
+
+	/// Size of buffer needed by deltaVarintEncode.
+	inline uint32_t deltaVarintEncodeBound(uint32_t _num, uint32_t _typeSize = sizeof(uint32_t) )
+	{
+		return _num*( (_typeSize*8 + 6)/7);
+	}
+
+	/// Encodes differences between consecutive values as zigzag varints.
+	/// First value is encoded relative to _base. Returns number of bytes
+	/// written, _dst must hold deltaVarintEncodeBound(_num) bytes.
+	inline uint32_t deltaVarintEncode(uint8_t* _dst, const uint32_t* _src, uint32_t _num, uint32_t _base = 0)
+	{
+		uint8_t* dst = _dst;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			dst += varintEncode(dst, toZigZag(int32_t(_src[ii] - _base) ) );
+			_base = _src[ii];
+		}
+
+		return uint32_t(dst - _dst);
+	}
+
+	inline uint32_t deltaVarintEncode(uint8_t* _dst, const uint64_t* _src, uint32_t _num, uint64_t _base = 0)
+	{
+		uint8_t* dst = _dst;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			dst += varintEncode(dst, toZigZag(int64_t(_src[ii] - _base) ) );
+			_base = _src[ii];
+		}
+
+		return uint32_t(dst - _dst);
+	}
+
+	/// Decodes _num values written by deltaVarintEncode. Returns number of
+	/// bytes consumed, or 0 if input is truncated or malformed.
+	inline uint32_t deltaVarintDecode(uint32_t* _dst, uint32_t _num, const uint8_t* _src, uint32_t _size, uint32_t _base = 0)
+	{
+		uint32_t pos = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint32_t value = 0;
+			const uint32_t size = varintDecode(&_src[pos], _size - pos, value);
+			if (0 == size)
+			{
+				return 0;
+			}
+
+			pos += size;
+			_base += uint32_t(fromZigZag(value) );
+			_dst[ii] = _base;
+		}
+
+		return pos;
+	}
+
+	inline uint32_t deltaVarintDecode(uint64_t* _dst, uint32_t _num, const uint8_t* _src, uint32_t _size, uint64_t _base = 0)
+	{
+		uint32_t pos = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint64_t value = 0;
+			const uint32_t size = varintDecode(&_src[pos], _size - pos, value);
+			if (0 == size)
+			{
+				return 0;
+			}
+
+			pos += size;
+			_base += uint64_t(fromZigZag(value) );
+			_dst[ii] = _base;
+		}
+
+		return pos;
+	}
+
+	/// Size of buffer needed by groupVarintEncode.
+	inline uint32_t groupVarintEncodeBound(uint32_t _num)
+	{
+		return (_num+3)/4*17;
+	}
+
+	/// Encodes values in groups of four. Each group starts with tag byte
+	/// holding 2-bit byte length of each value, followed by 1-4 little
+	/// endian bytes per value. Decoding doesn't branch per byte, and group
+	/// can be decoded with single byte shuffle. Last group is padded with
+	/// zeros. With _delta values are encoded as zigzag differences, first
+	/// relative to _base. Returns number of bytes written, _dst must hold
+	/// groupVarintEncodeBound(_num) bytes.
+	///
+	/// Group varint
+	/// http://static.googleusercontent.com/media/research.google.com/en//people/jeff/WSDM09-keynote.pdf
+	inline uint32_t groupVarintEncode(uint8_t* _dst, const uint32_t* _src, uint32_t _num, bool _delta = false, uint32_t _base = 0)
+	{
+		uint8_t* dst = _dst;
+		for (uint32_t ii = 0; ii < _num; ii += 4)
+		{
+			uint8_t* tag = dst++;
+			*tag = 0;
+
+			for (uint32_t jj = 0; jj < 4; ++jj)
+			{
+				uint32_t value = 0;
+				if (ii+jj < _num)
+				{
+					value = _src[ii+jj];
+					if (_delta)
+					{
+						const uint32_t delta = toZigZag(int32_t(value - _base) );
+						_base = value;
+						value = delta;
+					}
+				}
+
+				const uint32_t size = (32 - uint32_cntlz(value|1) + 7)/8;
+				*tag |= uint8_t( (size-1) << (jj*2) );
+
+				for (uint32_t kk = 0; kk < size; ++kk)
+				{
+					*dst++ = uint8_t(value >> (kk*8) );
+				}
+			}
+		}
+
+		return uint32_t(dst - _dst);
+	}
+
+	/// Decodes _num values written by groupVarintEncode. Returns number of
+	/// bytes consumed, or 0 if input is truncated.
+	typedef uint32_t (*GroupVarintDecodeFn)(uint32_t* _dst, uint32_t _num, const uint8_t* _src, uint32_t _size, bool _delta, uint32_t _base);
+
+	inline uint32_t groupVarintDecode_ref(uint32_t* _dst, uint32_t _num, const uint8_t* _src, uint32_t _size, bool _delta, uint32_t _base)
+	{
+		const uint8_t* src = _src;
+		const uint8_t* end = _src + _size;
+
+		for (uint32_t ii = 0; ii < _num; ii += 4)
+		{
+			if (src >= end)
+			{
+				return 0;
+			}
+
+			const uint32_t tag = *src++;
+
+			for (uint32_t jj = 0; jj < 4; ++jj)
+			{
+				const uint32_t size = ( (tag >> (jj*2) ) & 3) + 1;
+				if (size > uint32_t(end - src) )
+				{
+					return 0;
+				}
+
+				uint32_t value = 0;
+				for (uint32_t kk = 0; kk < size; ++kk)
+				{
+					value |= uint32_t(src[kk]) << (kk*8);
+				}
+				src += size;
+
+				if (ii+jj < _num)
+				{
+					if (_delta)
+					{
+						_base += uint32_t(fromZigZag(value) );
+						value = _base;
+					}
+
+					_dst[ii+jj] = value;
+				}
+			}
+		}
+
+		return uint32_t(src - _src);
+	}
+
+#if BX_CONFIG_VARINT_DISPATCH
+	/// Shuffle masks that move each value's bytes to its 32-bit lane,
+	/// and number of data bytes, for every tag.
+	struct GroupVarintTable
+	{
+		GroupVarintTable()
+		{
+			for (uint32_t tag = 0; tag < 256; ++tag)
+			{
+				uint8_t offset = 0;
+				for (uint32_t jj = 0; jj < 4; ++jj)
+				{
+					const uint8_t size = uint8_t( ( (tag >> (jj*2) ) & 3) + 1);
+					for (uint32_t kk = 0; kk < 4; ++kk)
+					{
+						m_shuffle[tag][jj*4+kk] = kk < size ? uint8_t(offset+kk) : 0x80;
+					}
+
+					offset = uint8_t(offset + size);
+				}
+
+				m_size[tag] = offset;
+			}
+		}
+
+		uint8_t m_shuffle[256][16];
+		uint8_t m_size[256];
+	};
+
+	inline const GroupVarintTable& groupVarintTable()
+	{
+		static const GroupVarintTable s_table;
+		return s_table;
+	}
+
+	/// Decodes group with single pshufb. Delta is decoded with two
+	/// shift-and-add prefix sum steps.
+	BX_TARGET("ssse3") inline uint32_t groupVarintDecode_ssse3(uint32_t* _dst, uint32_t _num, const uint8_t* _src, uint32_t _size, bool _delta, uint32_t _base)
+	{
+		const GroupVarintTable& table = groupVarintTable();
+		const __m128i one = _mm_set1_epi32(1);
+		__m128i prev = _mm_set1_epi32(int32_t(_base) );
+
+		const uint8_t* src = _src;
+		const uint8_t* end = _src + _size;
+		uint32_t ii = 0;
+
+		// Group is at most 17 bytes, unaligned load reads tag and 16
+		// bytes after it.
+		for (; ii+4 <= _num && 17 <= end - src; ii += 4)
+		{
+			const uint32_t tag = src[0];
+			const __m128i data    = _mm_loadu_si128( (const __m128i*)&src[1]);
+			const __m128i shuffle = _mm_loadu_si128( (const __m128i*)table.m_shuffle[tag]);
+			__m128i value = _mm_shuffle_epi8(data, shuffle);
+
+			if (_delta)
+			{
+				const __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, one) );
+				value = _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+				value = _mm_add_epi32(value, _mm_slli_si128(value, 4) );
+				value = _mm_add_epi32(value, _mm_slli_si128(value, 8) );
+				value = _mm_add_epi32(value, prev);
+				prev  = _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 3) );
+			}
+
+			_mm_storeu_si128( (__m128i*)&_dst[ii], value);
+			src += 1 + table.m_size[tag];
+		}
+
+		if (ii == _num)
+		{
+			return uint32_t(src - _src);
+		}
+
+		const uint32_t base = uint32_t(_mm_cvtsi128_si32(prev) );
+		const uint32_t size = groupVarintDecode_ref(&_dst[ii], _num-ii, src, uint32_t(end - src), _delta, base);
+		return 0 != size ? uint32_t(src - _src) + size : 0;
+	}
+#endif // BX_CONFIG_VARINT_DISPATCH
+
+	/// Returns best implementation for given CpuFeatures flags.
+	inline GroupVarintDecodeFn groupVarintDecode_select(uint32_t _features)
+	{
+#if BX_CONFIG_VARINT_DISPATCH
+		if (0 != (_features & CpuFeatures::Ssse3) )
+		{
+			return groupVarintDecode_ssse3;
+		}
+#else
+		BX_UNUSED(_features);
+#endif // BX_CONFIG_VARINT_DISPATCH
+
+		return groupVarintDecode_ref;
+	}
+
+	/// Decodes with best implementation for CPU, selected on first call.
+	inline uint32_t groupVarintDecode(uint32_t* _dst, uint32_t _num, const uint8_t* _src, uint32_t _size, bool _delta = false, uint32_t _base = 0)
+	{
+		static const GroupVarintDecodeFn s_fn = groupVarintDecode_select(cpuFeatures() );
+		return s_fn(_dst, _num, _src, _size, _delta, _base);
+	}
+
+	/// Writes array as delta varints, encoded in chunks with single write
+	/// per chunk.
+	template<typename Ty>
+	inline int32_t writeDeltaVarint(WriterI* _writer, const Ty* _src, uint32_t _num, Ty _base = 0)
+	{
+		uint8_t temp[256*(sizeof(Ty)*8 + 6)/7];
+
+		int32_t total = 0;
+		for (uint32_t ii = 0; ii < _num; ii += 256)
+		{
+			const uint32_t num  = uint32_min(256, _num-ii);
+			const uint32_t size = deltaVarintEncode(temp, &_src[ii], num, 0 == ii ? _base : _src[ii-1]);
+			total += _writer->write(temp, size);
+		}
+
+		return total;
+	}
+
+	/// Decodes delta varints in place from memory. Returns number of bytes
+	/// consumed, or 0 if input is truncated or malformed.
+	template<typename Ty>
+	inline int32_t readDeltaVarint(MemoryReader* _reader, Ty* _dst, uint32_t _num, Ty _base = 0)
+	{
+		const uint32_t size = uint32_t(int64_min(_reader->remaining(), UINT32_MAX) );
+		const uint32_t result = deltaVarintDecode(_dst, _num, _reader->getDataPtr(), size, _base);
+		_reader->seek(result, Whence::Current);
+		return int32_t(result);
+	}
+
+	/// Writes array as delta group varints, encoded in chunks with single
+	/// write per chunk.
+	inline int32_t writeDeltaGroupVarint(WriterI* _writer, const uint32_t* _src, uint32_t _num, uint32_t _base = 0)
+	{
+		uint8_t temp[256/4*17];
+
+		int32_t total = 0;
+		for (uint32_t ii = 0; ii < _num; ii += 256)
+		{
+			const uint32_t num  = uint32_min(256, _num-ii);
+			const uint32_t size = groupVarintEncode(temp, &_src[ii], num, true, 0 == ii ? _base : _src[ii-1]);
+			total += _writer->write(temp, size);
+		}
+
+		return total;
+	}
+
+	/// Decodes delta group varints in place from memory. Returns number of
+	/// bytes consumed, or 0 if input is truncated.
+	inline int32_t readDeltaGroupVarint(MemoryReader* _reader, uint32_t* _dst, uint32_t _num, uint32_t _base = 0)
+	{
+		const uint32_t size = uint32_t(int64_min(_reader->remaining(), UINT32_MAX) );
+		const uint32_t result = groupVarintDecode(_dst, _num, _reader->getDataPtr(), size, true, _base);
+		_reader->seek(result, Whence::Current);
+		return int32_t(result);
+	}
+
+} // namespace bx
+
+#endif // __BX_VARINT_H__
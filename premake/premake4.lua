@@ -52,3 +52,23 @@ project "bx.test"
 		BX_DIR .. "tests/**.cpp",
 		BX_DIR .. "tests/**.H",
 	}
+
+	excludes {
+		BX_DIR .. "tests/bench.*",
+		BX_DIR .. "tests/*_bench.cpp",
+	}
+
+project "bx.bench"
+	uuid "6b1b8f6e-5f0a-11e6-8b77-86f30ca893d3"
+	kind "ConsoleApp"
+
+	debugdir (BX_DIR .. "tests")
+
+	includedirs {
+		BX_DIR .. "include",
+	}
+
+	files {
+		BX_DIR .. "tests/bench.*",
+		BX_DIR .. "tests/*_bench.cpp",
+	}
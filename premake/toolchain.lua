@@ -279,6 +279,8 @@ function toolchain(_buildDir, _libDir)
 		}
 		links {
 			"rt",
+			"dl",
+			"pthread",
 		}
 		linkoptions {
 			"-Wl,--gc-sections",
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/asyncfileio.h>
+#include <bx/os.h>
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+TEST(async_file_io)
+{
+	static const char* s_filePath = "async_file_io.bin";
+
+	uint32_t data[4096];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(data); ++ii)
+	{
+		data[ii] = ii*2654435761u;
+	}
+
+	bx::FdFileWriter writer;
+	CHECK_EQUAL(0, bx::open(&writer, s_filePath) );
+	CHECK_EQUAL(int32_t(sizeof(data) ), bx::write(&writer, data, sizeof(data) ) );
+	bx::close(&writer);
+
+	bx::FdFileReader reader;
+	CHECK_EQUAL(0, bx::open(&reader, s_filePath) );
+
+	// Queue holds less than number of requests, so submit has to be
+	// retried as requests complete.
+	bx::AsyncFileIo io(16);
+	io.init(4);
+
+	enum { NumRequests = 64 };
+	bx::AsyncFileIoRequest requests[NumRequests];
+	bx::AsyncFileIoRequest* pending[NumRequests];
+	uint32_t values[NumRequests];
+
+	for (uint32_t ii = 0; ii < NumRequests; ++ii)
+	{
+		bx::AsyncFileIoRequest& request = requests[ii];
+		request.m_filePath = 0 == (ii & 1) ? s_filePath : NULL;
+		request.m_fd       = reader.getFd();
+		request.m_offset   = ii*64*sizeof(uint32_t);
+		request.m_data     = &values[ii];
+		request.m_size     = sizeof(uint32_t);
+		request.m_userData = &data[ii*64];
+		pending[ii] = &request;
+	}
+
+	uint32_t numSubmitted = 0;
+	uint32_t numCompleted = 0;
+	while (numCompleted < NumRequests)
+	{
+		numSubmitted += io.submit(&pending[numSubmitted], NumRequests - numSubmitted);
+		CHECK(io.getNumInFlight() <= 16);
+
+		bx::AsyncFileIoRequest* request = io.wait();
+		CHECK(NULL != request);
+		CHECK_EQUAL(int32_t(sizeof(uint32_t) ), request->m_result);
+		CHECK_EQUAL(*(uint32_t*)request->m_userData, *(uint32_t*)request->m_data);
+		++numCompleted;
+	}
+
+	CHECK_EQUAL(0u, io.getNumInFlight() );
+	CHECK(NULL == io.poll() );
+	CHECK(NULL == io.wait(1) );
+
+	// Missing file, and read past end of file.
+	bx::AsyncFileIoRequest missing;
+	missing.m_filePath = "async_file_io_missing.bin";
+	missing.m_data     = &values[0];
+	missing.m_size     = sizeof(uint32_t);
+
+	bx::AsyncFileIoRequest eof;
+	eof.m_fd     = reader.getFd();
+	eof.m_offset = sizeof(data) - 2;
+	eof.m_data   = &values[1];
+	eof.m_size   = sizeof(uint32_t);
+
+	bx::AsyncFileIoRequest* batch[] = { &missing, &eof };
+	CHECK_EQUAL(2u, io.submit(batch, BX_COUNTOF(batch) ) );
+
+	// Shutdown finishes submitted requests.
+	io.shutdown();
+	CHECK(NULL != io.poll() );
+	CHECK(NULL != io.poll() );
+	CHECK(NULL == io.poll() );
+	CHECK_EQUAL(-1, missing.m_result);
+	CHECK_EQUAL(2, eof.m_result);
+
+	bx::close(&reader);
+	remove(s_filePath);
+}
+
+struct AsyncFileIoSubmitTest
+{
+	enum { NumThreads = 4, NumRequests = 256 };
+
+	struct Submitter
+	{
+		AsyncFileIoSubmitTest* m_test;
+		bx::AsyncFileIoRequest m_request[NumRequests];
+		uint32_t m_value[NumRequests];
+	};
+
+	bx::AsyncFileIo m_io;
+	Submitter m_submitter[NumThreads];
+	volatile bool m_abort;
+
+	AsyncFileIoSubmitTest()
+		: m_io(16)
+		, m_abort(false)
+	{
+	}
+
+	static int32_t submitter(void* _userData)
+	{
+		Submitter* submitter = (Submitter*)_userData;
+
+		for (uint32_t ii = 0; ii < NumRequests; ++ii)
+		{
+			while (!submitter->m_test->m_io.submit(&submitter->m_request[ii]) )
+			{
+				if (submitter->m_test->m_abort)
+				{
+					return 1;
+				}
+
+				bx::yield();
+			}
+		}
+
+		return 0;
+	}
+};
+
+TEST(async_file_io_submit_threads)
+{
+	static const char* s_filePath = "async_file_io_threads.bin";
+
+	uint32_t data[AsyncFileIoSubmitTest::NumRequests];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(data); ++ii)
+	{
+		data[ii] = ii*2654435761u;
+	}
+
+	bx::FdFileWriter writer;
+	CHECK_EQUAL(0, bx::open(&writer, s_filePath) );
+	CHECK_EQUAL(int32_t(sizeof(data) ), bx::write(&writer, data, sizeof(data) ) );
+	bx::close(&writer);
+
+	bx::FdFileReader reader;
+	CHECK_EQUAL(0, bx::open(&reader, s_filePath) );
+
+	AsyncFileIoSubmitTest* test = new AsyncFileIoSubmitTest;
+	test->m_io.init(4);
+
+	for (uint32_t ii = 0; ii < AsyncFileIoSubmitTest::NumThreads; ++ii)
+	{
+		AsyncFileIoSubmitTest::Submitter& submitter = test->m_submitter[ii];
+		submitter.m_test = test;
+
+		for (uint32_t jj = 0; jj < AsyncFileIoSubmitTest::NumRequests; ++jj)
+		{
+			bx::AsyncFileIoRequest& request = submitter.m_request[jj];
+			request.m_fd       = reader.getFd();
+			request.m_offset   = jj*sizeof(uint32_t);
+			request.m_data     = &submitter.m_value[jj];
+			request.m_size     = sizeof(uint32_t);
+			request.m_userData = &data[jj];
+		}
+	}
+
+	// Several threads submit at once, while completions are drained
+	// here. Every request must come back exactly once.
+	bx::Thread thread[AsyncFileIoSubmitTest::NumThreads];
+	for (uint32_t ii = 0; ii < AsyncFileIoSubmitTest::NumThreads; ++ii)
+	{
+		thread[ii].init(AsyncFileIoSubmitTest::submitter, &test->m_submitter[ii]);
+	}
+
+	uint32_t numCompleted = 0;
+	for (; numCompleted < AsyncFileIoSubmitTest::NumThreads*AsyncFileIoSubmitTest::NumRequests; ++numCompleted)
+	{
+		bx::AsyncFileIoRequest* request = test->m_io.wait(10000);
+		if (NULL == request)
+		{
+			test->m_abort = true;
+			break;
+		}
+
+		CHECK_EQUAL(int32_t(sizeof(uint32_t) ), request->m_result);
+		CHECK_EQUAL(*(uint32_t*)request->m_userData, *(uint32_t*)request->m_data);
+	}
+
+	for (uint32_t ii = 0; ii < AsyncFileIoSubmitTest::NumThreads; ++ii)
+	{
+		thread[ii].shutdown();
+	}
+
+	CHECK_EQUAL(uint32_t(AsyncFileIoSubmitTest::NumThreads*AsyncFileIoSubmitTest::NumRequests), numCompleted);
+	CHECK_EQUAL(0u, test->m_io.getNumInFlight() );
+
+	test->m_io.shutdown();
+	CHECK(NULL == test->m_io.poll() );
+
+	delete test;
+
+	bx::close(&reader);
+	remove(s_filePath);
+}
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
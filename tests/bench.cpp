@@ -0,0 +1,22 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+
+int main()
+{
+	mutexBench();
+	parallelBench();
+	cpuBench();
+	profilerBench();
+	histogramBench();
+	readerWriterBench();
+	varintBench();
+	endianBench();
+	lz4Bench();
+	hashBench();
+
+	return 0;
+}
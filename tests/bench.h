@@ -0,0 +1,24 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <bx/bx.h>
+#include <bx/timer.h>
+#include <stdio.h>
+
+void mutexBench();
+void parallelBench();
+void cpuBench();
+void profilerBench();
+void histogramBench();
+void readerWriterBench();
+void varintBench();
+void endianBench();
+void lz4Bench();
+void hashBench();
+
+#endif // __BENCH_H__
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/cpu.h>
+#include <bx/float4x4_array.h>
+#include <bx/ringbuffer.h>
+
+TEST(atomic)
+{
+	bx::Atomic<int32_t> i32;
+	CHECK_EQUAL(0, i32.load() );
+	i32.store(5, bx::MemoryOrder::Release);
+	CHECK_EQUAL(5, i32.load(bx::MemoryOrder::Acquire) );
+	CHECK_EQUAL(5, i32.fetchAdd(3) );
+	CHECK_EQUAL(8, i32.fetchSub(1, bx::MemoryOrder::AcqRel) );
+	CHECK_EQUAL(7, i32.fetchOr(0x10, bx::MemoryOrder::Relaxed) );
+	CHECK_EQUAL(0x17, i32.fetchAnd(0x0f) );
+	CHECK_EQUAL(7, i32.exchange(1, bx::MemoryOrder::Acquire) );
+
+	int32_t expected = 2;
+	CHECK(!i32.compareExchange(expected, 3) );
+	CHECK_EQUAL(1, expected);
+	CHECK(i32.compareExchange(expected, 3, bx::MemoryOrder::AcqRel) );
+	CHECK_EQUAL(3, i32.load(bx::MemoryOrder::Relaxed) );
+
+	bx::Atomic<uint64_t> u64(UINT64_C(0x100000000) );
+	CHECK_EQUAL(UINT64_C(0x100000000), u64.fetchAdd(1) );
+	CHECK_EQUAL(UINT64_C(0x100000001), u64.load() );
+
+	int32_t value[2];
+	bx::Atomic<int32_t*> ptr;
+	CHECK(NULL == ptr.load() );
+	CHECK(NULL == ptr.exchange(&value[0]) );
+
+	int32_t* expectedPtr = &value[0];
+	CHECK(ptr.compareExchange(expectedPtr, &value[1]) );
+	CHECK(&value[1] == ptr.load(bx::MemoryOrder::Acquire) );
+
+	uint32_t plain = 0;
+	bx::atomicStore(&plain, 42u, bx::MemoryOrder::Release);
+	CHECK_EQUAL(42u, bx::atomicLoad(&plain, bx::MemoryOrder::Acquire) );
+	bx::atomicFence(bx::MemoryOrder::SeqCst);
+}
+
+TEST(cpu_features)
+{
+	const uint32_t features = bx::cpuFeatures();
+	CHECK_EQUAL(features, bx::cpuFeaturesDetect() );
+
+#if BX_CPU_X86 && BX_ARCH_64BIT
+	CHECK(0 != (features & bx::CpuFeatures::Sse2) );
+#endif // BX_CPU_X86 && BX_ARCH_64BIT
+
+	if (0 != (features & bx::CpuFeatures::Avx2) )
+	{
+		CHECK(0 != (features & bx::CpuFeatures::Avx) );
+	}
+}
+
+TEST(float4_mul_array)
+{
+	bx::float4x4_t mtx;
+	float* m = (float*)&mtx;
+	for (uint32_t ii = 0; ii < 16; ++ii)
+	{
+		m[ii] = float(ii) - 4.0f;
+	}
+
+	BX_ALIGN_STRUCT_16(float) vec[11*4];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(vec); ++ii)
+	{
+		vec[ii] = float(ii%7) * 0.5f;
+	}
+
+	BX_ALIGN_STRUCT_16(float) expected[11*4];
+	for (uint32_t ii = 0; ii < 11; ++ii)
+	{
+		for (uint32_t jj = 0; jj < 4; ++jj)
+		{
+			expected[ii*4+jj] = m[0*4+jj]*vec[ii*4+0]
+				+ m[1*4+jj]*vec[ii*4+1]
+				+ m[2*4+jj]*vec[ii*4+2]
+				+ m[3*4+jj]*vec[ii*4+3]
+				;
+		}
+	}
+
+	const uint32_t features[] =
+	{
+		0,
+		bx::CpuFeatures::Avx,
+		bx::CpuFeatures::Avx|bx::CpuFeatures::Fma,
+		bx::CpuFeatures::Avx|bx::CpuFeatures::Fma|bx::CpuFeatures::Avx512F,
+	};
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(features); ++ii)
+	{
+		if (features[ii] != (bx::cpuFeatures() & features[ii]) )
+		{
+			continue;
+		}
+
+		bx::Float4MulArrayFn fn = bx::float4_mul_array_select(features[ii]);
+
+		for (uint32_t num = 0; num <= 11; ++num)
+		{
+			BX_ALIGN_STRUCT_16(float) result[11*4] = {};
+			fn(result, vec, num, mtx);
+
+			for (uint32_t jj = 0; jj < num*4; ++jj)
+			{
+				CHECK_CLOSE(expected[jj], result[jj], 0.0001f);
+			}
+
+			for (uint32_t jj = num*4; jj < BX_COUNTOF(result); ++jj)
+			{
+				CHECK_EQUAL(0.0f, result[jj]);
+			}
+		}
+	}
+
+	BX_ALIGN_STRUCT_16(float) result[11*4];
+	bx::float4_mul_array(result, vec, 11, mtx);
+	CHECK_ARRAY_CLOSE(expected, result, 11*4, 0.0001f);
+}
+
+TEST(cache_line)
+{
+	bx::CacheLinePadded<uint32_t> padded[2];
+	CHECK_EQUAL(size_t(BX_CACHE_LINE_SIZE), sizeof(padded[0]) );
+	CHECK(!bx::isSameCacheLine(&padded[0].m_value, &padded[1].m_value) );
+
+	uint32_t pair[2];
+	CHECK(bx::isSameCacheLine(&pair[0], &pair[0]) );
+
+	// Heap allocation is only 16 byte aligned, check every such
+	// placement within line.
+	bx::SpScRingBufferControl control(16);
+	const uintptr_t write = uintptr_t(&control.m_write) - uintptr_t(&control);
+	const uintptr_t read  = uintptr_t(&control.m_read.m_value) - uintptr_t(&control);
+
+	for (uintptr_t offset = 0; offset < BX_CACHE_LINE_SIZE; offset += 16)
+	{
+		CHECK(!bx::isSameCacheLine( (const void*)(offset + write + sizeof(uint32_t) - 1), (const void*)(offset + read) ) );
+		CHECK(!bx::isSameCacheLine( (const void*)(offset + read + sizeof(uint32_t) - 1), (const void*)(offset + sizeof(control) ) ) );
+	}
+
+	bx::prefetchRead(&padded[0], bx::PrefetchLocality::None);
+	bx::prefetchRead(&padded[1]);
+	bx::prefetchWrite(&padded[0], bx::PrefetchLocality::Moderate);
+	bx::prefetchWrite(&pair[1], bx::PrefetchLocality::Low);
+}
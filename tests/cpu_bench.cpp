@@ -0,0 +1,71 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/float4x4_array.h>
+
+static const uint32_t s_numVectors = 1<<20;
+static BX_ALIGN_STRUCT_16(float) s_vec[s_numVectors*4];
+
+void cpuBench()
+{
+	const uint32_t features = bx::cpuFeatures();
+	printf("CPU features: 0x%04x\n", features);
+	printf("float4_mul_array over %d vectors, ms (speedup), best of 10:\n", s_numVectors);
+
+	bx::float4x4_t mtx;
+	float* m = (float*)&mtx;
+	for (uint32_t ii = 0; ii < 16; ++ii)
+	{
+		m[ii] = 0.25f*float(ii&3) + (0 == ii%5 ? 1.0f : 0.0f);
+	}
+
+	struct Impl
+	{
+		const char* name;
+		uint32_t features;
+	};
+
+	const Impl impl[] =
+	{
+		{ "ref",    0 },
+		{ "avx",    bx::CpuFeatures::Avx },
+		{ "fma",    bx::CpuFeatures::Avx|bx::CpuFeatures::Fma },
+		{ "avx512", bx::CpuFeatures::Avx|bx::CpuFeatures::Fma|bx::CpuFeatures::Avx512F },
+	};
+
+	double base = 0.0;
+	for (uint32_t ii = 0; ii < BX_COUNTOF(impl); ++ii)
+	{
+		if (impl[ii].features != (features & impl[ii].features) )
+		{
+			printf("%-8s%14s\n", impl[ii].name, "n/a");
+			continue;
+		}
+
+		bx::Float4MulArrayFn fn = bx::float4_mul_array_select(impl[ii].features);
+
+		for (uint32_t jj = 0; jj < s_numVectors*4; ++jj)
+		{
+			s_vec[jj] = float(jj&0xff);
+		}
+
+		int64_t best = INT64_MAX;
+		for (uint32_t run = 0; run < 10; ++run)
+		{
+			const int64_t start = bx::getHPCounter();
+			fn(s_vec, s_vec, s_numVectors, mtx);
+			const int64_t elapsed = bx::getHPCounter() - start;
+			best = elapsed < best ? elapsed : best;
+		}
+
+		const double ms = double(best)*1000.0/double(bx::getHPFrequency() );
+		base = 0 == ii ? ms : base;
+
+		printf("%-8s%14.2f (%4.1fx)\n", impl[ii].name, ms, base/ms);
+	}
+
+	printf("\n");
+}
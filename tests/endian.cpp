@@ -0,0 +1,101 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/endian.h>
+#include <bx/readerwriter.h>
+
+TEST(endian_swap_array)
+{
+	// Odd sizes and offsets exercise unaligned access and scalar tail.
+	enum { Num = 67 };
+
+	uint8_t src[Num*8+1];
+	uint8_t dst[Num*8+1];
+	for (uint32_t ii = 0; ii < sizeof(src); ++ii)
+	{
+		src[ii] = uint8_t(ii*7+1);
+	}
+
+	const uint32_t features = bx::cpuFeatures();
+	const bx::EndianSwapArray16Fn fn16[] = { bx::endianSwapArray16_ref, bx::endianSwapArray16_select(features), bx::endianSwapArray16_select(features & ~bx::CpuFeatures::Avx2), bx::endianSwapArray16 };
+	const bx::EndianSwapArray32Fn fn32[] = { bx::endianSwapArray32_ref, bx::endianSwapArray32_select(features), bx::endianSwapArray32_select(features & ~bx::CpuFeatures::Avx2), bx::endianSwapArray32 };
+	const bx::EndianSwapArray64Fn fn64[] = { bx::endianSwapArray64_ref, bx::endianSwapArray64_select(features), bx::endianSwapArray64_select(features & ~bx::CpuFeatures::Avx2), bx::endianSwapArray64 };
+
+	uint8_t expected[Num*8+1];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(fn16); ++ii)
+	{
+		for (uint32_t num = 0; num <= Num; num += 11)
+		{
+			// Compare with scalar swap, and check tail is not touched.
+			memset(dst, 0, sizeof(dst) );
+			fn16[ii]( (uint16_t*)&dst[1], (const uint16_t*)&src[1], num*4);
+			for (uint32_t jj = 0; jj < num*4; ++jj)
+			{
+				uint16_t value;
+				memcpy(&value, &src[1+jj*2], 2);
+				value = bx::endianSwap(value);
+				memcpy(&expected[1+jj*2], &value, 2);
+			}
+			CHECK_EQUAL(0, memcmp(&expected[1], &dst[1], num*8) );
+			CHECK_EQUAL(0, dst[num*8+1 < sizeof(dst) ? num*8+1 : 0]);
+
+			fn32[ii]( (uint32_t*)&dst[1], (const uint32_t*)&src[1], num*2);
+			for (uint32_t jj = 0; jj < num*2; ++jj)
+			{
+				uint32_t value;
+				memcpy(&value, &src[1+jj*4], 4);
+				value = bx::endianSwap(value);
+				memcpy(&expected[1+jj*4], &value, 4);
+			}
+			CHECK_EQUAL(0, memcmp(&expected[1], &dst[1], num*8) );
+
+			fn64[ii]( (uint64_t*)&dst[1], (const uint64_t*)&src[1], num);
+			for (uint32_t jj = 0; jj < num; ++jj)
+			{
+				uint64_t value;
+				memcpy(&value, &src[1+jj*8], 8);
+				value = bx::endianSwap(value);
+				memcpy(&expected[1+jj*8], &value, 8);
+			}
+			CHECK_EQUAL(0, memcmp(&expected[1], &dst[1], num*8) );
+
+			// In place swap twice is identity.
+			fn64[ii]( (uint64_t*)&dst[1], (const uint64_t*)&dst[1], num);
+			CHECK_EQUAL(0, memcmp(&src[1], &dst[1], num*8) );
+		}
+	}
+
+	int16_t values[3] = { 0x0102, -2, 0x7f00 };
+	bx::endianSwapArray(values, values, BX_COUNTOF(values) );
+	CHECK_EQUAL(0x0201, values[0]);
+	CHECK_EQUAL(int16_t(0xfeff), values[1]);
+	CHECK_EQUAL(0x007f, values[2]);
+}
+
+TEST(endian_reader_writer_array)
+{
+	uint32_t values[1500];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(values); ++ii)
+	{
+		values[ii] = ii*2654435761u;
+	}
+
+	static uint8_t data[sizeof(values)*2];
+	bx::StaticMemoryBlockWriter writer(data, sizeof(data) );
+	CHECK_EQUAL(int32_t(sizeof(values) ), bx::writeBE(&writer, values, BX_COUNTOF(values) ) );
+	CHECK_EQUAL(int32_t(sizeof(values) ), bx::writeLE(&writer, values, BX_COUNTOF(values) ) );
+
+	const uint8_t* be = data;
+	CHECK_EQUAL(values[1] >> 24, uint32_t(be[4]) );
+	CHECK_EQUAL(values[1] & 0xff, uint32_t(be[7]) );
+
+	uint32_t result[BX_COUNTOF(values)];
+	bx::MemoryReader reader(data, sizeof(data) );
+	CHECK_EQUAL(int32_t(sizeof(result) ), bx::readHE(&reader, result, BX_COUNTOF(result), false) );
+	CHECK_EQUAL(0, memcmp(values, result, sizeof(values) ) );
+	CHECK_EQUAL(int32_t(sizeof(result) ), bx::readHE(&reader, result, BX_COUNTOF(result), true) );
+	CHECK_EQUAL(0, memcmp(values, result, sizeof(values) ) );
+}
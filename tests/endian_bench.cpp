@@ -0,0 +1,49 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/endian.h>
+
+static const uint32_t s_numValues = 1<<16;
+static uint16_t s_data[s_numValues*4];
+
+template<typename Ty, typename FnTy>
+static double bench(FnTy _fn, uint32_t _num)
+{
+	int64_t best = INT64_MAX;
+	for (uint32_t run = 0; run < 100; ++run)
+	{
+		const int64_t start = bx::getHPCounter();
+		_fn( (Ty*)s_data, (const Ty*)s_data, _num);
+		const int64_t elapsed = bx::getHPCounter() - start;
+		best = elapsed < best ? elapsed : best;
+	}
+
+	return double(best)*1.0e9/double(bx::getHPFrequency() )/double(sizeof(s_data) );
+}
+
+void endianBench()
+{
+	const uint32_t features = bx::cpuFeatures();
+	const uint32_t ssse3 = features & ~bx::CpuFeatures::Avx2;
+
+	printf("Endian swap %d KB in place, ns per byte:\n", int(sizeof(s_data)/1024) );
+	printf("%-8s %8s %8s %8s\n", "", "ref", "ssse3", "best");
+	printf("%-8s %8.3f %8.3f %8.3f\n", "16-bit"
+		, bench<uint16_t>(bx::endianSwapArray16_ref, s_numValues*4)
+		, bench<uint16_t>(bx::endianSwapArray16_select(ssse3), s_numValues*4)
+		, bench<uint16_t>(bx::endianSwapArray16_select(features), s_numValues*4)
+		);
+	printf("%-8s %8.3f %8.3f %8.3f\n", "32-bit"
+		, bench<uint32_t>(bx::endianSwapArray32_ref, s_numValues*2)
+		, bench<uint32_t>(bx::endianSwapArray32_select(ssse3), s_numValues*2)
+		, bench<uint32_t>(bx::endianSwapArray32_select(features), s_numValues*2)
+		);
+	printf("%-8s %8.3f %8.3f %8.3f\n", "64-bit"
+		, bench<uint64_t>(bx::endianSwapArray64_ref, s_numValues)
+		, bench<uint64_t>(bx::endianSwapArray64_select(ssse3), s_numValues)
+		, bench<uint64_t>(bx::endianSwapArray64_select(features), s_numValues)
+		);
+}
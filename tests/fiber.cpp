@@ -0,0 +1,168 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/fiber.h>
+
+#if BX_CONFIG_SUPPORTS_FIBER
+
+struct FiberYield
+{
+	static void fn(void* _userData)
+	{
+		FiberYield* test = (FiberYield*)_userData;
+		for (uint32_t ii = 0; ii < 3; ++ii)
+		{
+			test->m_value = ii;
+			test->m_fiber->yield();
+		}
+
+		test->m_value = 100;
+	}
+
+	bx::Fiber* m_fiber;
+	uint32_t m_value;
+};
+
+TEST(fiber)
+{
+	bx::FiberStack stack;
+	CHECK(bx::fiberStackAlloc(stack, 16<<10) );
+
+	bx::Fiber fiber;
+	FiberYield test;
+	test.m_fiber = &fiber;
+	test.m_value = 0;
+
+	for (uint32_t run = 0; run < 2; ++run)
+	{
+		fiber.init(FiberYield::fn, &test, stack);
+
+		for (uint32_t ii = 0; ii < 3; ++ii)
+		{
+			fiber.resume();
+			CHECK(!fiber.isDone() );
+			CHECK_EQUAL(ii, test.m_value);
+		}
+
+		fiber.resume();
+		CHECK(fiber.isDone() );
+		CHECK_EQUAL(100u, test.m_value);
+	}
+
+	bx::fiberStackFree(stack);
+}
+
+struct FiberFib
+{
+	static void fn(void* _userData)
+	{
+		FiberFib* job = (FiberFib*)_userData;
+
+		if (job->m_n < 2)
+		{
+			job->m_result = job->m_n;
+			return;
+		}
+
+		FiberFib child[2] =
+		{
+			{ job->m_scheduler, job->m_n-1, 0 },
+			{ job->m_scheduler, job->m_n-2, 0 },
+		};
+
+		bx::JobCounter counter;
+		job->m_scheduler->submit(fn, &child[0], &counter);
+		job->m_scheduler->submit(fn, &child[1], &counter);
+		job->m_scheduler->wait(&counter);
+
+		job->m_result = child[0].m_result + child[1].m_result;
+	}
+
+	bx::FiberScheduler* m_scheduler;
+	uint32_t m_n;
+	uint32_t m_result;
+};
+
+TEST(fiber_scheduler)
+{
+	bx::JobSystem js;
+	js.init(3);
+
+	bx::FiberScheduler scheduler;
+	CHECK(scheduler.init(&js, 64, 32<<10) );
+	CHECK(!scheduler.isFiber() );
+
+	// More waits in flight than fibers, rest falls back to blocking jobs.
+	for (uint32_t ii = 0; ii < 3; ++ii)
+	{
+		FiberFib job = { &scheduler, 16, 0 };
+		bx::JobCounter counter;
+		scheduler.submit(FiberFib::fn, &job, &counter);
+		scheduler.wait(&counter);
+		CHECK(counter.isDone() );
+		CHECK_EQUAL(987u, job.m_result);
+	}
+
+	scheduler.shutdown();
+	js.shutdown();
+}
+
+struct FiberWaitShared
+{
+	enum { NumFibers = 16 };
+
+	static void fn(void* _userData)
+	{
+		FiberWaitShared* test = (FiberWaitShared*)_userData;
+		test->m_numWaiting.fetchAdd(1);
+		test->m_scheduler->wait(&test->m_gate);
+		test->m_numResumed.fetchAdd(1);
+	}
+
+	bx::FiberScheduler* m_scheduler;
+	bx::JobCounter m_gate;
+	bx::Atomic<uint32_t> m_numWaiting;
+	bx::Atomic<uint32_t> m_numResumed;
+};
+
+TEST(fiber_scheduler_shared_counter)
+{
+	bx::JobSystem js;
+	js.init(3);
+
+	bx::FiberScheduler scheduler;
+	CHECK(scheduler.init(&js, FiberWaitShared::NumFibers) );
+
+	// Several fibers suspended on the same counter, all must be resumed
+	// when it's released.
+	FiberWaitShared test;
+	test.m_scheduler = &scheduler;
+	js.retain(&test.m_gate);
+
+	bx::JobCounter counter;
+	for (uint32_t ii = 0; ii < FiberWaitShared::NumFibers; ++ii)
+	{
+		scheduler.submit(FiberWaitShared::fn, &test, &counter);
+	}
+
+	while (uint32_t(FiberWaitShared::NumFibers) != test.m_numWaiting.load() )
+	{
+		bx::yield();
+	}
+
+	bx::sleep(10);
+	CHECK_EQUAL(0u, test.m_numResumed.load() );
+
+	js.release(&test.m_gate);
+	scheduler.wait(&counter);
+	CHECK(test.m_gate.isDone() );
+	CHECK_EQUAL(uint32_t(FiberWaitShared::NumFibers), test.m_numResumed.load() );
+
+	scheduler.shutdown();
+	js.shutdown();
+}
+
+#endif // BX_CONFIG_SUPPORTS_FIBER
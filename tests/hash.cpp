@@ -0,0 +1,69 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/hash.h>
+#include <bx/rng.h>
+
+TEST(crc32c)
+{
+	// RFC 3720, B.4. CRC Examples
+	uint8_t data[48];
+	memset(data, 0, 32);
+	CHECK_EQUAL(0x8a9136aau, bx::crc32c(0, data, 32) );
+	CHECK_EQUAL(0x8a9136aau, bx::crc32c_ref(0, data, 32) );
+
+	memset(data, 0xff, 32);
+	CHECK_EQUAL(0x62a8ab43u, bx::crc32c(0, data, 32) );
+
+	for (uint32_t ii = 0; ii < 32; ++ii)
+	{
+		data[ii] = uint8_t(ii);
+	}
+	CHECK_EQUAL(0x46dd794eu, bx::crc32c(0, data, 32) );
+
+	CHECK_EQUAL(0xe3069283u, bx::crc32c(0, "123456789", 9) );
+	CHECK_EQUAL(0xe3069283u, bx::hashCrc32c("123456789", 9) );
+	CHECK_EQUAL(0u, bx::crc32c(0, data, 0) );
+
+	bx::HashCrc32c hash;
+	hash.begin();
+	hash.add("1234", 4);
+	hash.add("56789", 5);
+	CHECK_EQUAL(0xe3069283u, hash.end() );
+}
+
+TEST(crc32c_select)
+{
+	// Covers unaligned head, interleaved long and short blocks, and tail.
+	static const uint32_t s_size = 3*bx::Crc32c::LongBlock*2 + 3*bx::Crc32c::ShortBlock + 100;
+	uint8_t* data = new uint8_t[s_size];
+
+	bx::RngMwc rng;
+	for (uint32_t ii = 0; ii < s_size; ++ii)
+	{
+		data[ii] = uint8_t(rng.gen() );
+	}
+
+	const bx::Crc32cFn fn = bx::crc32c_select(bx::cpuFeatures() );
+
+	for (uint32_t offset = 0; offset < 9; ++offset)
+	{
+		const uint32_t size = s_size - offset - rng.gen()%64;
+		const uint32_t ref = bx::crc32c_ref(0, &data[offset], size);
+		CHECK_EQUAL(ref, fn(0, &data[offset], size) );
+
+		// Split at random point.
+		const uint32_t split = rng.gen()%size;
+		CHECK_EQUAL(ref, fn(bx::crc32c_ref(0, &data[offset], split), &data[offset+split], size-split) );
+	}
+
+	for (uint32_t size = 0; size < 1000; ++size)
+	{
+		CHECK_EQUAL(bx::crc32c_ref(0x12345678, data, size), fn(0x12345678, data, size) );
+	}
+
+	delete [] data;
+}
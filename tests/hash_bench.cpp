@@ -0,0 +1,95 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/hash.h>
+#include <bx/readerwriter.h>
+
+static const uint32_t s_size = 16<<20;
+static uint8_t s_data[s_size];
+static uint8_t s_result[s_size];
+
+typedef uint32_t (*HashFn)(const void* _data, uint32_t _size);
+
+static uint32_t murmur(const void* _data, uint32_t _size)
+{
+	return bx::hashMurmur2A(_data, _size);
+}
+
+static uint32_t crcRef(const void* _data, uint32_t _size)
+{
+	return bx::crc32c_ref(0, _data, _size);
+}
+
+static uint32_t crc(const void* _data, uint32_t _size)
+{
+	return bx::crc32c(0, _data, _size);
+}
+
+// Reads whole data in 64KB chunks, like streaming deserializer would.
+static uint32_t read(const void* _data, uint32_t _size)
+{
+	bx::MemoryReader reader(_data, _size);
+	for (uint32_t ii = 0; ii < _size; ii += 64<<10)
+	{
+		bx::read(&reader, &s_result[ii], 64<<10);
+	}
+
+	return 0;
+}
+
+static uint32_t readChecksum(const void* _data, uint32_t _size)
+{
+	bx::MemoryReader reader(_data, _size);
+	bx::ChecksumReader checksum(&reader);
+	for (uint32_t ii = 0; ii < _size; ii += 64<<10)
+	{
+		bx::read(&checksum, &s_result[ii], 64<<10);
+	}
+
+	return checksum.getChecksum();
+}
+
+static void bench(const char* _name, HashFn _fn)
+{
+	double gbps[2];
+	const uint32_t size[2] = { 64<<10, s_size };
+
+	for (uint32_t ii = 0; ii < 2; ++ii)
+	{
+		const uint32_t numRuns = s_size/size[ii];
+		int64_t best = INT64_MAX;
+
+		for (uint32_t run = 0; run < 5; ++run)
+		{
+			const int64_t start = bx::getHPCounter();
+			for (uint32_t jj = 0; jj < numRuns; ++jj)
+			{
+				_fn(s_data, size[ii]);
+			}
+			best = bx::int64_min(best, bx::getHPCounter() - start);
+		}
+
+		const double sec = double(best)/double(bx::getHPFrequency() );
+		gbps[ii] = double(s_size)/sec/double(1<<30);
+	}
+
+	printf("\t%-20s %6.2f GB/s %6.2f GB/s\n", _name, gbps[0], gbps[1]);
+}
+
+void hashBench()
+{
+	for (uint32_t ii = 0; ii < s_size; ++ii)
+	{
+		s_data[ii] = uint8_t(ii*2654435761u>>24);
+	}
+
+	printf("Hash:                        64KB      16MB\n");
+	bench("hashMurmur2A", murmur);
+	bench("crc32c_ref", crcRef);
+	bench("crc32c", crc);
+	bench("MemoryReader", read);
+	bench("ChecksumReader", readChecksum);
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/histogram.h>
+#include <bx/jobsystem.h>
+#include <bx/thread.h>
+
+TEST(uint64_cntlz)
+{
+	CHECK_EQUAL(63u, bx::uint64_cntlz(1) );
+	CHECK_EQUAL(31u, bx::uint64_cntlz(UINT64_C(0x100000000) ) );
+	CHECK_EQUAL(0u, bx::uint64_cntlz(UINT64_C(0x8000000000000000) ) );
+	CHECK_EQUAL(32u, bx::uint64_cnttz(UINT64_C(0x100000000) ) );
+}
+
+TEST(latency_histogram_buckets)
+{
+	typedef bx::LatencyHistogram Histogram;
+
+	uint32_t last = 0;
+	for (uint64_t value = 0; value < 100000; ++value)
+	{
+		const uint32_t index = Histogram::bucketIndex(value);
+		CHECK(index == last || index == last+1);
+		CHECK(Histogram::bucketLowest(index) <= value);
+		CHECK(Histogram::bucketHighest(index) >= value);
+		last = index;
+	}
+
+	for (uint32_t ii = 0; ii < Histogram::NumBuckets; ++ii)
+	{
+		CHECK_EQUAL(ii, Histogram::bucketIndex(Histogram::bucketLowest(ii) ) );
+		CHECK_EQUAL(ii, Histogram::bucketIndex(Histogram::bucketHighest(ii) ) );
+	}
+
+	CHECK_EQUAL(uint32_t(Histogram::NumBuckets-1), Histogram::bucketIndex(UINT64_MAX) );
+
+	// Relative error is bounded by 1/2^(precision-1).
+	const uint64_t value = UINT64_C(123456789);
+	const uint32_t index = Histogram::bucketIndex(value);
+	const double error = double(Histogram::bucketHighest(index) - Histogram::bucketLowest(index) )/double(value);
+	CHECK(error <= 1.0/double(Histogram::SubBucketHalf) );
+}
+
+TEST(latency_histogram)
+{
+	bx::LatencyHistogram histogram;
+
+	bx::LatencyStats stats;
+	histogram.getStats(stats);
+	CHECK_EQUAL(0u, stats.m_count);
+	CHECK_EQUAL(0u, stats.m_p99);
+
+	for (int64_t ii = 1; ii <= 10000; ++ii)
+	{
+		histogram.record(ii);
+	}
+	histogram.record(-5);
+
+	histogram.getStats(stats);
+	CHECK_EQUAL(10001u, stats.m_count);
+	CHECK_EQUAL(10000u, stats.m_max);
+	CHECK_CLOSE(5000.0, double(stats.m_p50), 5000.0/32.0);
+	CHECK_CLOSE(9000.0, double(stats.m_p90), 9000.0/32.0);
+	CHECK_CLOSE(9900.0, double(stats.m_p99), 9900.0/32.0);
+	CHECK_CLOSE(9990.0, double(stats.m_p999), 10.0);
+	CHECK(stats.m_p50 <= stats.m_p90);
+	CHECK(stats.m_p999 <= stats.m_max);
+	CHECK_EQUAL(0u, histogram.getPercentile(0.0) );
+	CHECK_EQUAL(10000u, histogram.getPercentile(100.0) );
+
+	histogram.reset();
+	histogram.getStats(stats);
+	CHECK_EQUAL(0u, stats.m_count);
+	CHECK_EQUAL(0u, stats.m_max);
+}
+
+static void latencyHistogramJob(void* _userData)
+{
+	bx::LatencyHistogram* histogram = (bx::LatencyHistogram*)_userData;
+	for (uint32_t ii = 0; ii < 1000; ++ii)
+	{
+		histogram->record(ii);
+	}
+}
+
+TEST(latency_histogram_threads)
+{
+	static bx::LatencyHistogram s_histogram;
+
+	bx::JobSystem js;
+	js.init(3);
+
+	bx::JobCounter counter;
+	for (uint32_t ii = 0; ii < 64; ++ii)
+	{
+		js.submit(latencyHistogramJob, &s_histogram, &counter);
+	}
+	js.wait(&counter);
+	js.shutdown();
+
+	bx::LatencyStats stats;
+	s_histogram.getStats(stats);
+	CHECK_EQUAL(64000u, stats.m_count);
+	CHECK_EQUAL(999u, stats.m_max);
+}
+
+static int32_t latencyHistogramThread(void* _userData)
+{
+	bx::LatencyHistogram* histogram = (bx::LatencyHistogram*)_userData;
+	for (uint32_t ii = 0; ii < 100000; ++ii)
+	{
+		histogram->record(ii&1023);
+	}
+
+	return 0;
+}
+
+TEST(latency_histogram_shared_shards)
+{
+	// More threads than owned shards, threads past owned ones record
+	// concurrently with owners, and no count may be lost.
+	static bx::LatencyHistogram s_histogram;
+	static bx::Thread s_thread[bx::LatencyHistogram::NumShards + 2*bx::LatencyHistogram::NumSharedShards];
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(s_thread); ++ii)
+	{
+		s_thread[ii].init(latencyHistogramThread, &s_histogram);
+	}
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(s_thread); ++ii)
+	{
+		s_thread[ii].shutdown();
+	}
+
+	bx::LatencyStats stats;
+	s_histogram.getStats(stats);
+	CHECK_EQUAL(uint64_t(BX_COUNTOF(s_thread) )*100000u, stats.m_count);
+	CHECK_EQUAL(1023u, stats.m_max);
+}
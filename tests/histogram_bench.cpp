@@ -0,0 +1,37 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/histogram.h>
+
+static bx::LatencyHistogram s_histogram;
+
+void histogramBench()
+{
+	const uint32_t numRecords = 1<<20;
+
+	int64_t best = INT64_MAX;
+	for (uint32_t run = 0; run < 10; ++run)
+	{
+		const int64_t start = bx::getHPCounter();
+		for (uint32_t ii = 0; ii < numRecords; ++ii)
+		{
+			s_histogram.record(ii*2654435761u >> 12);
+		}
+		const int64_t elapsed = bx::getHPCounter() - start;
+		best = elapsed < best ? elapsed : best;
+	}
+
+	bx::LatencyStats stats;
+	s_histogram.getStats(stats);
+
+	const double ns = double(best)*1.0e9/double(bx::getHPFrequency() )/double(numRecords);
+	printf("LatencyHistogram::record: %.1f ns (p50 %llu, p99 %llu, max %llu)\n"
+		, ns
+		, (unsigned long long)stats.m_p50
+		, (unsigned long long)stats.m_p99
+		, (unsigned long long)stats.m_max
+		);
+}
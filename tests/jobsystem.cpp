@@ -0,0 +1,117 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/jobsystem.h>
+
+TEST(workstealingqueue)
+{
+	bx::WorkStealingQueue<uint32_t, 4> queue;
+
+	uint32_t value = 0;
+	CHECK(queue.isEmpty() );
+	CHECK(queue.push(1) );
+	CHECK(queue.push(2) );
+	CHECK(queue.push(3) );
+	CHECK(queue.push(4) );
+	CHECK(!queue.push(5) );
+
+	CHECK(queue.steal(value) );
+	CHECK_EQUAL(1u, value);
+
+	CHECK(queue.pop(value) );
+	CHECK_EQUAL(4u, value);
+
+	CHECK(queue.push(6) );
+	CHECK(queue.pop(value) );
+	CHECK_EQUAL(6u, value);
+
+	CHECK(queue.steal(value) );
+	CHECK_EQUAL(2u, value);
+	CHECK(queue.pop(value) );
+	CHECK_EQUAL(3u, value);
+	CHECK(queue.isEmpty() );
+
+	CHECK(!queue.pop(value) );
+	CHECK(!queue.steal(value) );
+}
+
+struct FibJob
+{
+	bx::JobSystem* m_jobSystem;
+	uint32_t m_n;
+	uint32_t m_result;
+
+	static void fn(void* _userData)
+	{
+		FibJob* job = (FibJob*)_userData;
+
+		if (job->m_n < 2)
+		{
+			job->m_result = job->m_n;
+			return;
+		}
+
+		FibJob child[2] =
+		{
+			{ job->m_jobSystem, job->m_n-1, 0 },
+			{ job->m_jobSystem, job->m_n-2, 0 },
+		};
+
+		bx::JobCounter counter;
+		job->m_jobSystem->submit(fn, &child[0], &counter);
+		job->m_jobSystem->submit(fn, &child[1], &counter);
+		job->m_jobSystem->wait(&counter);
+
+		job->m_result = child[0].m_result + child[1].m_result;
+	}
+};
+
+TEST(jobsystem_nested)
+{
+	bx::JobSystem jobSystem;
+	jobSystem.init(4);
+
+	FibJob job = { &jobSystem, 18, 0 };
+	bx::JobCounter counter;
+	jobSystem.submit(FibJob::fn, &job, &counter);
+	jobSystem.wait(&counter);
+
+	CHECK_EQUAL(2584u, job.m_result);
+
+	jobSystem.shutdown();
+}
+
+static void incrementFn(void* _userData)
+{
+	bx::atomicIncr(_userData);
+}
+
+TEST(jobsystem_batch)
+{
+	bx::JobSystem jobSystem;
+	jobSystem.init(3);
+
+	int32_t value = 0;
+
+	bx::Job jobs[5000];
+	bx::JobCounter counter;
+	for (uint32_t ii = 0; ii < BX_COUNTOF(jobs); ++ii)
+	{
+		jobs[ii].m_fn = incrementFn;
+		jobs[ii].m_userData = &value;
+		jobs[ii].m_counter = &counter;
+	}
+
+	jobSystem.submit(jobs, BX_COUNTOF(jobs) );
+	jobSystem.wait(&counter);
+	CHECK_EQUAL(5000, value);
+
+	// Workers are parked, they must wake up for new work.
+	bx::sleep(10);
+	jobSystem.submit(incrementFn, &value, &counter);
+	jobSystem.wait(&counter);
+	CHECK_EQUAL(5001, value);
+}
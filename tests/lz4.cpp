@@ -0,0 +1,226 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/lz4.h>
+#include <bx/rng.h>
+
+static void fillCompressible(uint8_t* _data, uint32_t _size, uint32_t _seed)
+{
+	static const char* s_words[] =
+	{
+		"vertex ", "index ", "buffer ", "texture ", "shader ", "uniform ", "frame ", "\n",
+	};
+
+	bx::RngMwc rng(_seed);
+	uint32_t pos = 0;
+	while (pos < _size)
+	{
+		const uint32_t rnd = rng.gen();
+		if (0 == (rnd & 0x70) )
+		{
+			_data[pos++] = uint8_t(rnd>>8);
+			continue;
+		}
+
+		const char* word = s_words[rnd & 7];
+		for (; '\0' != *word && pos < _size; ++word)
+		{
+			_data[pos++] = uint8_t(*word);
+		}
+	}
+}
+
+static void fillRandom(uint8_t* _data, uint32_t _size, uint32_t _seed)
+{
+	bx::RngMwc rng(_seed);
+	for (uint32_t ii = 0; ii < _size; ++ii)
+	{
+		_data[ii] = uint8_t(rng.gen() );
+	}
+}
+
+static bool lz4RoundTrip(const uint8_t* _data, int32_t _size, int32_t& _compressedSize)
+{
+	uint8_t* compressed = new uint8_t[bx::lz4CompressBound(_size)];
+	uint8_t* decompressed = new uint8_t[_size + 1];
+
+	_compressedSize = bx::lz4Compress(compressed, _data, _size);
+	const bool result = _compressedSize <= bx::lz4CompressBound(_size)
+		&& _size == bx::lz4Decompress(decompressed, _size, compressed, _compressedSize)
+		&& 0 == memcmp(_data, decompressed, _size)
+		// Block doesn't fit in smaller buffer.
+		&& (0 == _size || -1 == bx::lz4Decompress(decompressed, _size - 1, compressed, _compressedSize) )
+		;
+
+	delete [] decompressed;
+	delete [] compressed;
+
+	return result;
+}
+
+TEST(lz4_compress_decompress)
+{
+	static const uint32_t s_size = 256<<10;
+	uint8_t* data = new uint8_t[s_size];
+	int32_t compressedSize;
+
+	fillCompressible(data, s_size, 1);
+	CHECK(lz4RoundTrip(data, s_size, compressedSize) );
+	CHECK(compressedSize < int32_t(s_size/2) );
+
+	fillRandom(data, s_size, 2);
+	CHECK(lz4RoundTrip(data, s_size, compressedSize) );
+	CHECK(compressedSize >= int32_t(s_size) );
+
+	memset(data, 'x', s_size);
+	CHECK(lz4RoundTrip(data, s_size, compressedSize) );
+	CHECK(compressedSize < 1100);
+
+	// Sizes around MatchLimit, LastLiterals, and length continuation
+	// byte boundaries.
+	fillCompressible(data, s_size, 3);
+	for (int32_t size = 0; size < 600; ++size)
+	{
+		CHECK(lz4RoundTrip(data, size, compressedSize) );
+	}
+
+	// Short offsets take overlapping copy path.
+	for (uint32_t period = 1; period < 20; ++period)
+	{
+		for (uint32_t ii = 0; ii < 4096; ++ii)
+		{
+			data[ii] = uint8_t(ii%period * 37);
+		}
+
+		CHECK(lz4RoundTrip(data, 4096, compressedSize) );
+	}
+
+	delete [] data;
+}
+
+TEST(lz4_decompress_corrupt)
+{
+	static const uint32_t s_size = 16<<10;
+	uint8_t data[s_size];
+	uint8_t compressed[s_size + s_size/255 + 16];
+	uint8_t decompressed[s_size];
+
+	fillCompressible(data, s_size, 4);
+	const int32_t compressedSize = bx::lz4Compress(compressed, data, s_size);
+
+	CHECK_EQUAL(-1, bx::lz4Decompress(decompressed, s_size, compressed, 0) );
+
+	// Truncated block must fail, or decode fewer bytes.
+	for (int32_t size = 1; size < compressedSize; size += 7)
+	{
+		CHECK(int32_t(s_size) > bx::lz4Decompress(decompressed, s_size, compressed, size) );
+	}
+
+	// Garbage must not write outside of buffer.
+	bx::RngMwc rng(5);
+	for (uint32_t ii = 0; ii < 1000; ++ii)
+	{
+		uint8_t temp[s_size + s_size/255 + 16];
+		memcpy(temp, compressed, compressedSize);
+		temp[rng.gen() % compressedSize] = uint8_t(rng.gen() );
+		temp[rng.gen() % compressedSize] = uint8_t(rng.gen() );
+
+		const int32_t result = bx::lz4Decompress(decompressed, s_size, temp, compressedSize);
+		CHECK(-1 <= result && int32_t(s_size) >= result);
+	}
+}
+
+TEST(lz4_compressing_writer_decompressing_reader)
+{
+	static const uint32_t s_size = 300<<10;
+	uint8_t* data = new uint8_t[s_size];
+	uint8_t* result = new uint8_t[s_size];
+	fillCompressible(data, s_size, 6);
+	fillRandom(&data[96<<10], 32<<10, 7);
+
+	bx::CrtAllocator allocator;
+	bx::MemoryBlock mb(&allocator);
+	bx::MemoryWriter writer(&mb);
+
+	{
+		bx::CompressingWriter compressor(&writer, 32<<10);
+
+		// Mix of small writes, and writes larger than block.
+		uint32_t pos = 0;
+		for (uint32_t size = 1; pos < s_size; size = size*3 + 1)
+		{
+			const uint32_t len = bx::uint32_min(size % (80<<10), s_size - pos);
+			CHECK_EQUAL(int32_t(len), bx::write(&compressor, &data[pos], int32_t(len) ) );
+			pos += len;
+		}
+	}
+
+	const uint32_t compressedSize = uint32_t(bx::getSize(&writer) );
+	CHECK(compressedSize < s_size/2);
+
+	// Parse framing directly, stored block is one that covers random data.
+	{
+		const uint8_t* ptr = (const uint8_t*)mb.getData();
+		const uint8_t* end = ptr + compressedSize;
+		uint32_t pos = 0;
+		uint32_t numStored = 0;
+
+		while (ptr < end)
+		{
+			bx::Lz4BlockHeader header;
+			CHECK(bx::lz4ReadBlockHeader(ptr, header) );
+			ptr += bx::Lz4BlockHeader::Size;
+
+			CHECK(bx::lz4DecompressBlock(&result[pos], header, ptr) );
+			ptr += header.m_compressedSize;
+			pos += header.m_size;
+			numStored += header.m_stored;
+		}
+
+		CHECK_EQUAL(s_size, pos);
+		CHECK_EQUAL(1u, numStored);
+		CHECK_EQUAL(0, memcmp(data, result, s_size) );
+	}
+
+	{
+		memset(result, 0, s_size);
+
+		bx::MemoryReader reader(mb.getData(), compressedSize);
+		bx::DecompressingReader decompressor(&reader, 32<<10);
+
+		uint32_t pos = 0;
+		for (uint32_t size = 1; pos < s_size; size = size*5 + 3)
+		{
+			const uint32_t len = bx::uint32_min(size % (70<<10), s_size - pos);
+			CHECK_EQUAL(int32_t(len), bx::read(&decompressor, &result[pos], int32_t(len) ) );
+			pos += len;
+		}
+
+		uint8_t temp;
+		CHECK_EQUAL(0, bx::read(&decompressor, temp) );
+		CHECK(!decompressor.isCorrupt() );
+		CHECK_EQUAL(0, memcmp(data, result, s_size) );
+	}
+
+	// Reader with smaller block size grows its buffers.
+	{
+		bx::MemoryReader reader(mb.getData(), compressedSize);
+		bx::DecompressingReader decompressor(&reader, 1024);
+		CHECK_EQUAL(int32_t(s_size), bx::read(&decompressor, result, s_size) );
+		CHECK_EQUAL(0, memcmp(data, result, s_size) );
+	}
+
+	// Truncated stream is reported as corrupt.
+	{
+		bx::MemoryReader reader(mb.getData(), compressedSize - 1);
+		bx::DecompressingReader decompressor(&reader);
+		CHECK(int32_t(s_size) > bx::read(&decompressor, result, s_size) );
+		CHECK(decompressor.isCorrupt() );
+	}
+
+	delete [] result;
+	delete [] data;
+}
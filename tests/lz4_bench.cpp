@@ -0,0 +1,119 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/lz4.h>
+#include <bx/rng.h>
+
+static const uint32_t s_size = 16<<20;
+static const uint32_t s_blockSize = 64<<10;
+
+static double toMBps(int64_t _elapsed)
+{
+	const double sec = double(_elapsed)/double(bx::getHPFrequency() );
+	return double(s_size)/sec/double(1<<20);
+}
+
+// Vertex-like records, quantized floats with small random deltas and
+// repeated attributes.
+static void fillData(uint8_t* _data)
+{
+	bx::RngMwc rng;
+	float* data = (float*)_data;
+	float pos[3] = { 0.0f, 0.0f, 0.0f };
+
+	for (uint32_t ii = 0; ii < s_size/sizeof(float); ii += 8)
+	{
+		const uint32_t rnd = rng.gen();
+		pos[rnd%3] += float(int32_t(rnd>>8 & 0xf) - 8)*0.125f;
+
+		data[ii+0] = pos[0];
+		data[ii+1] = pos[1];
+		data[ii+2] = pos[2];
+		data[ii+3] = 0.0f;
+		data[ii+4] = 1.0f;
+		data[ii+5] = 0.0f;
+		data[ii+6] = float(rnd>>16 & 0xff)/256.0f;
+		data[ii+7] = float(rnd>>24)/256.0f;
+	}
+}
+
+void lz4Bench()
+{
+	uint8_t* data = new uint8_t[s_size];
+	uint8_t* result = new uint8_t[s_size];
+	uint8_t* compressed = new uint8_t[s_size + s_size/255 + 16*(s_size/s_blockSize)];
+	int32_t offset[s_size/s_blockSize+1];
+
+	fillData(data);
+
+	int64_t best[3] = { INT64_MAX, INT64_MAX, INT64_MAX };
+	for (uint32_t run = 0; run < 5; ++run)
+	{
+		int64_t start = bx::getHPCounter();
+		memcpy(result, data, s_size);
+		best[0] = bx::int64_min(best[0], bx::getHPCounter() - start);
+
+		start = bx::getHPCounter();
+		offset[0] = 0;
+		for (uint32_t ii = 0; ii < s_size/s_blockSize; ++ii)
+		{
+			offset[ii+1] = offset[ii] + bx::lz4Compress(&compressed[offset[ii] ], &data[ii*s_blockSize], s_blockSize);
+		}
+		best[1] = bx::int64_min(best[1], bx::getHPCounter() - start);
+
+		start = bx::getHPCounter();
+		for (uint32_t ii = 0; ii < s_size/s_blockSize; ++ii)
+		{
+			bx::lz4Decompress(&result[ii*s_blockSize], s_blockSize, &compressed[offset[ii] ], offset[ii+1] - offset[ii]);
+		}
+		best[2] = bx::int64_min(best[2], bx::getHPCounter() - start);
+	}
+
+	const int32_t compressedSize = offset[s_size/s_blockSize];
+
+	printf("LZ4 %dMB in %dKB blocks, ratio %.2f:\n"
+		, s_size>>20
+		, s_blockSize>>10
+		, double(s_size)/double(compressedSize)
+		);
+	printf("\tmemcpy               %7.0f MB/s\n", toMBps(best[0]) );
+	printf("\tlz4Compress          %7.0f MB/s\n", toMBps(best[1]) );
+	printf("\tlz4Decompress        %7.0f MB/s%s\n"
+		, toMBps(best[2])
+		, 0 == memcmp(data, result, s_size) ? "" : " (mismatch)"
+		);
+
+	bx::CrtAllocator allocator;
+	bx::MemoryBlock mb(&allocator, s_size);
+	bx::MemoryWriter writer(&mb);
+
+	int64_t start = bx::getHPCounter();
+	{
+		bx::CompressingWriter compressor(&writer, s_blockSize);
+		bx::write(&compressor, data, s_size);
+	}
+	const int64_t compressTime = bx::getHPCounter() - start;
+
+	memset(result, 0, s_size);
+	bx::MemoryReader reader(mb.getData(), uint32_t(bx::getSize(&writer) ) );
+
+	start = bx::getHPCounter();
+	{
+		bx::DecompressingReader decompressor(&reader, s_blockSize);
+		bx::read(&decompressor, result, s_size);
+	}
+	const int64_t decompressTime = bx::getHPCounter() - start;
+
+	printf("\tCompressingWriter    %7.0f MB/s\n", toMBps(compressTime) );
+	printf("\tDecompressingReader  %7.0f MB/s%s\n"
+		, toMBps(decompressTime)
+		, 0 == memcmp(data, result, s_size) ? "" : " (mismatch)"
+		);
+
+	delete [] compressed;
+	delete [] result;
+	delete [] data;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/mpmcqueue.h>
+#include <bx/os.h>
+#include <bx/thread.h>
+
+TEST(mpmc_bounded_queue)
+{
+	bx::MpMcBoundedQueueLf<uint32_t> queue(3);
+	CHECK_EQUAL(4u, queue.getCapacity() );
+	CHECK(NULL == queue.pop() );
+
+	uint32_t values[5] = { 0, 1, 2, 3, 4 };
+	CHECK(queue.push(&values[0]) );
+	CHECK(queue.push(&values[1]) );
+	CHECK(queue.push(&values[2]) );
+	CHECK(queue.push(&values[3]) );
+	CHECK(!queue.push(&values[4]) );
+
+	CHECK_EQUAL(&values[0], queue.pop() );
+	CHECK(queue.push(&values[4]) );
+
+	for (uint32_t ii = 1; ii < BX_COUNTOF(values); ++ii)
+	{
+		CHECK_EQUAL(&values[ii], queue.pop() );
+	}
+
+	CHECK(NULL == queue.pop() );
+}
+
+struct MpMcQueueTest
+{
+	enum { NumThreads = 4, NumItems = 10000 };
+
+	struct Producer
+	{
+		MpMcQueueTest* m_test;
+		uint32_t* m_items;
+	};
+
+	bx::MpMcBoundedQueueLf<uint32_t> m_queue;
+	Producer m_producer[NumThreads];
+	bx::Atomic<uint32_t> m_popped;
+	bx::Atomic<uint64_t> m_sum;
+	uint32_t m_items[NumThreads][NumItems];
+
+	MpMcQueueTest()
+		: m_queue(64)
+	{
+	}
+
+	static int32_t producer(void* _userData)
+	{
+		Producer* producer = (Producer*)_userData;
+		MpMcQueueTest* test = producer->m_test;
+		uint32_t* items = producer->m_items;
+
+		for (uint32_t ii = 0; ii < NumItems; ++ii)
+		{
+			while (!test->m_queue.push(&items[ii]) )
+			{
+				bx::yield();
+			}
+		}
+
+		return 0;
+	}
+
+	static int32_t consumer(void* _userData)
+	{
+		MpMcQueueTest* test = (MpMcQueueTest*)_userData;
+
+		while (NumThreads*NumItems > test->m_popped.load() )
+		{
+			uint32_t* item = test->m_queue.pop();
+			if (NULL == item)
+			{
+				bx::yield();
+				continue;
+			}
+
+			test->m_sum.fetchAdd(*item);
+			test->m_popped.fetchAdd(1);
+		}
+
+		return 0;
+	}
+};
+
+TEST(mpmc_bounded_queue_threads)
+{
+	MpMcQueueTest* test = new MpMcQueueTest;
+
+	uint64_t expected = 0;
+	for (uint32_t ii = 0; ii < MpMcQueueTest::NumThreads; ++ii)
+	{
+		test->m_producer[ii].m_test  = test;
+		test->m_producer[ii].m_items = test->m_items[ii];
+
+		for (uint32_t jj = 0; jj < MpMcQueueTest::NumItems; ++jj)
+		{
+			test->m_items[ii][jj] = ii*MpMcQueueTest::NumItems + jj;
+			expected += test->m_items[ii][jj];
+		}
+	}
+
+	bx::Thread producer[MpMcQueueTest::NumThreads];
+	bx::Thread consumer[MpMcQueueTest::NumThreads];
+	for (uint32_t ii = 0; ii < MpMcQueueTest::NumThreads; ++ii)
+	{
+		consumer[ii].init(MpMcQueueTest::consumer, test);
+		producer[ii].init(MpMcQueueTest::producer, &test->m_producer[ii]);
+	}
+
+	for (uint32_t ii = 0; ii < MpMcQueueTest::NumThreads; ++ii)
+	{
+		producer[ii].shutdown();
+		consumer[ii].shutdown();
+	}
+
+	CHECK_EQUAL(uint32_t(MpMcQueueTest::NumThreads*MpMcQueueTest::NumItems), test->m_popped.load() );
+	CHECK_EQUAL(expected, test->m_sum.load() );
+	CHECK(NULL == test->m_queue.pop() );
+
+	delete test;
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/thread.h>
+#include <bx/mutex.h>
+#include <bx/os.h>
+
+template<typename Lock>
+struct LockTest
+{
+	Lock m_lock;
+	uint32_t m_counter;
+	uint32_t m_numIterations;
+
+	static int32_t threadFunc(void* _userData)
+	{
+		LockTest* test = (LockTest*)_userData;
+
+		for (uint32_t ii = 0; ii < test->m_numIterations; ++ii)
+		{
+			test->m_lock.lock();
+			++test->m_counter;
+			test->m_lock.unlock();
+		}
+
+		return 0;
+	}
+
+	uint32_t run(uint32_t _numIterations = 100000)
+	{
+		m_counter = 0;
+		m_numIterations = _numIterations;
+
+		bx::Thread thread[4];
+		for (uint32_t ii = 0; ii < BX_COUNTOF(thread); ++ii)
+		{
+			thread[ii].init(threadFunc, this);
+		}
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(thread); ++ii)
+		{
+			thread[ii].shutdown();
+		}
+
+		return m_counter;
+	}
+};
+
+TEST(mutex)
+{
+	LockTest<bx::Mutex> test;
+	CHECK_EQUAL(400000u, test.run() );
+}
+
+#if BX_CONFIG_MUTEX_PROFILE
+struct MutexProfileTest
+{
+	MutexProfileTest()
+		: m_mutex("contended")
+		, m_found(0)
+		, m_num(0)
+	{
+	}
+
+	static int32_t threadFunc(void* _userData)
+	{
+		MutexProfileTest* test = (MutexProfileTest*)_userData;
+		test->m_mutex.lock();
+		test->m_mutex.unlock();
+		return 0;
+	}
+
+	static void enumFn(const bx::MutexProfile& _profile, void* _userData)
+	{
+		MutexProfileTest* test = (MutexProfileTest*)_userData;
+		++test->m_num;
+		if (&_profile == &test->m_mutex.getProfile() )
+		{
+			++test->m_found;
+		}
+	}
+
+	bx::Mutex m_mutex;
+	uint32_t m_found;
+	uint32_t m_num;
+};
+
+TEST(mutex_profile)
+{
+	MutexProfileTest test;
+
+	// Thread blocks on mutex held by this thread.
+	test.m_mutex.lock();
+	bx::Thread thread;
+	thread.init(MutexProfileTest::threadFunc, &test);
+	bx::sleep(50);
+	test.m_mutex.unlock();
+	thread.shutdown();
+
+	CHECK(test.m_mutex.tryLock() );
+	test.m_mutex.unlock();
+
+	const bx::MutexProfile& profile = test.m_mutex.getProfile();
+	CHECK_EQUAL(0, strcmp("contended", profile.m_name) );
+	CHECK_EQUAL(3u, uint32_t(profile.m_acquireCount) );
+	CHECK_EQUAL(1u, uint32_t(profile.m_contendedCount) );
+	CHECK(0 < profile.m_waitTime);
+	CHECK(profile.m_waitTime >= profile.m_maxWaitTime);
+	CHECK(0 < profile.m_maxHoldTime);
+
+	bx::mutexProfileEnum(MutexProfileTest::enumFn, &test);
+	CHECK_EQUAL(1u, test.m_found);
+
+	bx::mutexProfileReset();
+	CHECK_EQUAL(0, strcmp("contended", profile.m_name) );
+	CHECK_EQUAL(0u, uint32_t(profile.m_acquireCount) );
+	CHECK_EQUAL(0u, uint32_t(profile.m_contendedCount) );
+	CHECK_EQUAL(0, profile.m_waitTime);
+
+	// Destroyed mutex is removed from registry.
+	const uint32_t num = test.m_num;
+	{
+		MutexProfileTest temp;
+		bx::mutexProfileEnum(MutexProfileTest::enumFn, &temp);
+		CHECK_EQUAL(1u, temp.m_found);
+		CHECK_EQUAL(num + 1, temp.m_num);
+	}
+
+	test.m_num = 0;
+	bx::mutexProfileEnum(MutexProfileTest::enumFn, &test);
+	CHECK_EQUAL(num, test.m_num);
+}
+#endif // BX_CONFIG_MUTEX_PROFILE
+
+TEST(lwmutex)
+{
+	LockTest<bx::LwMutex> test;
+	CHECK_EQUAL(400000u, test.run() );
+
+	CHECK(test.m_lock.tryLock() );
+	CHECK(!test.m_lock.tryLock() );
+	test.m_lock.unlock();
+}
+
+TEST(spinlock)
+{
+	LockTest<bx::SpinLock> test;
+	CHECK_EQUAL(400000u, test.run() );
+
+	CHECK(test.m_lock.tryLock() );
+	CHECK(!test.m_lock.tryLock() );
+	test.m_lock.unlock();
+}
+
+TEST(ticketlock)
+{
+	// Fair lock hands off to next thread in line, which is slow when
+	// threads outnumber cores.
+	LockTest<bx::TicketLock> test;
+	CHECK_EQUAL(40000u, test.run(10000) );
+}
+
+struct RwMutexTest
+{
+	bx::RwMutex m_mutex;
+	uint32_t m_value[2];
+	uint32_t m_errors;
+
+	static int32_t readerFunc(void* _userData)
+	{
+		RwMutexTest* test = (RwMutexTest*)_userData;
+
+		for (uint32_t ii = 0; ii < 100000; ++ii)
+		{
+			bx::RwMutexReadScope lock(test->m_mutex);
+			if (test->m_value[0] != test->m_value[1])
+			{
+				bx::atomicIncr(&test->m_errors);
+			}
+		}
+
+		return 0;
+	}
+
+	static int32_t writerFunc(void* _userData)
+	{
+		RwMutexTest* test = (RwMutexTest*)_userData;
+
+		for (uint32_t ii = 0; ii < 10000; ++ii)
+		{
+			bx::RwMutexWriteScope lock(test->m_mutex);
+			test->m_value[0] = ii;
+			test->m_value[1] = ii;
+		}
+
+		return 0;
+	}
+};
+
+TEST(rwmutex)
+{
+	RwMutexTest test;
+	test.m_value[0] = 0;
+	test.m_value[1] = 0;
+	test.m_errors = 0;
+
+	bx::Thread thread[4];
+	thread[0].init(RwMutexTest::writerFunc, &test);
+	for (uint32_t ii = 1; ii < BX_COUNTOF(thread); ++ii)
+	{
+		thread[ii].init(RwMutexTest::readerFunc, &test);
+	}
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(thread); ++ii)
+	{
+		thread[ii].shutdown();
+	}
+
+	CHECK_EQUAL(0u, test.m_errors);
+	CHECK_EQUAL(9999u, test.m_value[0]);
+}
+
+struct SeqLockTest
+{
+	struct Snapshot
+	{
+		uint64_t m_a;
+		uint64_t m_b;
+		uint64_t m_c;
+	};
+
+	bx::SeqLock<Snapshot> m_lock;
+	uint32_t m_errors;
+
+	static int32_t readerFunc(void* _userData)
+	{
+		SeqLockTest* test = (SeqLockTest*)_userData;
+
+		for (uint32_t ii = 0; ii < 100000; ++ii)
+		{
+			Snapshot snapshot = test->m_lock.read();
+			if (snapshot.m_a != snapshot.m_b
+			||  snapshot.m_a != snapshot.m_c)
+			{
+				bx::atomicIncr(&test->m_errors);
+			}
+		}
+
+		return 0;
+	}
+
+	static int32_t writerFunc(void* _userData)
+	{
+		SeqLockTest* test = (SeqLockTest*)_userData;
+
+		for (uint64_t ii = 0; ii < 100000; ++ii)
+		{
+			Snapshot snapshot = { ii, ii, ii };
+			test->m_lock.write(snapshot);
+		}
+
+		return 0;
+	}
+};
+
+TEST(seqlock)
+{
+	SeqLockTest test;
+	test.m_errors = 0;
+
+	bx::Thread thread[4];
+	thread[0].init(SeqLockTest::writerFunc, &test);
+	for (uint32_t ii = 1; ii < BX_COUNTOF(thread); ++ii)
+	{
+		thread[ii].init(SeqLockTest::readerFunc, &test);
+	}
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(thread); ++ii)
+	{
+		thread[ii].shutdown();
+	}
+
+	CHECK_EQUAL(0u, test.m_errors);
+	CHECK_EQUAL(99999u, test.m_lock.read().m_a);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/thread.h>
+#include <bx/mutex.h>
+
+static const uint32_t s_numIterations = 1000000;
+
+template<typename Lock>
+struct ContentionBench
+{
+	Lock m_lock;
+	uint64_t m_counter;
+	uint32_t m_numIterations;
+
+	static int32_t threadFunc(void* _userData)
+	{
+		ContentionBench* bench = (ContentionBench*)_userData;
+
+		for (uint32_t ii = 0, num = bench->m_numIterations; ii < num; ++ii)
+		{
+			bench->m_lock.lock();
+			++bench->m_counter;
+			bench->m_lock.unlock();
+		}
+
+		return 0;
+	}
+
+	double run(uint32_t _numThreads)
+	{
+		m_counter = 0;
+		m_numIterations = s_numIterations/_numThreads;
+
+		bx::Thread thread[32];
+		int64_t start = bx::getHPCounter();
+
+		for (uint32_t ii = 0; ii < _numThreads; ++ii)
+		{
+			thread[ii].init(threadFunc, this);
+		}
+
+		for (uint32_t ii = 0; ii < _numThreads; ++ii)
+		{
+			thread[ii].shutdown();
+		}
+
+		int64_t elapsed = bx::getHPCounter() - start;
+		double ns = double(elapsed)*1.0e9/double(bx::getHPFrequency() );
+
+		return ns/double(m_counter);
+	}
+};
+
+template<typename Lock>
+static void contentionBench(const char* _name)
+{
+	printf("%-12s", _name);
+
+	for (uint32_t numThreads = 1; numThreads <= 16; numThreads *= 2)
+	{
+		ContentionBench<Lock> bench;
+		printf("%10.1f", bench.run(numThreads) );
+	}
+
+	printf("\n");
+}
+
+void mutexBench()
+{
+	printf("Lock contention, ns per lock/unlock pair:\n");
+	printf("%-12s%10s%10s%10s%10s%10s\n", "threads", "1", "2", "4", "8", "16");
+
+	contentionBench<bx::Mutex>("Mutex");
+	contentionBench<bx::LwMutex>("LwMutex");
+	contentionBench<bx::SpinLock>("SpinLock");
+	contentionBench<bx::TicketLock>("TicketLock");
+	printf("\n");
+}
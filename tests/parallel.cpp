@@ -0,0 +1,98 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/parallel.h>
+
+struct MarkFn
+{
+	void operator()(uint32_t _begin, uint32_t _end) const
+	{
+		for (uint32_t ii = _begin; ii < _end; ++ii)
+		{
+			++m_data[ii];
+		}
+	}
+
+	uint8_t* m_data;
+};
+
+struct SumFn
+{
+	uint64_t operator()(uint32_t _begin, uint32_t _end) const
+	{
+		uint64_t sum = 0;
+		for (uint32_t ii = _begin; ii < _end; ++ii)
+		{
+			sum += ii;
+		}
+
+		return sum;
+	}
+};
+
+struct AddFn
+{
+	uint64_t operator()(uint64_t _a, uint64_t _b) const
+	{
+		return _a + _b;
+	}
+};
+
+static bool allEqual(const uint8_t* _data, uint32_t _num, uint8_t _value)
+{
+	for (uint32_t ii = 0; ii < _num; ++ii)
+	{
+		if (_value != _data[ii])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST(parallel_for)
+{
+	static uint8_t data[100003];
+	memset(data, 0, sizeof(data) );
+
+	MarkFn fn = { data };
+
+	// Serial fallback without job system.
+	bx::parallelFor(NULL, 0, BX_COUNTOF(data), 0, fn);
+	CHECK(allEqual(data, BX_COUNTOF(data), 1) );
+
+	bx::JobSystem jobSystem;
+	jobSystem.init(3);
+
+	bx::parallelFor(&jobSystem, 0, BX_COUNTOF(data), 0, fn);
+	CHECK(allEqual(data, BX_COUNTOF(data), 2) );
+
+	bx::parallelFor(&jobSystem, 0, BX_COUNTOF(data), 7, fn);
+	CHECK(allEqual(data, BX_COUNTOF(data), 3) );
+
+	bx::setJobSystem(&jobSystem);
+	bx::parallelFor(10, 10, 1, fn);
+	bx::parallelFor(0, BX_COUNTOF(data), 1000, fn);
+	CHECK(allEqual(data, BX_COUNTOF(data), 4) );
+	bx::setJobSystem(NULL);
+}
+
+TEST(parallel_reduce)
+{
+	const uint64_t expected = UINT64_C(100003)*UINT64_C(100002)/2;
+
+	CHECK_EQUAL(expected, bx::parallelReduce(NULL, 0, 100003, 0, uint64_t(0), SumFn(), AddFn() ) );
+
+	bx::JobSystem jobSystem;
+	jobSystem.init(3);
+
+	CHECK_EQUAL(expected, bx::parallelReduce(&jobSystem, 0, 100003, 0, uint64_t(0), SumFn(), AddFn() ) );
+	CHECK_EQUAL(expected, bx::parallelReduce(&jobSystem, 0, 100003, 1, uint64_t(0), SumFn(), AddFn() ) );
+	CHECK_EQUAL(expected, bx::parallelReduce(&jobSystem, 0, 100003, 99999, uint64_t(0), SumFn(), AddFn() ) );
+	CHECK_EQUAL(uint64_t(0), bx::parallelReduce(&jobSystem, 5, 5, 0, uint64_t(0), SumFn(), AddFn() ) );
+	CHECK_EQUAL(uint64_t(130*129/2), bx::parallelReduce(&jobSystem, 0, 130, 1, uint64_t(0), SumFn(), AddFn() ) );
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/parallel.h>
+#include <math.h>
+
+static const uint32_t s_numElements = 16<<20;
+static float s_data[s_numElements];
+
+struct ScaleFn
+{
+	void operator()(uint32_t _begin, uint32_t _end) const
+	{
+		for (uint32_t ii = _begin; ii < _end; ++ii)
+		{
+			s_data[ii] = s_data[ii]*0.5f + 1.0f;
+		}
+	}
+};
+
+struct SumSqrtFn
+{
+	double operator()(uint32_t _begin, uint32_t _end) const
+	{
+		double sum = 0.0;
+		for (uint32_t ii = _begin; ii < _end; ++ii)
+		{
+			sum += sqrtf(s_data[ii]);
+		}
+
+		return sum;
+	}
+};
+
+struct AddFn
+{
+	double operator()(double _a, double _b) const
+	{
+		return _a + _b;
+	}
+};
+
+static double toMs(int64_t _ticks)
+{
+	return double(_ticks)*1000.0/double(bx::getHPFrequency() );
+}
+
+void parallelBench()
+{
+	printf("parallelFor/parallelReduce over %d floats, ms (speedup):\n", s_numElements);
+	printf("%-8s%22s%22s\n", "threads", "parallelFor", "parallelReduce");
+
+	double baseFor = 0.0;
+	double baseReduce = 0.0;
+
+	for (uint32_t numThreads = 1; numThreads <= 32; numThreads *= 2)
+	{
+		// Calling thread participates in wait, so pool has one less worker.
+		bx::JobSystem jobSystem;
+		if (1 < numThreads)
+		{
+			jobSystem.init(numThreads-1);
+		}
+
+		bx::JobSystem* js = 1 < numThreads ? &jobSystem : NULL;
+
+		for (uint32_t ii = 0; ii < s_numElements; ++ii)
+		{
+			s_data[ii] = float(ii&0xffff);
+		}
+
+		int64_t start = bx::getHPCounter();
+		bx::parallelFor(js, 0, s_numElements, 0, ScaleFn() );
+		const double forMs = toMs(bx::getHPCounter() - start);
+
+		start = bx::getHPCounter();
+		double sum = bx::parallelReduce(js, 0, s_numElements, 0, 0.0, SumSqrtFn(), AddFn() );
+		const double reduceMs = toMs(bx::getHPCounter() - start);
+
+		if (1 == numThreads)
+		{
+			baseFor = forMs;
+			baseReduce = reduceMs;
+		}
+
+		printf("%-8d%14.2f (%4.1fx)%14.2f (%4.1fx)  %g\n"
+			, numThreads
+			, forMs
+			, baseFor/forMs
+			, reduceMs
+			, baseReduce/reduceMs
+			, sum
+			);
+	}
+
+	printf("\n");
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/profiler.h>
+#include <bx/jobsystem.h>
+#include <bx/tracewriter.h>
+
+struct ProfilerCollect : public bx::ProfilerCallbackI
+{
+	ProfilerCollect()
+		: m_num(0)
+		, m_depth(0)
+		, m_maxDepth(0)
+		, m_ordered(true)
+		, m_lastTime(0)
+	{
+	}
+
+	virtual void events(uint32_t _tid, const bx::ProfilerEvent* _events, uint32_t _num) BX_OVERRIDE
+	{
+		BX_UNUSED(_tid);
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const bx::ProfilerEvent& event = _events[ii];
+			m_ordered &= event.m_time >= m_lastTime;
+			m_lastTime = event.m_time;
+			m_depth += bx::ProfilerEventType::Begin == event.m_type ? 1 : -1;
+			m_maxDepth = m_depth > m_maxDepth ? m_depth : m_maxDepth;
+		}
+
+		m_num += _num;
+	}
+
+	uint32_t m_num;
+	int32_t m_depth;
+	int32_t m_maxDepth;
+	bool m_ordered;
+	int64_t m_lastTime;
+};
+
+TEST(profiler)
+{
+	ProfilerCollect collect;
+
+	bx::Profiler profiler;
+	CHECK(NULL == profiler.getThreadBuffer() );
+
+	profiler.init(&collect, 0);
+	bx::setProfiler(&profiler);
+
+	{
+		bx::ProfileScope outer("outer");
+		for (uint32_t ii = 0; ii < 100; ++ii)
+		{
+			bx::ProfileScope inner("inner");
+		}
+
+		bx::profileBegin("manual");
+		bx::profileEnd("manual");
+	}
+
+	{
+		// Compiles to nothing unless BX_CONFIG_PROFILER is enabled.
+		BX_PROFILE_SCOPE("macro");
+	}
+
+	const uint32_t num = 2*(102 + BX_CONFIG_PROFILER);
+	CHECK_EQUAL(num, profiler.collect() );
+	CHECK_EQUAL(0u, profiler.collect() );
+	CHECK_EQUAL(num, collect.m_num);
+	CHECK_EQUAL(0, collect.m_depth);
+	CHECK_EQUAL(2, collect.m_maxDepth);
+	CHECK(collect.m_ordered);
+
+	// Overflow drops events instead of blocking.
+	for (uint32_t ii = 0; ii < BX_CONFIG_PROFILER_BUFFER_SIZE; ++ii)
+	{
+		bx::ProfileScope scope("overflow");
+	}
+
+	CHECK_EQUAL(uint32_t(BX_CONFIG_PROFILER_BUFFER_SIZE), profiler.getNumDropped() );
+	CHECK_EQUAL(uint32_t(BX_CONFIG_PROFILER_BUFFER_SIZE), profiler.collect() );
+
+	bx::setProfiler(NULL);
+	profiler.shutdown();
+}
+
+struct ProfilerCount : public bx::ProfilerCallbackI
+{
+	ProfilerCount()
+		: m_num(0)
+	{
+	}
+
+	virtual void events(uint32_t _tid, const bx::ProfilerEvent* _events, uint32_t _num) BX_OVERRIDE
+	{
+		BX_UNUSED(_tid);
+
+		// Job system emits its own events when BX_CONFIG_PROFILER is set.
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			m_num += 0 == strcmp(_events[ii].m_name, "test job");
+		}
+	}
+
+	uint32_t m_num;
+};
+
+static void profilerJob(void* _userData)
+{
+	BX_UNUSED(_userData);
+	for (uint32_t ii = 0; ii < 100; ++ii)
+	{
+		bx::ProfileScope scope("test job");
+	}
+}
+
+TEST(profiler_threads)
+{
+	ProfilerCount count;
+
+	bx::Profiler profiler;
+	profiler.init(&count, 1);
+	bx::setProfiler(&profiler);
+
+	bx::JobSystem js;
+	js.init(3);
+
+	bx::JobCounter counter;
+	for (uint32_t ii = 0; ii < 16; ++ii)
+	{
+		js.submit(profilerJob, NULL, &counter);
+	}
+	js.wait(&counter);
+	js.shutdown();
+
+	bx::setProfiler(NULL);
+	CHECK_EQUAL(0u, profiler.getNumDropped() );
+	profiler.shutdown();
+
+	CHECK_EQUAL(16u*200u, count.m_num);
+}
+
+TEST(profiler_chrome_trace)
+{
+	static char s_json[64<<10];
+	bx::StaticMemoryBlockWriter writer(s_json, sizeof(s_json)-1);
+	bx::ChromeTraceWriter trace(&writer, 1);
+	trace.begin();
+
+	bx::Profiler profiler;
+	profiler.init(&trace, 0);
+	bx::setProfiler(&profiler);
+
+	bx::profileThreadName("main \"thread\"");
+	{
+		bx::ProfileScope scope("frame");
+		bx::profileCounter("allocated", 1234);
+
+		const uint64_t id = bx::profileFlowBegin("submit");
+		CHECK(0 != id);
+
+		bx::ProfileScope job("job");
+		bx::profileFlowEnd("job", id);
+	}
+
+	bx::setProfiler(NULL);
+	profiler.shutdown();
+
+	// thread name, frame, counter, submit scope and flow start, job and
+	// flow end.
+	CHECK_EQUAL(10u, trace.getNum() );
+	trace.end();
+
+	const int32_t len = int32_t(writer.seek() );
+	s_json[len] = '\0';
+
+	CHECK_EQUAL('[', s_json[0]);
+	CHECK(NULL != strstr(s_json, "\"args\":{\"name\":\"main \\\"thread\\\"\"}") );
+	CHECK(NULL != strstr(s_json, "\"name\":\"frame\",\"ph\":\"B\"") );
+	CHECK(NULL != strstr(s_json, "\"name\":\"frame\",\"ph\":\"E\"") );
+	CHECK(NULL != strstr(s_json, "\"ph\":\"C\"") );
+	CHECK(NULL != strstr(s_json, "{\"value\":1234}") );
+	CHECK(NULL != strstr(s_json, "\"ph\":\"s\"") );
+	CHECK(NULL != strstr(s_json, "\"ph\":\"f\",\"bp\":\"e\"") );
+	CHECK_EQUAL(']', s_json[len-2]);
+}
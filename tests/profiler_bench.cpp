@@ -0,0 +1,46 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/profiler.h>
+
+struct ProfilerDiscard : public bx::ProfilerCallbackI
+{
+	virtual void events(uint32_t _tid, const bx::ProfilerEvent* _events, uint32_t _num) BX_OVERRIDE
+	{
+		BX_UNUSED(_tid, _events, _num);
+	}
+};
+
+void profilerBench()
+{
+	ProfilerDiscard discard;
+	bx::Profiler profiler;
+	profiler.init(&discard, 0);
+	bx::setProfiler(&profiler);
+
+	// Stay within buffer size, so that no events are dropped.
+	const uint32_t numScopes = BX_CONFIG_PROFILER_BUFFER_SIZE/2;
+
+	int64_t best = INT64_MAX;
+	for (uint32_t run = 0; run < 100; ++run)
+	{
+		const int64_t start = bx::getHPCounter();
+		for (uint32_t ii = 0; ii < numScopes; ++ii)
+		{
+			bx::ProfileScope scope("bench");
+		}
+		const int64_t elapsed = bx::getHPCounter() - start;
+		best = elapsed < best ? elapsed : best;
+
+		profiler.collect();
+	}
+
+	const double ns = double(best)*1.0e9/double(bx::getHPFrequency() )/double(numScopes);
+	printf("ProfileScope: %.1f ns per scope (dropped %d)\n", ns, profiler.getNumDropped() );
+
+	bx::setProfiler(NULL);
+	profiler.shutdown();
+}
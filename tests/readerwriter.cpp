@@ -0,0 +1,481 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/readerwriter.h>
+
+#if BX_CONFIG_MMAP_FILE_READER && BX_CONFIG_CRT_FILE_READER_WRITER
+TEST(mmap_file_reader)
+{
+	static const char* s_filePath = "mmap_file_reader.bin";
+
+	uint32_t data[4096];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(data); ++ii)
+	{
+		data[ii] = ii*2654435761u;
+	}
+
+	bx::CrtFileWriter writer;
+	CHECK_EQUAL(0, bx::open(&writer, s_filePath) );
+	CHECK_EQUAL(int32_t(sizeof(data) ), bx::write(&writer, data, sizeof(data) ) );
+	bx::close(&writer);
+
+	bx::MmapFileReader reader(bx::MmapHint::Sequential|bx::MmapHint::WillNeed);
+	CHECK(0 != bx::open(&reader, "mmap_file_reader_missing.bin") );
+	CHECK_EQUAL(0, bx::open(&reader, s_filePath) );
+	CHECK_EQUAL(int64_t(sizeof(data) ), reader.getSize() );
+	CHECK_EQUAL(int64_t(sizeof(data) ), bx::getSize(&reader) );
+	CHECK_EQUAL(0, memcmp(data, reader.getDataPtr(), sizeof(data) ) );
+
+	uint32_t value;
+	CHECK_EQUAL(4, bx::read(&reader, value) );
+	CHECK_EQUAL(data[0], value);
+
+	CHECK_EQUAL(int64_t(100*sizeof(uint32_t) ), reader.seek(100*sizeof(uint32_t), bx::Whence::Begin) );
+	CHECK_EQUAL(data[100], *(const uint32_t*)reader.getDataPtr() );
+	CHECK_EQUAL(int64_t(sizeof(data) - 100*sizeof(uint32_t) ), reader.remaining() );
+
+	reader.seek(4, bx::Whence::End);
+	CHECK_EQUAL(4, bx::read(&reader, value) );
+	CHECK_EQUAL(data[BX_COUNTOF(data)-1], value);
+	CHECK_EQUAL(0, bx::read(&reader, value) );
+
+	reader.advise(bx::MmapHint::Random|bx::MmapHint::HugePage);
+	bx::close(&reader);
+
+	// Empty file is valid, but has nothing to map.
+	CHECK_EQUAL(0, bx::open(&writer, s_filePath) );
+	bx::close(&writer);
+
+	CHECK_EQUAL(0, bx::open(&reader, s_filePath) );
+	CHECK_EQUAL(0, reader.getSize() );
+	CHECK_EQUAL(0, bx::read(&reader, value) );
+	bx::close(&reader);
+
+	remove(s_filePath);
+}
+#endif // BX_CONFIG_MMAP_FILE_READER && BX_CONFIG_CRT_FILE_READER_WRITER
+
+struct CountingWriter : public bx::WriterI
+{
+	CountingWriter(bx::WriterI* _writer)
+		: m_writer(_writer)
+		, m_calls(0)
+	{
+	}
+
+	virtual int32_t write(const void* _data, int32_t _size) BX_OVERRIDE
+	{
+		++m_calls;
+		return m_writer->write(_data, _size);
+	}
+
+	bx::WriterI* m_writer;
+	uint32_t m_calls;
+};
+
+struct CountingReader : public bx::ReaderI
+{
+	CountingReader(bx::ReaderI* _reader)
+		: m_reader(_reader)
+		, m_calls(0)
+	{
+	}
+
+	virtual int32_t read(void* _data, int32_t _size) BX_OVERRIDE
+	{
+		++m_calls;
+		return m_reader->read(_data, _size);
+	}
+
+	bx::ReaderI* m_reader;
+	uint32_t m_calls;
+};
+
+#if BX_CONFIG_ALLOCATOR_CRT
+struct CountingReallocator : public bx::ReallocatorI
+{
+	CountingReallocator()
+		: m_reallocs(0)
+	{
+	}
+
+	virtual void* alloc(size_t _size, const char* _file, uint32_t _line) BX_OVERRIDE
+	{
+		return m_allocator.alloc(_size, _file, _line);
+	}
+
+	virtual void free(void* _ptr, const char* _file, uint32_t _line) BX_OVERRIDE
+	{
+		m_allocator.free(_ptr, _file, _line);
+	}
+
+	virtual void* realloc(void* _ptr, size_t _size, const char* _file, uint32_t _line) BX_OVERRIDE
+	{
+		++m_reallocs;
+		return m_allocator.realloc(_ptr, _size, _file, _line);
+	}
+
+	bx::CrtAllocator m_allocator;
+	uint32_t m_reallocs;
+};
+
+TEST(memory_block)
+{
+	CountingReallocator allocator;
+
+	{
+		// 16MB in 16 byte writes, 4KB steps would take 4096 reallocs.
+		bx::MemoryBlock block(&allocator);
+		bx::MemoryWriter writer(&block);
+
+		uint32_t data[4];
+		for (uint32_t ii = 0; ii < (16<<20)/sizeof(data); ++ii)
+		{
+			data[0] = ii;
+			CHECK_EQUAL(int32_t(sizeof(data) ), bx::write(&writer, data, sizeof(data) ) );
+		}
+
+		CHECK(allocator.m_reallocs <= 22);
+		CHECK(block.getSize() >= (16u<<20) );
+		CHECK_EQUAL(int64_t(16<<20), bx::getSize(&writer) );
+		CHECK_EQUAL(12345u, ( (const uint32_t*)block.getData() )[12345*4]);
+
+		// Block doesn't free released data.
+		void* released = block.release();
+		CHECK(NULL == block.getData() );
+		CHECK_EQUAL(0u, block.getSize() );
+		CHECK_EQUAL(12345u, ( (const uint32_t*)released)[12345*4]);
+		BX_FREE(&allocator, released);
+	}
+
+	{
+		allocator.m_reallocs = 0;
+		bx::MemoryBlock block(&allocator, 1<<20);
+		CHECK_EQUAL(1u, allocator.m_reallocs);
+		CHECK_EQUAL(1u<<20, block.getSize() );
+
+		bx::MemoryWriter writer(&block);
+		for (uint32_t ii = 0; ii < (1<<20)/sizeof(uint32_t); ++ii)
+		{
+			bx::write(&writer, ii);
+		}
+
+		CHECK_EQUAL(1u, allocator.m_reallocs);
+		block.reserve(1<<10);
+		CHECK_EQUAL(1u, allocator.m_reallocs);
+	}
+}
+#endif // BX_CONFIG_ALLOCATOR_CRT
+
+TEST(buffered_reader_writer)
+{
+	static uint8_t s_data[64<<10];
+	bx::StaticMemoryBlockWriter memWriter(s_data, sizeof(s_data) );
+	CountingWriter counting(&memWriter);
+
+	uint8_t big[3000];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(big); ++ii)
+	{
+		big[ii] = uint8_t(ii);
+	}
+
+	{
+		bx::BufferedWriter writer(&counting, 1024);
+		for (uint32_t ii = 0; ii < 1000; ++ii)
+		{
+			CHECK_EQUAL(4, writer.write(ii) );
+		}
+
+		const uint16_t u16 = 0x1234;
+		CHECK_EQUAL(2, bx::write(&writer, u16) );
+		CHECK_EQUAL(int32_t(sizeof(big) ), writer.write(big, sizeof(big) ) );
+		CHECK_EQUAL(1, writer.write(uint8_t(0xff) ) );
+	}
+
+	// 4000 bytes in 1024 byte chunks, flush before big write, big write
+	// directly, and final flush.
+	CHECK_EQUAL(6u, counting.m_calls);
+
+	const int32_t size = int32_t(memWriter.seek() );
+	CHECK_EQUAL(4000+2+3000+1, size);
+
+	bx::MemoryReader memReader(s_data, size);
+	CountingReader countingReader(&memReader);
+	bx::BufferedReader reader(&countingReader, 1000);
+
+	for (uint32_t ii = 0; ii < 1000; ++ii)
+	{
+		uint32_t value = 0;
+		CHECK_EQUAL(4, reader.read(value) );
+		CHECK_EQUAL(ii, value);
+	}
+
+	uint16_t u16;
+	CHECK_EQUAL(2, bx::read(&reader, u16) );
+	CHECK_EQUAL(0x1234, u16);
+
+	uint8_t bigRead[3000];
+	CHECK_EQUAL(int32_t(sizeof(bigRead) ), reader.read(bigRead, sizeof(bigRead) ) );
+	CHECK_EQUAL(0, memcmp(big, bigRead, sizeof(big) ) );
+
+	uint8_t u8 = 0;
+	CHECK_EQUAL(1, reader.read(u8) );
+	CHECK_EQUAL(0xff, u8);
+	CHECK_EQUAL(0, reader.read(u8) );
+	CHECK(10u > countingReader.m_calls);
+}
+
+TEST(buffered_writer_short_write)
+{
+	uint32_t data[25];
+	bx::StaticMemoryBlockWriter memWriter(data, sizeof(data) );
+	bx::BufferedWriter writer(&memWriter, 64);
+
+	// Second buffer doesn't fit in underlying writer.
+	for (uint32_t ii = 0; ii < 26; ++ii)
+	{
+		CHECK_EQUAL(4, writer.write(ii) );
+	}
+
+	CHECK_EQUAL(-1, writer.flush() );
+	CHECK_EQUAL(24u, data[24]);
+
+	// Unflushed data is kept, and write that needs flush fails.
+	uint8_t big[64] = {};
+	CHECK_EQUAL(0, writer.write(big, sizeof(big) ) );
+	CHECK_EQUAL(0, writer.write(big, 61) );
+
+	memWriter.seek(0, bx::Whence::Begin);
+	CHECK_EQUAL(4, writer.flush() );
+	CHECK_EQUAL(25u, data[0]);
+	CHECK_EQUAL(0, writer.flush() );
+}
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+TEST(fd_file_reader_writer)
+{
+	static const char* s_filePath = "fd_file_reader_writer.bin";
+
+	static BX_ALIGN_STRUCT(BX_CONFIG_FD_DIRECT_ALIGNMENT, struct) { uint32_t m_data[8192]; } s_block;
+	uint32_t* data = s_block.m_data;
+	for (uint32_t ii = 0; ii < BX_COUNTOF(s_block.m_data); ++ii)
+	{
+		data[ii] = ii*2654435761u;
+	}
+
+	CHECK(bx::isFdDirectAligned(data, 4096, 8192) );
+	CHECK(!bx::isFdDirectAligned(data+1, 4096, 8192) );
+	CHECK(!bx::isFdDirectAligned(data, 100, 8192) );
+	CHECK(!bx::isFdDirectAligned(data, 4096, 100) );
+
+	{
+		bx::FdFileWriter writer(bx::FdFlags::Direct|bx::FdFlags::Sequential|bx::FdFlags::NoCache);
+		CHECK_EQUAL(0, bx::open(&writer, s_filePath) );
+		writer.preallocate(sizeof(s_block) );
+
+		// Aligned block goes through O_DIRECT, unaligned tail through
+		// page cache.
+		CHECK_EQUAL(16384, bx::write(&writer, data, 16384) );
+		CHECK_EQUAL(100, bx::write(&writer, &data[4096], 100) );
+		CHECK_EQUAL(int32_t(sizeof(s_block) - 16484), bx::write(&writer, (const uint8_t*)data + 16484, sizeof(s_block) - 16484) );
+
+		writer.sync();
+		CHECK_EQUAL(int64_t(sizeof(s_block) ), bx::getSize(&writer) );
+		bx::close(&writer);
+	}
+
+	{
+		// Append starts at end of file, writeAt doesn't move position.
+		bx::FdFileWriter writer;
+		CHECK_EQUAL(0, bx::open(&writer, s_filePath, true) );
+		CHECK_EQUAL(int64_t(sizeof(s_block) ), writer.seek() );
+		CHECK_EQUAL(4, writer.writeAt(0, &data[0], 4) );
+		CHECK_EQUAL(4, bx::write(&writer, data[1]) );
+		bx::close(&writer);
+	}
+
+	bx::FdFileReader reader(bx::FdFlags::Direct|bx::FdFlags::NoCache);
+	CHECK(0 != bx::open(&reader, "fd_file_reader_writer_missing.bin") );
+	CHECK_EQUAL(0, bx::open(&reader, s_filePath) );
+	CHECK_EQUAL(int64_t(sizeof(s_block) + 4), bx::getSize(&reader) );
+
+	static BX_ALIGN_STRUCT(BX_CONFIG_FD_DIRECT_ALIGNMENT, struct) { uint32_t m_data[8192]; } s_read;
+	CHECK_EQUAL(int32_t(sizeof(s_read) ), bx::read(&reader, s_read.m_data, sizeof(s_read) ) );
+	CHECK_EQUAL(0, memcmp(data, s_read.m_data, sizeof(s_read) ) );
+
+	uint32_t value;
+	CHECK_EQUAL(4, bx::read(&reader, value) );
+	CHECK_EQUAL(data[1], value);
+	CHECK_EQUAL(0, bx::read(&reader, value) );
+
+	CHECK_EQUAL(4, reader.readAt(400, &value, 4) );
+	CHECK_EQUAL(data[100], value);
+
+	reader.seek(8, bx::Whence::End);
+	CHECK_EQUAL(4, bx::read(&reader, value) );
+	CHECK_EQUAL(data[BX_COUNTOF(s_block.m_data)-1], value);
+	bx::close(&reader);
+
+	remove(s_filePath);
+}
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+
+TEST(writev)
+{
+	const uint32_t header  = 0x12345678;
+	const char payload[]   = "payload";
+	const uint16_t trailer = 0xabcd;
+
+	const bx::IoVec iov[] =
+	{
+		{ &header,  sizeof(header)  },
+		{ payload,  sizeof(payload) },
+		{ &trailer, sizeof(trailer) },
+	};
+	const int32_t size = sizeof(header) + sizeof(payload) + sizeof(trailer);
+	CHECK_EQUAL(size, bx::ioVecSize(iov, BX_COUNTOF(iov) ) );
+
+	uint8_t expected[size];
+	memcpy(&expected[0], &header, sizeof(header) );
+	memcpy(&expected[sizeof(header)], payload, sizeof(payload) );
+	memcpy(&expected[sizeof(header) + sizeof(payload)], &trailer, sizeof(trailer) );
+
+	// Default implementation calls write per buffer.
+	uint8_t data[64];
+	bx::StaticMemoryBlockWriter memWriter(data, sizeof(data) );
+	CountingWriter counting(&memWriter);
+	CHECK_EQUAL(size, bx::writev(&counting, iov, BX_COUNTOF(iov) ) );
+	CHECK_EQUAL(3u, counting.m_calls);
+	CHECK_EQUAL(0, memcmp(expected, data, size) );
+
+	// MemoryWriter gathers in single call, and stops when block is full.
+	memWriter.seek(0, bx::Whence::Begin);
+	CHECK_EQUAL(size, bx::writev(&memWriter, iov, BX_COUNTOF(iov) ) );
+	CHECK_EQUAL(0, memcmp(expected, data, size) );
+	CHECK_EQUAL(size, memWriter.seek() );
+
+	memWriter.seek(sizeof(data) - 6, bx::Whence::Begin);
+	CHECK_EQUAL(6, bx::writev(&memWriter, iov, BX_COUNTOF(iov) ) );
+	CHECK_EQUAL(0, memcmp(expected, &data[sizeof(data) - 6], 6) );
+
+	bx::SizerWriter sizer;
+	CHECK_EQUAL(size, bx::writev(&sizer, iov, BX_COUNTOF(iov) ) );
+	CHECK_EQUAL(int64_t(size), bx::getSize(&sizer) );
+
+	// BufferedWriter copies gathered buffers, and flushes once.
+	memWriter.seek(0, bx::Whence::Begin);
+	counting.m_calls = 0;
+	{
+		bx::BufferedWriter writer(&counting, 1024);
+		CHECK_EQUAL(size, bx::writev(&writer, iov, BX_COUNTOF(iov) ) );
+		CHECK_EQUAL(size, bx::writev(&writer, iov, BX_COUNTOF(iov) ) );
+		CHECK_EQUAL(0u, counting.m_calls);
+	}
+	CHECK_EQUAL(1u, counting.m_calls);
+	CHECK_EQUAL(0, memcmp(expected, data, size) );
+	CHECK_EQUAL(0, memcmp(expected, &data[size], size) );
+}
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+TEST(fd_file_writer_writev)
+{
+	static const char* s_filePath = "fd_file_writer_writev.bin";
+
+	// More buffers than fit in single pwritev batch.
+	uint32_t data[100];
+	bx::IoVec iov[BX_COUNTOF(data)];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(data); ++ii)
+	{
+		data[ii] = ii*2654435761u;
+		iov[ii].m_data = &data[ii];
+		iov[ii].m_size = 0 == ii%10 ? 0 : sizeof(uint32_t);
+	}
+
+	bx::FdFileWriter writer(bx::FdFlags::Direct);
+	CHECK_EQUAL(0, bx::open(&writer, s_filePath) );
+	CHECK_EQUAL(int32_t(90*sizeof(uint32_t) ), bx::writev(&writer, iov, BX_COUNTOF(iov) ) );
+	CHECK_EQUAL(int64_t(90*sizeof(uint32_t) ), writer.seek() );
+	CHECK_EQUAL(4, writer.writevAt(0, &iov[1], 1) );
+	bx::close(&writer);
+
+	bx::FdFileReader reader;
+	CHECK_EQUAL(0, bx::open(&reader, s_filePath) );
+	CHECK_EQUAL(int64_t(90*sizeof(uint32_t) ), bx::getSize(&reader) );
+
+	uint32_t value;
+	for (uint32_t ii = 0; ii < BX_COUNTOF(data); ++ii)
+	{
+		if (0 != ii%10)
+		{
+			CHECK_EQUAL(4, bx::read(&reader, value) );
+			CHECK_EQUAL(data[ii], value);
+		}
+	}
+
+	bx::close(&reader);
+	remove(s_filePath);
+}
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+
+TEST(checksum_reader_writer)
+{
+	uint32_t data[4096];
+	for (uint32_t ii = 0; ii < BX_COUNTOF(data); ++ii)
+	{
+		data[ii] = ii*2654435761u;
+	}
+
+	const uint32_t crc = bx::crc32c(0, data, sizeof(data) );
+
+	uint8_t buffer[sizeof(data) + sizeof(uint32_t)];
+	bx::StaticMemoryBlock mb(buffer, sizeof(buffer) );
+	bx::MemoryWriter writer(&mb);
+
+	{
+		bx::ChecksumWriter checksum(&writer);
+		bx::write(&checksum, data, 1000);
+
+		bx::IoVec iov[2] =
+		{
+			{ (const uint8_t*)data + 1000, 3000                  },
+			{ (const uint8_t*)data + 4000, sizeof(data) - 4000 },
+		};
+		CHECK_EQUAL(int32_t(sizeof(data) - 1000), bx::writev(&checksum, iov, BX_COUNTOF(iov) ) );
+		CHECK_EQUAL(crc, checksum.getChecksum() );
+
+		bx::writeLE(&writer, checksum.getChecksum() );
+	}
+
+	{
+		bx::MemoryReader reader(buffer, sizeof(buffer) );
+		bx::ChecksumReader checksum(&reader);
+
+		uint32_t result[4096];
+		CHECK_EQUAL(int32_t(sizeof(result) ), bx::read(&checksum, result, sizeof(result) ) );
+
+		uint32_t expected;
+		bx::readHE(&reader, expected, true);
+		CHECK_EQUAL(expected, checksum.getChecksum() );
+
+		// Reading past end doesn't change checksum.
+		CHECK_EQUAL(0, bx::read(&checksum, result, 4) );
+		CHECK_EQUAL(crc, checksum.getChecksum() );
+
+		checksum.reset();
+		CHECK_EQUAL(0u, checksum.getChecksum() );
+	}
+
+	// Corrupted data doesn't match.
+	buffer[1234] ^= 1;
+	{
+		bx::MemoryReader reader(buffer, sizeof(data) );
+		bx::ChecksumReader checksum(&reader);
+
+		uint32_t result[4096];
+		bx::read(&checksum, result, sizeof(result) );
+		CHECK(crc != checksum.getChecksum() );
+	}
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/readerwriter.h>
+
+static const uint32_t s_numValues = 1<<20;
+static uint8_t s_data[s_numValues*sizeof(uint32_t)];
+
+static double writeDirect(bx::WriterI* _writer)
+{
+	const int64_t start = bx::getHPCounter();
+	for (uint32_t ii = 0; ii < s_numValues; ++ii)
+	{
+		bx::write(_writer, ii);
+	}
+	return double(bx::getHPCounter() - start)*1000.0/double(bx::getHPFrequency() );
+}
+
+static double writeBuffered(bx::WriterI* _writer)
+{
+	const int64_t start = bx::getHPCounter();
+	{
+		bx::BufferedWriter writer(_writer);
+		for (uint32_t ii = 0; ii < s_numValues; ++ii)
+		{
+			writer.write(ii);
+		}
+	}
+	return double(bx::getHPCounter() - start)*1000.0/double(bx::getHPFrequency() );
+}
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+static BX_ALIGN_STRUCT(BX_CONFIG_FD_DIRECT_ALIGNMENT, struct) { uint8_t m_data[1<<20]; } s_block;
+
+static double writeStream(bx::FileWriterI* _writer, const char* _filePath)
+{
+	const int64_t start = bx::getHPCounter();
+	bx::open(_writer, _filePath);
+	for (uint32_t ii = 0; ii < 64; ++ii)
+	{
+		bx::write(_writer, s_block.m_data, sizeof(s_block.m_data) );
+	}
+	bx::close(_writer);
+	return double(bx::getHPCounter() - start)*1000.0/double(bx::getHPFrequency() );
+}
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+
+void readerWriterBench()
+{
+	printf("Write %d uint32_t values, ms:\n", s_numValues);
+
+	{
+		bx::StaticMemoryBlockWriter writer(s_data, sizeof(s_data) );
+		const double direct = writeDirect(&writer);
+		writer.seek(0, bx::Whence::Begin);
+		const double buffered = writeBuffered(&writer);
+		printf("%-24s %8.2f %8.2f (%.1fx)\n", "MemoryWriter", direct, buffered, direct/buffered);
+	}
+
+#if BX_CONFIG_CRT_FILE_READER_WRITER
+	{
+		static const char* s_filePath = "readerwriter_bench.bin";
+		bx::CrtFileWriter writer;
+		bx::open(&writer, s_filePath);
+		const double direct = writeDirect(&writer);
+		writer.seek(0, bx::Whence::Begin);
+		const double buffered = writeBuffered(&writer);
+		bx::close(&writer);
+		remove(s_filePath);
+		printf("%-24s %8.2f %8.2f (%.1fx)\n", "CrtFileWriter", direct, buffered, direct/buffered);
+	}
+#endif // BX_CONFIG_CRT_FILE_READER_WRITER
+
+#if BX_CONFIG_FD_FILE_READER_WRITER
+	{
+		static const char* s_filePath = "readerwriter_bench.bin";
+		memset(s_block.m_data, 0xcd, sizeof(s_block.m_data) );
+
+		printf("Write 64MB in 1MB blocks, ms:\n");
+
+#	if BX_CONFIG_CRT_FILE_READER_WRITER
+		bx::CrtFileWriter crt;
+		printf("%-24s %8.2f\n", "CrtFileWriter", writeStream(&crt, s_filePath) );
+#	endif // BX_CONFIG_CRT_FILE_READER_WRITER
+
+		bx::FdFileWriter fd;
+		printf("%-24s %8.2f\n", "FdFileWriter", writeStream(&fd, s_filePath) );
+
+		bx::FdFileWriter noCache(bx::FdFlags::NoCache);
+		printf("%-24s %8.2f\n", "FdFileWriter NoCache", writeStream(&noCache, s_filePath) );
+
+		bx::FdFileWriter direct(bx::FdFlags::Direct);
+		bx::open(&direct, s_filePath);
+		const bool isDirect = direct.isDirect();
+		bx::close(&direct);
+		printf("%-24s %8.2f%s\n", "FdFileWriter Direct", writeStream(&direct, s_filePath), isDirect ? "" : " (O_DIRECT not supported)");
+
+		remove(s_filePath);
+	}
+#endif // BX_CONFIG_FD_FILE_READER_WRITER
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/taskgraph.h>
+#include <bx/os.h>
+
+struct TaskGraphNode
+{
+	static void fn(void* _userData)
+	{
+		TaskGraphNode* node = (TaskGraphNode*)_userData;
+		if (0 != node->m_sleepMs)
+		{
+			bx::sleep(node->m_sleepMs);
+		}
+
+		node->m_seq = bx::atomicIncr(node->m_counter);
+	}
+
+	volatile int32_t* m_counter;
+	uint32_t m_sleepMs;
+	int32_t m_seq;
+};
+
+// 0 -> 1 -> 3 -> 5
+// 0 -> 2 -> 4 -> 5
+static void taskGraphDiamond(bx::TaskGraph& _graph, TaskGraphNode* _node, volatile int32_t* _counter)
+{
+	static const uint32_t s_edge[][2] =
+	{
+		{ 0, 1 }, { 0, 2 }, { 1, 3 }, { 2, 4 }, { 3, 5 }, { 4, 5 },
+	};
+
+	_graph.init(6, BX_COUNTOF(s_edge) );
+
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		_node[ii].m_counter = _counter;
+		_node[ii].m_sleepMs = 2 == ii ? 10 : 0;
+		_node[ii].m_seq = 0;
+		CHECK_EQUAL(ii, _graph.addNode("node", TaskGraphNode::fn, &_node[ii]) );
+	}
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(s_edge); ++ii)
+	{
+		CHECK(_graph.addEdge(s_edge[ii][0], s_edge[ii][1]) );
+	}
+
+	CHECK(_graph.compile() );
+}
+
+static void taskGraphCheck(bx::TaskGraph& _graph, const TaskGraphNode* _node)
+{
+	CHECK(_node[0].m_seq < _node[1].m_seq);
+	CHECK(_node[0].m_seq < _node[2].m_seq);
+	CHECK(_node[1].m_seq < _node[3].m_seq);
+	CHECK(_node[2].m_seq < _node[4].m_seq);
+	CHECK(_node[3].m_seq < _node[5].m_seq);
+	CHECK(_node[4].m_seq < _node[5].m_seq);
+
+	uint32_t path[8];
+	int64_t duration = 0;
+	CHECK_EQUAL(4u, _graph.getCriticalPath(path, BX_COUNTOF(path), duration) );
+	CHECK_EQUAL(0u, path[0]);
+	CHECK_EQUAL(2u, path[1]);
+	CHECK_EQUAL(4u, path[2]);
+	CHECK_EQUAL(5u, path[3]);
+	CHECK(duration <= _graph.getTime() );
+}
+
+TEST(taskgraph)
+{
+	bx::JobSystem js;
+	js.init(3);
+
+	volatile int32_t counter = 0;
+	TaskGraphNode node[6];
+	bx::TaskGraph graph;
+	taskGraphDiamond(graph, node, &counter);
+
+	for (uint32_t ii = 0; ii < 3; ++ii)
+	{
+		counter = 0;
+		graph.execute(&js);
+		CHECK_EQUAL(6, counter);
+		taskGraphCheck(graph, node);
+	}
+
+	counter = 0;
+	graph.execute(NULL);
+	CHECK_EQUAL(6, counter);
+	taskGraphCheck(graph, node);
+
+	js.shutdown();
+}
+
+TEST(taskgraph_cycle)
+{
+	bx::TaskGraph graph;
+	graph.init(3, 3);
+
+	const uint32_t a = graph.addNode("a", TaskGraphNode::fn, NULL);
+	const uint32_t b = graph.addNode("b", TaskGraphNode::fn, NULL);
+	const uint32_t c = graph.addNode("c", TaskGraphNode::fn, NULL);
+	CHECK_EQUAL(bx::TaskGraph::Invalid, graph.addNode("d", TaskGraphNode::fn, NULL) );
+
+	CHECK(graph.addEdge(a, b) );
+	CHECK(graph.addEdge(b, c) );
+	CHECK(graph.addEdge(c, a) );
+	CHECK(!graph.addEdge(a, c) );
+
+	CHECK(!graph.compile() );
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/thread.h>
+
+static int32_t threadExit(void* _userData)
+{
+	return *(int32_t*)_userData;
+}
+
+TEST(thread)
+{
+	int32_t value = 1389;
+
+	bx::Thread thread;
+	thread.init(threadExit, &value, 0, "bx.test.thread.long_name");
+	CHECK_EQUAL(0, strcmp("bx.test.thread.", thread.getName() ) );
+	thread.shutdown();
+	CHECK(!thread.isRunning() );
+}
+
+struct ThreadAffinityTest
+{
+	bx::Semaphore m_sem;
+	int32_t m_cpu;
+	char m_name[16];
+};
+
+static int32_t threadAffinity(void* _userData)
+{
+	ThreadAffinityTest* test = (ThreadAffinityTest*)_userData;
+	test->m_sem.wait();
+
+	test->m_cpu = -1;
+	test->m_name[0] = '\0';
+#if BX_PLATFORM_LINUX && defined(__GLIBC__)
+	cpu_set_t set;
+	if (0 == pthread_getaffinity_np(pthread_self(), sizeof(set), &set)
+	&&  1 == CPU_COUNT(&set) )
+	{
+		for (int32_t ii = 0; ii < CPU_SETSIZE; ++ii)
+		{
+			if (CPU_ISSET(ii, &set) )
+			{
+				test->m_cpu = ii;
+			}
+		}
+	}
+
+	pthread_getname_np(pthread_self(), test->m_name, sizeof(test->m_name) );
+#endif // BX_PLATFORM_LINUX && defined(__GLIBC__)
+
+	return 0;
+}
+
+TEST(thread_affinity)
+{
+#if BX_PLATFORM_LINUX && defined(__GLIBC__)
+	// CPU must be allowed by process cpuset (taskset, or container limit),
+	// otherwise sched_setaffinity fails.
+	cpu_set_t set;
+	CHECK_EQUAL(0, sched_getaffinity(0, sizeof(set), &set) );
+
+	int32_t cpu = -1;
+	for (int32_t ii = CPU_SETSIZE-1; ii >= 0 && -1 == cpu; --ii)
+	{
+		if (CPU_ISSET(ii, &set)
+		&&  ii < BX_CONFIG_MAX_CPUS)
+		{
+			cpu = ii;
+		}
+	}
+	CHECK(-1 != cpu);
+
+	ThreadAffinityTest test;
+	bx::Thread thread;
+	thread.init(threadAffinity, &test, 0, "bx.affinity");
+
+	bx::CpuMask mask;
+	mask.set(uint32_t(cpu) );
+	CHECK(thread.setAffinity(mask) );
+	CHECK(thread.setNice(1) );
+
+	test.m_sem.post();
+	thread.shutdown();
+
+	CHECK_EQUAL(cpu, test.m_cpu);
+	CHECK_EQUAL(0, strcmp("bx.affinity", test.m_name) );
+#endif // BX_PLATFORM_LINUX && defined(__GLIBC__)
+}
+
+TEST(cpu_topology)
+{
+	bx::CpuMask mask;
+	bx::cpuMaskFromList(mask, "0-2,5,7-8\n");
+	CHECK_EQUAL(6u, mask.count() );
+	CHECK(mask.isSet(0) && mask.isSet(2) && mask.isSet(5) && mask.isSet(8) );
+	CHECK(!mask.isSet(3) && !mask.isSet(6) && !mask.isSet(9) );
+	CHECK_EQUAL(0u, mask.first() );
+
+	bx::CpuTopology* topology = new bx::CpuTopology;
+	bx::getCpuTopology(*topology);
+
+	CHECK(0 < topology->m_numLogical);
+	CHECK(0 < topology->m_numPhysical);
+	CHECK(topology->m_numPhysical <= topology->m_numLogical);
+	CHECK(0 < topology->m_numPackages);
+	CHECK(0 < topology->m_numNodes);
+	CHECK_EQUAL(topology->m_numLogical, topology->m_online.count() );
+
+	for (uint32_t ii = 0; ii < BX_CONFIG_MAX_CPUS; ++ii)
+	{
+		if (topology->m_online.isSet(ii) )
+		{
+			const bx::CpuInfo& info = topology->m_cpu[ii];
+			CHECK(info.m_smtSiblings.isSet(ii) );
+			CHECK(info.m_core < topology->m_numPhysical);
+		}
+	}
+
+	delete topology;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/timer.h>
+#include <bx/os.h>
+
+TEST(timer_monotonic)
+{
+	const int64_t freq = bx::getHPFrequency();
+	CHECK(0 < freq);
+
+	int64_t last = bx::getHPCounter();
+	for (uint32_t ii = 0; ii < 10000; ++ii)
+	{
+		const int64_t now = bx::getHPCounter();
+		CHECK(now >= last);
+		last = now;
+	}
+
+	const int64_t start = bx::getHPCounter();
+	bx::sleep(10);
+	const double ms = double(bx::getHPCounter() - start)*1000.0/double(freq);
+	CHECK(ms >= 9.0);
+	CHECK(ms < 1000.0);
+}
+
+TEST(timer_tsc)
+{
+	const int64_t freq = bx::getTscFrequency();
+	if (0 == freq)
+	{
+		CHECK_EQUAL(0u, bx::cpuFeatures() & bx::CpuFeatures::InvariantTsc);
+		return;
+	}
+
+	// Sanity check only, 100MHz - 10GHz.
+	CHECK(freq > INT64_C(100000000) );
+	CHECK(freq < INT64_C(10000000000) );
+
+	const int64_t tscStart = bx::getTscCounter();
+	const int64_t start    = bx::getMonotonicCounter();
+	bx::sleep(20);
+	const double tscMs = double(bx::getTscCounter() - tscStart)*1000.0/double(freq);
+	const double ms    = double(bx::getMonotonicCounter() - start)*1000.0/double(bx::getMonotonicFrequency() );
+	CHECK_CLOSE(ms, tscMs, ms*0.05);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "test.h"
+#include <bx/rng.h>
+#include <bx/varint.h>
+
+TEST(varint)
+{
+	CHECK_EQUAL(0u, bx::toZigZag(int32_t(0) ) );
+	CHECK_EQUAL(1u, bx::toZigZag(int32_t(-1) ) );
+	CHECK_EQUAL(2u, bx::toZigZag(int32_t(1) ) );
+	CHECK_EQUAL(UINT32_MAX, bx::toZigZag(INT32_MIN) );
+	CHECK_EQUAL(INT32_MIN, bx::fromZigZag(UINT32_MAX) );
+	CHECK_EQUAL(INT64_MIN, bx::fromZigZag(bx::toZigZag(INT64_MIN) ) );
+	CHECK_EQUAL(INT64_MAX, bx::fromZigZag(bx::toZigZag(INT64_MAX) ) );
+
+	const uint64_t values[] = { 0, 1, 127, 128, 16383, 16384, UINT32_MAX, UINT64_C(1)<<32, UINT64_MAX };
+	const uint32_t sizes[]  = { 1, 1,   1,   2,     2,     3,          5,               5,         10 };
+
+	for (uint32_t ii = 0; ii < BX_COUNTOF(values); ++ii)
+	{
+		uint8_t temp[10];
+		CHECK_EQUAL(sizes[ii], bx::varintSize(values[ii]) );
+		CHECK_EQUAL(sizes[ii], bx::varintEncode(temp, values[ii]) );
+
+		uint64_t value = 0;
+		CHECK_EQUAL(sizes[ii], bx::varintDecode(temp, sizes[ii], value) );
+		CHECK_EQUAL(values[ii], value);
+
+		// Truncated.
+		CHECK_EQUAL(0u, bx::varintDecode(temp, sizes[ii]-1, value) );
+
+		uint32_t value32 = 0;
+		CHECK_EQUAL(values[ii] <= UINT32_MAX ? sizes[ii] : 0, bx::varintDecode(temp, sizes[ii], value32) );
+	}
+
+	// Overlong and overflowing encodings.
+	const uint8_t overflow64[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02 };
+	const uint8_t overlong[]   = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+	uint64_t value;
+	CHECK_EQUAL(0u, bx::varintDecode(overflow64, sizeof(overflow64), value) );
+	CHECK_EQUAL(0u, bx::varintDecode(overlong, sizeof(overlong), value) );
+}
+
+TEST(varint_reader_writer)
+{
+	uint8_t data[256];
+	bx::StaticMemoryBlockWriter writer(data, sizeof(data) );
+	CHECK_EQUAL(1, bx::writeVarint(&writer, 100) );
+	CHECK_EQUAL(5, bx::writeVarint(&writer, UINT32_MAX) );
+	CHECK_EQUAL(10, bx::writeVarint(&writer, UINT64_MAX) );
+	CHECK_EQUAL(1, bx::writeZigZag(&writer, -64) );
+	CHECK_EQUAL(2, bx::writeZigZag(&writer, -65) );
+
+	const int32_t size = int32_t(writer.seek() );
+
+	// Generic reader reads byte at a time.
+	{
+		bx::MemoryReader memReader(data, size);
+		bx::ReaderI* reader = &memReader;
+
+		uint32_t value32;
+		uint64_t value64;
+		int32_t signed32;
+		int64_t signed64;
+		CHECK_EQUAL(1, bx::readVarint(reader, value32) );
+		CHECK_EQUAL(100u, value32);
+		CHECK_EQUAL(5, bx::readVarint(reader, value32) );
+		CHECK_EQUAL(UINT32_MAX, value32);
+		CHECK_EQUAL(10, bx::readVarint(reader, value64) );
+		CHECK_EQUAL(UINT64_MAX, value64);
+		CHECK_EQUAL(1, bx::readZigZag(reader, signed32) );
+		CHECK_EQUAL(-64, signed32);
+		CHECK_EQUAL(2, bx::readZigZag(reader, signed64) );
+		CHECK_EQUAL(-65, signed64);
+		CHECK_EQUAL(0, bx::readVarint(reader, value64) );
+	}
+
+	// MemoryReader decodes in place.
+	{
+		bx::MemoryReader reader(data, size);
+
+		uint32_t value32;
+		uint64_t value64;
+		int32_t signed32;
+		CHECK_EQUAL(1, bx::readVarint(&reader, value32) );
+		CHECK_EQUAL(100u, value32);
+		CHECK_EQUAL(5, bx::readVarint(&reader, value64) );
+		CHECK_EQUAL(uint64_t(UINT32_MAX), value64);
+
+		// Value doesn't fit, position doesn't move.
+		CHECK_EQUAL(0, bx::readVarint(&reader, value32) );
+		CHECK_EQUAL(6, reader.getPos() );
+		CHECK_EQUAL(10, bx::readVarint(&reader, value64) );
+		CHECK_EQUAL(1, bx::readZigZag(&reader, signed32) );
+		CHECK_EQUAL(-64, signed32);
+		CHECK_EQUAL(2, bx::readZigZag(&reader, signed32) );
+		CHECK_EQUAL(-65, signed32);
+		CHECK_EQUAL(0, bx::readVarint(&reader, value64) );
+	}
+}
+
+TEST(varint_delta)
+{
+	enum { Num = 1001 };
+
+	bx::RngMwc rng;
+	static uint32_t src32[Num];
+	static uint64_t src64[Num];
+	uint32_t value = 1000;
+	for (uint32_t ii = 0; ii < Num; ++ii)
+	{
+		// Mostly small increasing deltas, with occasional large jumps
+		// in both directions.
+		value += 0 == ii%100 ? rng.gen() : rng.gen()%300 - 50;
+		src32[ii] = value;
+		src64[ii] = (uint64_t(rng.gen() )<<32) | value;
+	}
+
+	static uint8_t data[Num*10];
+	static uint32_t dst32[Num];
+	static uint64_t dst64[Num];
+
+	const uint32_t size32 = bx::deltaVarintEncode(data, src32, Num, 7u);
+	CHECK(size32 <= bx::deltaVarintEncodeBound(Num) );
+	CHECK(size32 < Num*3);
+	CHECK_EQUAL(size32, bx::deltaVarintDecode(dst32, Num, data, size32, 7u) );
+	CHECK_EQUAL(0, memcmp(src32, dst32, sizeof(src32) ) );
+	CHECK_EQUAL(0u, bx::deltaVarintDecode(dst32, Num, data, size32-1, 7u) );
+
+	const uint32_t size64 = bx::deltaVarintEncode(data, src64, Num);
+	CHECK(size64 <= bx::deltaVarintEncodeBound(Num, sizeof(uint64_t) ) );
+	CHECK_EQUAL(size64, bx::deltaVarintDecode(dst64, Num, data, size64) );
+	CHECK_EQUAL(0, memcmp(src64, dst64, sizeof(src64) ) );
+
+	// Stream helpers, written in chunks and decoded in place.
+	bx::StaticMemoryBlockWriter writer(data, sizeof(data) );
+	CHECK_EQUAL(int32_t(size32), bx::writeDeltaVarint(&writer, src32, Num, 7u) );
+
+	bx::MemoryReader reader(data, size32);
+	memset(dst32, 0, sizeof(dst32) );
+	CHECK_EQUAL(int32_t(size32), bx::readDeltaVarint(&reader, dst32, Num, 7u) );
+	CHECK_EQUAL(0, memcmp(src32, dst32, sizeof(src32) ) );
+	CHECK_EQUAL(0, reader.remaining() );
+}
+
+TEST(group_varint)
+{
+	enum { Num = 1003 };
+
+	bx::RngMwc rng;
+	static uint32_t src[Num];
+	for (uint32_t ii = 0; ii < Num; ++ii)
+	{
+		// Spread values over all encoded sizes.
+		const uint32_t shift = rng.gen()%32;
+		src[ii] = rng.gen() >> shift;
+	}
+
+	static uint8_t data[Num/4*17+17];
+	static uint32_t dst[Num];
+
+	bx::GroupVarintDecodeFn fn[] =
+	{
+		bx::groupVarintDecode_ref,
+		bx::groupVarintDecode_select(bx::cpuFeatures() ),
+	};
+
+	for (uint32_t delta = 0; delta < 2; ++delta)
+	{
+		const uint32_t size = bx::groupVarintEncode(data, src, Num, 0 != delta, 3);
+		CHECK(size <= bx::groupVarintEncodeBound(Num) );
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(fn); ++ii)
+		{
+			memset(dst, 0, sizeof(dst) );
+			CHECK_EQUAL(size, fn[ii](dst, Num, data, size, 0 != delta, 3) );
+			CHECK_EQUAL(0, memcmp(src, dst, sizeof(src) ) );
+
+			// Truncated.
+			CHECK_EQUAL(0u, fn[ii](dst, Num, data, size-1, 0 != delta, 3) );
+
+			// Fewer values than encoded.
+			CHECK(0 != fn[ii](dst, 9, data, size, 0 != delta, 3) );
+			CHECK_EQUAL(0, memcmp(src, dst, 9*sizeof(uint32_t) ) );
+		}
+	}
+
+	// Stream helpers.
+	bx::StaticMemoryBlockWriter writer(data, sizeof(data) );
+	const int32_t size = bx::writeDeltaGroupVarint(&writer, src, Num);
+	CHECK_EQUAL(int64_t(size), writer.seek() );
+
+	bx::MemoryReader reader(data, size);
+	memset(dst, 0, sizeof(dst) );
+	CHECK_EQUAL(size, bx::readDeltaGroupVarint(&reader, dst, Num) );
+	CHECK_EQUAL(0, memcmp(src, dst, sizeof(src) ) );
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bench.h"
+#include <bx/varint.h>
+
+static const uint32_t s_numValues = 1<<20;
+static uint32_t s_src[s_numValues];
+static uint32_t s_dst[s_numValues];
+static uint8_t s_data[s_numValues/4*17];
+
+typedef uint32_t (*DecodeFn)(uint32_t _size);
+
+static uint32_t decodeFixed(uint32_t _size)
+{
+	bx::MemoryReader reader(s_data, _size);
+	for (uint32_t ii = 0; ii < s_numValues; ++ii)
+	{
+		bx::read(&reader, s_dst[ii]);
+	}
+
+	return uint32_t(reader.getPos() );
+}
+
+static uint32_t decodeVarint(uint32_t _size)
+{
+	return bx::deltaVarintDecode(s_dst, s_numValues, s_data, _size);
+}
+
+static uint32_t decodeGroupRef(uint32_t _size)
+{
+	return bx::groupVarintDecode_ref(s_dst, s_numValues, s_data, _size, true, 0);
+}
+
+static uint32_t decodeGroup(uint32_t _size)
+{
+	return bx::groupVarintDecode(s_dst, s_numValues, s_data, _size, true, 0);
+}
+
+static void bench(const char* _name, DecodeFn _fn, uint32_t _size)
+{
+	int64_t best = INT64_MAX;
+	for (uint32_t run = 0; run < 10; ++run)
+	{
+		const int64_t start = bx::getHPCounter();
+		_fn(_size);
+		const int64_t elapsed = bx::getHPCounter() - start;
+		best = elapsed < best ? elapsed : best;
+	}
+
+	const double ns = double(best)*1.0e9/double(bx::getHPFrequency() )/double(s_numValues);
+	printf("%-24s %5.2f ns, %5.2f bytes per value%s\n"
+		, _name
+		, ns
+		, double(_size)/double(s_numValues)
+		, 0 == memcmp(s_src, s_dst, sizeof(s_src) ) ? "" : " (mismatch)"
+		);
+}
+
+void varintBench()
+{
+	// Sorted ids with small gaps.
+	uint32_t value = 0;
+	for (uint32_t ii = 0; ii < s_numValues; ++ii)
+	{
+		value += (ii*2654435761u >> 24) + 1;
+		s_src[ii] = value;
+	}
+
+	printf("Decode %d sorted uint32_t values:\n", s_numValues);
+
+	memcpy(s_data, s_src, sizeof(s_src) );
+	bench("MemoryReader read", decodeFixed, sizeof(s_src) );
+
+	uint32_t size = bx::deltaVarintEncode(s_data, s_src, s_numValues);
+	bench("deltaVarintDecode", decodeVarint, size);
+
+	size = bx::groupVarintEncode(s_data, s_src, s_numValues, true);
+	bench("groupVarintDecode_ref", decodeGroupRef, size);
+	bench("groupVarintDecode", decodeGroup, size);
+}